@@ -1,5 +1,7 @@
 #include <libcgalmesher/Cgal2DMesher.hpp>
 
+#include <algorithm>
+
 #include <CGAL/Delaunay_mesh_face_base_2.h>
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
 #include <CGAL/Delaunay_mesh_size_criteria_2.h>
@@ -9,15 +11,121 @@
 using namespace cgalmesher;
 
 
+namespace {
+
+typedef CGAL::Delaunay_mesh_face_base_2<Cgal2DMesher::K>           Fb;
+typedef CGAL::Triangulation_data_structure_2<Cgal2DMesher::Vb, Fb> Tds;
+typedef CGAL::Constrained_Delaunay_triangulation_2<Cgal2DMesher::K, Tds> CDT;
+
+
+/**
+ * Delaunay_mesh_size_criteria_2 with the size bound varying in space:
+ * the bound for the face is the sizing field in its centroid
+ */
+class SizingFieldCriteria : public CGAL::Delaunay_mesh_size_criteria_2<CDT> {
+	typedef CGAL::Delaunay_mesh_size_criteria_2<CDT> Base;
+	typedef CGAL::Delaunay_mesh_criteria_2<CDT>      AspectCriteria;
+	
+public:
+	typedef Base::Quality Quality;
+	typedef std::vector<Cgal2DMesher::CgalBody> Bodies;
+	
+	SizingFieldCriteria(const Bodies& bodies_,
+			const Cgal2DMesher::SizingField& sizingField_) :
+			Base(0.125, 0), bodies(&bodies_), sizingField(&sizingField_) { }
+	
+	class Is_bad : public Base::Is_bad {
+	public:
+		Is_bad(const double aspectBound, const CDT::Geom_traits& traits,
+				const Bodies* bodies_, const Cgal2DMesher::SizingField* sizingField_) :
+				Base::Is_bad(aspectBound, 0, traits),
+				bodies(bodies_), sizingField(sizingField_) { }
+		
+		CGAL::Mesh_2::Face_badness operator()(const Quality q) const {
+			if (q.size() > 1) { return CGAL::Mesh_2::IMPERATIVELY_BAD; }
+			if (q.sine() < this->B) { return CGAL::Mesh_2::BAD; }
+			return CGAL::Mesh_2::NOT_BAD;
+		}
+		
+		CGAL::Mesh_2::Face_badness operator()(
+				const CDT::Face_handle& fh, Quality& q) const {
+			
+			const Cgal2DMesher::CgalPoint2& a = fh->vertex(0)->point();
+			const Cgal2DMesher::CgalPoint2& b = fh->vertex(1)->point();
+			const Cgal2DMesher::CgalPoint2& c = fh->vertex(2)->point();
+			
+			q.second = 0;
+			const double step = localStep(CGAL::centroid(a, b, c));
+			if (step > 0) {
+				const double maxSquaredLength = std::max({
+						CGAL::squared_distance(a, b),
+						CGAL::squared_distance(b, c),
+						CGAL::squared_distance(c, a)});
+				q.second = maxSquaredLength / (step * step);
+				if (q.size() > 1) {
+					q.first = 1;
+					return CGAL::Mesh_2::IMPERATIVELY_BAD;
+				}
+			}
+			
+			return AspectCriteria::Is_bad::operator()(fh, q.first);
+		}
+	
+	private:
+		const Bodies* bodies;
+		const Cgal2DMesher::SizingField* sizingField;
+		
+		/// zero outside of bodies means no bound
+		double localStep(const Cgal2DMesher::CgalPoint2& p) const {
+			for (const auto& body : *bodies) {
+				if (body.contains(p)) {
+					return (*sizingField)({{p.x(), p.y()}}, body.id);
+				}
+			}
+			return 0;
+		}
+	};
+	
+	Is_bad is_bad_object() const {
+		return Is_bad(this->bound(), this->traits, bodies, sizingField);
+	}
+	
+private:
+	const Bodies* bodies;
+	const Cgal2DMesher::SizingField* sizingField;
+};
+
+}
+
+
 Cgal2DMesher::IntermediateTriangulation
 Cgal2DMesher::
 triangulate(const double spatialStep, const std::vector<CgalBody> bodies) {
 	
-	typedef CGAL::Delaunay_mesh_face_base_2<K>                  Fb;
-	typedef CGAL::Triangulation_data_structure_2<Vb, Fb>        Tds;
-	typedef CGAL::Constrained_Delaunay_triangulation_2<K, Tds>  CDT;
-	typedef CGAL::Delaunay_mesh_size_criteria_2<CDT>            Criteria;
-	typedef CGAL::Delaunay_mesher_2<CDT, Criteria>              Mesher;
+	typedef CGAL::Delaunay_mesh_size_criteria_2<CDT> Criteria;
+	
+	Criteria meshingCriteria;
+	assert(spatialStep > 0);
+	meshingCriteria.set_size_bound(spatialStep);
+	
+	return refine<CDT>(bodies, meshingCriteria);
+}
+
+
+Cgal2DMesher::IntermediateTriangulation
+Cgal2DMesher::
+triangulate(const SizingField& sizingField, const std::vector<CgalBody> bodies) {
+	
+	return refine<CDT>(bodies, SizingFieldCriteria(bodies, sizingField));
+}
+
+
+template<typename CDT, typename Criteria>
+Cgal2DMesher::IntermediateTriangulation
+Cgal2DMesher::
+refine(const std::vector<CgalBody>& bodies, const Criteria& criteria) {
+	
+	typedef CGAL::Delaunay_mesher_2<CDT, Criteria> Mesher;
 	
 	CDT cdt;
 	
@@ -34,20 +142,16 @@ triangulate(const double spatialStep, const std::vector<CgalBody> bodies) {
 		}
 	}
 	
-	Mesher mesher(cdt);
+	Mesher mesher(cdt, criteria);
 	mesher.set_seeds(listOfSeeds.begin(), listOfSeeds.end());
-	Criteria meshingCriteria;
-	assert(spatialStep > 0);
-	meshingCriteria.set_size_bound(spatialStep);
-	mesher.set_criteria(meshingCriteria);
 	
 	// meshing itself
 	mesher.refine_mesh();
 	
 	// copy from CDT to IntermediateTriangulation adding info
 	// about containing body to triangulation cells
-	typedef CDT::Vertex CdtVertex;
-	typedef CDT::Face   CdtCell;
+	typedef typename CDT::Vertex CdtVertex;
+	typedef typename CDT::Face   CdtCell;
 	typedef IntermediateTriangulation::Vertex IntermediateVertex;
 	typedef IntermediateTriangulation::Face   IntermediateCell;
 	
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <fstream>
+#include <functional>
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Triangulation_vertex_base_with_info_2.h>
@@ -43,6 +44,9 @@ public:
 		std::vector<Border> inner; ///< borders of the inner cavities of the body
 	};
 	
+	/// Local spatial step at the point inside the body with given id
+	typedef std::function<double(const TaskBody::Point&, const size_t)> SizingField;
+	
 	/// Body structure used inside the mesher
 	struct CgalBody {
 		size_t id;                  ///< will be set to cells info
@@ -147,11 +151,41 @@ public:
 	}
 	
 	
+	/**
+	 * Build the grid on given geometry with the spatial step varying in space
+	 * @param sizingField         local spatial step inside bodies
+	 * @param bodies              list of bodies to construct
+	 * @param result              triangulation to write the result in
+	 * @see triangulate above
+	 */
+	template<
+			typename ResultingTriangulation,
+			template<typename, typename> class CellConverter = DefaultCellConverter,
+			template<typename, typename> class VertexConverter = DefaultVertexConverter
+			>
+	static void triangulate(
+			const SizingField& sizingField, const std::vector<TaskBody> bodies,
+			ResultingTriangulation& result) {
+		
+		copyTriangulation<IntermediateTriangulation, ResultingTriangulation,
+				CellConverter, VertexConverter>(
+						triangulate(sizingField, convert(bodies)), result);
+	}
+	
+	
 private:
 	/** The meshing itself */
 	static IntermediateTriangulation triangulate(
 			const double spatialStep, const std::vector<CgalBody> bodies);
 	
+	static IntermediateTriangulation triangulate(
+			const SizingField& sizingField, const std::vector<CgalBody> bodies);
+	
+	/** Refine constrained triangulation of bodies by given criteria */
+	template<typename CDT, typename Criteria>
+	static IntermediateTriangulation refine(
+			const std::vector<CgalBody>& bodies, const Criteria& criteria);
+	
 	
 	/** 
 	 * Copy CGAL triangulations of different types
@@ -1,8 +1,10 @@
 #ifndef LIBCGALMESH_CGAL3DMESHER_HPP
 #define LIBCGALMESH_CGAL3DMESHER_HPP
 
+#include <array>
 #include <string>
 #include <fstream>
+#include <functional>
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Triangulation_vertex_base_with_info_3.h>
@@ -37,6 +39,13 @@ public:
 	typedef IntermediateTriangulation::Vertex      Vertex;
 	typedef IntermediateTriangulation::Cell        Cell;
 	
+	/// Local spatial step at the given point. In parallel meshing it is
+	/// called concurrently by TBB threads, so it must be thread-safe
+	typedef std::function<double(const std::array<double, 3>&)> SizingField;
+	
+	/// Grid id of cells of the (single) meshed body
+	static const size_t BODY_ID = 0;
+	
 	
 	/// @name Converter structures for CGAL copy_tds function --
 	/// convertion between vertices and cells from
@@ -72,7 +81,7 @@ public:
 			res.info() = (size_t)(-1);
 			// copy information about empty/non-empty space in the cell
 			if (src.subdomain_index() != SubdomainIndex()) {
-				res.info() = 0;
+				res.info() = BODY_ID;
 			}
 			return res;
 		}
@@ -88,6 +97,8 @@ public:
 	 * @param detectSharpEdges    use true for figures with sharp edges
 	 * @param polyhedronFileName  file with polyhedron to construct the grid from
 	 * @param result              triangulation to write the result in
+	 * @param parallel            mesh in parallel if isParallelMeshingAvailable()
+	 * (then sizingField must be thread-safe)
 	 * @tparam ResultingTriangulation type of the triangulation to write result in
 	 * @tparam CellConverter          see DefaultCellConverter
 	 * @tparam VertexConverter        see DefaultVertexConverter
@@ -98,14 +109,39 @@ public:
 			template<typename, typename> class VertexConverter = DefaultVertexConverter
 			>
 	static void triangulate(const double spatialStep, const bool detectSharpEdges,
-			const std::string polyhedronFileName, ResultingTriangulation& result) {
+			const std::string polyhedronFileName, ResultingTriangulation& result,
+			const bool parallel = false) {
+		
+		triangulate<ResultingTriangulation, CellConverter, VertexConverter>(
+				[spatialStep] (const std::array<double, 3>&) { return spatialStep; },
+				spatialStep, detectSharpEdges, polyhedronFileName, result, parallel);
+	}
+	
+	
+	/**
+	 * Build the grid on given geometry with the spatial step varying in space
+	 * @param sizingField         local spatial step
+	 * @param minimalStep         the finest step of the sizing field; it
+	 * bounds the distance between the border of the figure and the mesh
+	 * @see triangulate above
+	 */
+	template<
+			typename ResultingTriangulation,
+			template<typename, typename> class CellConverter = DefaultCellConverter,
+			template<typename, typename> class VertexConverter = DefaultVertexConverter
+			>
+	static void triangulate(const SizingField& sizingField, const double minimalStep,
+			const bool detectSharpEdges, const std::string polyhedronFileName,
+			ResultingTriangulation& result, const bool parallel = false) {
 		
 		IntermediateTriangulation intermediateTriangulation;
 		
 		if (detectSharpEdges) {
-			intermediateTriangulation = triangulateWithEdges(polyhedronFileName, spatialStep);
+			intermediateTriangulation = triangulateWithEdges(
+					polyhedronFileName, sizingField, minimalStep, parallel);
 		} else {
-			intermediateTriangulation = triangulateWithoutEdges(polyhedronFileName, spatialStep);
+			intermediateTriangulation = triangulateWithoutEdges(
+					polyhedronFileName, sizingField, minimalStep, parallel);
 		}
 		
 		copyTriangulation<IntermediateTriangulation, ResultingTriangulation,
@@ -113,28 +149,74 @@ public:
 	}
 	
 	
+	/**
+	 * Whether the library is built with CGAL concurrent meshing (requires TBB).
+	 * If not, parallel meshing falls back to sequential one.
+	 */
+	static bool isParallelMeshingAvailable() {
+#ifdef CGAL_LINKED_WITH_TBB
+		return true;
+#else
+		return false;
+#endif
+	}
+	
+	
 private:
 	
+	/// Adapter of SizingField to the CGAL concept of sizing field
+	struct CgalSizingField {
+		typedef K::FT FT;
+		const SizingField* sizingField;
+		
+		template<typename Point, typename Index>
+		FT operator()(const Point& p, const int, const Index&) const {
+			return (*sizingField)({{p.x(), p.y(), p.z()}});
+		}
+	};
+	
+	
 	/**
 	 * Triangulation process that meshes cube figure into the cube figure and 
 	 * tetrahedron into tetrahedron one - initial edges of the figure stay preserved.
 	 * However, resulting triangulation may not be Delaunay triangulation -
 	 * property of empty sphere can be violated on sharp edges.
 	 * @param polyhedronFileName  file with polyhedron to construct the grid from
-	 * @param spatialStep         effective spatial step
+	 * @param sizingField         local spatial step
+	 * @param minimalStep         the finest step of the sizing field
+	 * @param parallel            use CGAL concurrent meshing
 	 */
 	static IntermediateTriangulation triangulateWithEdges(
-			const std::string polyhedronFileName, const double spatialStep);
+			const std::string polyhedronFileName, const SizingField& sizingField,
+			const double minimalStep, const bool parallel);
 	
 	
 	/**
 	 * Triangulation process that smoothes any sharp edges of initial figure.
 	 * However, resulting triangulation is strictly Delaunay triangulation.
 	 * @param polyhedronFileName  file with polyhedron to construct the grid from
-	 * @param spatialStep         effective spatial step
+	 * @param sizingField         local spatial step
+	 * @param minimalStep         the finest step of the sizing field
+	 * @param parallel            use CGAL concurrent meshing
 	 */
 	static IntermediateTriangulation triangulateWithoutEdges(
-			const std::string polyhedronFileName, const double spatialStep);
+			const std::string polyhedronFileName, const SizingField& sizingField,
+			const double minimalStep, const bool parallel);
+	
+	
+	/// @name Meshing with given CGAL concurrency tag
+	/// (CGAL::Sequential_tag or CGAL::Parallel_tag)
+	/// @{
+	template<typename ConcurrencyTag>
+	static IntermediateTriangulation triangulateWithEdges(
+			const std::string polyhedronFileName, const SizingField& sizingField,
+			const double minimalStep);
+	
+	template<typename ConcurrencyTag>
+	static IntermediateTriangulation triangulateWithoutEdges(
+			const std::string polyhedronFileName, const SizingField& sizingField,
+			const double minimalStep);
+	/// @}
 	
 	
 	/**
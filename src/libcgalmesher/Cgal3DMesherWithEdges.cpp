@@ -13,11 +13,31 @@ using namespace cgalmesher;
 Cgal3DMesher::IntermediateTriangulation
 Cgal3DMesher::
 triangulateWithEdges(const std::string polyhedronFileName,
-			const double spatialStep) {
+			const SizingField& sizingField, const double minimalStep,
+			const bool parallel) {
+#ifdef CGAL_LINKED_WITH_TBB
+	if (parallel) {
+		return triangulateWithEdges<CGAL::Parallel_tag>(
+				polyhedronFileName, sizingField, minimalStep);
+	}
+#endif
+	(void)parallel;
+	return triangulateWithEdges<CGAL::Sequential_tag>(
+			polyhedronFileName, sizingField, minimalStep);
+}
+
+
+template<typename ConcurrencyTag>
+Cgal3DMesher::IntermediateTriangulation
+Cgal3DMesher::
+triangulateWithEdges(const std::string polyhedronFileName,
+			const SizingField& sizingField, const double minimalStep) {
+	
+	const CgalSizingField spatialStep = {&sizingField};
 	
 	typedef CGAL::Polyhedral_mesh_domain_with_features_3<K> MeshDomainWithEdges;
-	typedef CGAL::Mesh_triangulation_3<
-			MeshDomainWithEdges>::type MeshTriangulationWithEdges;
+	typedef typename CGAL::Mesh_triangulation_3<
+			MeshDomainWithEdges, CGAL::Default, ConcurrencyTag>::type MeshTriangulationWithEdges;
 	typedef CGAL::Mesh_complex_3_in_triangulation_3<
 			MeshTriangulationWithEdges,
 			MeshDomainWithEdges::Corner_index,
@@ -35,7 +55,7 @@ triangulateWithEdges(const std::string polyhedronFileName,
 			CGAL::parameters::facet_angle = 25,
 			CGAL::parameters::cell_radius_edge_ratio = 3,
 			CGAL::parameters::facet_size = spatialStep,
-			CGAL::parameters::facet_distance = spatialStep / 4,
+			CGAL::parameters::facet_distance = minimalStep / 4,
 			CGAL::parameters::cell_size = spatialStep);
 	
 	// meshing
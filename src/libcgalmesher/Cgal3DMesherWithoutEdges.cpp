@@ -14,12 +14,32 @@ using namespace cgalmesher;
 Cgal3DMesher::IntermediateTriangulation
 Cgal3DMesher::
 triangulateWithoutEdges(const std::string polyhedronFileName,
-			const double spatialStep) {
+			const SizingField& sizingField, const double minimalStep,
+			const bool parallel) {
+#ifdef CGAL_LINKED_WITH_TBB
+	if (parallel) {
+		return triangulateWithoutEdges<CGAL::Parallel_tag>(
+				polyhedronFileName, sizingField, minimalStep);
+	}
+#endif
+	(void)parallel;
+	return triangulateWithoutEdges<CGAL::Sequential_tag>(
+			polyhedronFileName, sizingField, minimalStep);
+}
+
+
+template<typename ConcurrencyTag>
+Cgal3DMesher::IntermediateTriangulation
+Cgal3DMesher::
+triangulateWithoutEdges(const std::string polyhedronFileName,
+			const SizingField& sizingField, const double minimalStep) {
+	
+	const CgalSizingField spatialStep = {&sizingField};
 	
 	typedef CGAL::Polyhedron_3<K> Polyhedron;
 	typedef CGAL::Polyhedral_mesh_domain_3<Polyhedron, K> MeshDomainWithoutEdges;
-	typedef CGAL::Mesh_triangulation_3<
-			MeshDomainWithoutEdges>::type MeshTriangulationWithoutEdges;	
+	typedef typename CGAL::Mesh_triangulation_3<
+			MeshDomainWithoutEdges, CGAL::Default, ConcurrencyTag>::type MeshTriangulationWithoutEdges;	
 	typedef CGAL::Mesh_complex_3_in_triangulation_3<
 			MeshTriangulationWithoutEdges> C3t3;
 	typedef CGAL::Mesh_criteria_3<MeshTriangulationWithoutEdges> MeshingCriteria;
@@ -36,7 +56,7 @@ triangulateWithoutEdges(const std::string polyhedronFileName,
 			CGAL::parameters::facet_angle = 25,
 			CGAL::parameters::cell_radius_edge_ratio = 3,
 			CGAL::parameters::facet_size = spatialStep,
-			CGAL::parameters::facet_distance = spatialStep / 4,
+			CGAL::parameters::facet_distance = minimalStep / 4,
 			CGAL::parameters::cell_size = spatialStep);
 
 	C3t3 c3t3 = CGAL::make_mesh_3<C3t3>(domain, meshingCriteria,
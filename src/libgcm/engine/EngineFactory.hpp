@@ -4,6 +4,7 @@
 #include <libgcm/engine/cubic/Engine.hpp>
 #include <libgcm/engine/simplex/Engine.hpp>
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
 
 
 namespace gcm {
@@ -21,11 +22,26 @@ inline std::shared_ptr<AbstractEngine> createEngine(const Task& task) {
 	}
 	
 	case Grids::T::SIMPLEX:
-	switch (task.globalSettings.dimensionality) {
-		case 1: THROW_UNSUPPORTED("Unsupported space dimensionality");
-		case 2: return std::make_shared<simplex::Engine<2, CgalTriangulation>>(task);
-		case 3: return std::make_shared<simplex::Engine<3, CgalTriangulation>>(task);
-		default: THROW_INVALID_ARG("Invalid space dimensionality");
+	switch (task.simplexGrid.triangulation) {
+		
+		case Task::SimplexGrid::Triangulation::CGAL:
+		switch (task.globalSettings.dimensionality) {
+			case 1: THROW_UNSUPPORTED("Unsupported space dimensionality");
+			case 2: return std::make_shared<simplex::Engine<2, CgalTriangulation>>(task);
+			case 3: return std::make_shared<simplex::Engine<3, CgalTriangulation>>(task);
+			default: THROW_INVALID_ARG("Invalid space dimensionality");
+		}
+		
+		case Task::SimplexGrid::Triangulation::FLAT:
+		switch (task.globalSettings.dimensionality) {
+			case 1: THROW_UNSUPPORTED("Unsupported space dimensionality");
+			case 2: return std::make_shared<simplex::Engine<2, FlatTriangulation>>(task);
+			case 3: return std::make_shared<simplex::Engine<3, FlatTriangulation>>(task);
+			default: THROW_INVALID_ARG("Invalid space dimensionality");
+		}
+		
+		default:
+			THROW_UNSUPPORTED("Unknown type of triangulation");
 	}
 	
 	default:
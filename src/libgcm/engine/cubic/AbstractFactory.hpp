@@ -88,8 +88,16 @@ public:
 	}
 	
 	virtual OdePtr createOde(const Odes::T type) override {
-		assert_true(Odes::T::MAXWELL_VISCOSITY == type); // TODO
-		return std::make_shared<MaxwellViscosityOde<Mesh>>();
+		switch (type) {
+			case Odes::T::MAXWELL_VISCOSITY:
+				return std::make_shared<MaxwellViscosityOde<Mesh>>();
+			case Odes::T::CONTINUAL_DAMAGE:
+				return std::make_shared<ContinualDamageOde<Mesh>>();
+			case Odes::T::IDEAL_PLASTIC_FLOW:
+				return std::make_shared<IdealPlasticFlowCorrector<Mesh>>();
+			default:
+				THROW_UNSUPPORTED("Unknown or unsupported type of ODE");
+		}
 	}
 	
 	virtual SnapPtr createSnapshotter(
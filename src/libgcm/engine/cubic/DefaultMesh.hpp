@@ -2,6 +2,7 @@
 #define LIBGCM_CUBIC_DEFAULTMESH_HPP
 
 #include <libgcm/engine/cubic/AbstractMesh.hpp>
+#include <libgcm/rheology/variables/OdeVariables.hpp>
 #include <libgcm/util/task/MaterialsCondition.hpp>
 #include <libgcm/util/task/InitialCondition.hpp>
 
@@ -23,9 +24,9 @@ public:
 	typedef TModel                              Model;
 	typedef typename Model::PdeVariables        PdeVariables;
 	typedef typename Model::PdeVector           PdeVector;
-	typedef typename Model::GCM_MATRICES        GCM_MATRICES;
-	typedef typename Model::GcmMatricesPtr      GcmMatricesPtr;
-	typedef typename Model::ConstGcmMatricesPtr ConstGcmMatricesPtr;
+	typedef typename Model::LEAN_GCM_MATRICES   GCM_MATRICES;
+	typedef std::shared_ptr<GCM_MATRICES>       GcmMatricesPtr;
+	typedef std::shared_ptr<const GCM_MATRICES> ConstGcmMatricesPtr;
 	typedef typename GCM_MATRICES::Matrix       Matrix;
 	static const Models::T ModelType = Model::Type;
 	
@@ -34,6 +35,7 @@ public:
 	typedef typename Base::ConstructionPack     ConstructionPack;
 	typedef typename Grid::Iterator             Iterator;
 	typedef typename Grid::MatrixDD             MatrixDD;
+	typedef gcm::OdeVariables<Iterator>         OdeVariables;
 	
 	typedef TMaterial                           Material;
 	typedef std::shared_ptr<Material>           MaterialPtr;
@@ -62,6 +64,7 @@ public:
 		pdeIsSetUp = true;
 		allocate();
 		MaterialsCondition<Model, Grid, Material, DefaultMesh>::apply(task, this);
+		odeVariables.allocate(*this, task);
 		InitialCondition<Model, Grid, Material, DefaultMesh>::apply(task, this);
 	}
 	
@@ -97,6 +100,19 @@ public:
 		return this->materials[this->getIndex(it)];
 	}
 	
+	/**
+	 * The number changes whenever materials of nodes may have changed,
+	 * so caches of per-node materials know when to be rebuilt
+	 */
+	size_t getMaterialsVersion() const {
+		return materialsVersion;
+	}
+	
+	/** Read-only access to internal variables of ODEs */
+	const OdeVariables& odeVars() const {
+		return this->odeVariables;
+	}
+	
 	/** Read / write access to actual PDE variables */
 	PdeVariables& _pdeVars(const Iterator& it) {
 		return this->pdeVariables[this->getIndex(it)];
@@ -120,11 +136,17 @@ public:
 		return this->gcmMatrices[this->getIndex(it)];
 	}
 	
-	/** Read / write access to actual GCM matrices */
+	/** Read / write access to material, counts as its change */
 	MaterialPtr& _material(const Iterator& it) {
+		++materialsVersion;
 		return this->materials[this->getIndex(it)];
 	}
 	
+	/** Read / write access to internal variables of ODEs */
+	OdeVariables& _odeVars() {
+		return this->odeVariables;
+	}
+	
 	
 	virtual real getMaximalEigenvalue() const override {
 		assert_gt(maximalEigenvalue, 0);
@@ -143,8 +165,13 @@ protected:
 	std::vector<std::vector<PdeVariables>> pdeVariablesNew;
 	std::vector<GcmMatricesPtr> gcmMatrices;
 	std::vector<MaterialPtr> materials;
+	/// internal variables of ODEs for nodes whose materials need them
+	OdeVariables odeVariables;
 	/// @}
 	
+	/// incremented on each write access to materials
+	size_t materialsVersion = 0;
+	
 	/// there is only one "current" PDE time layer, but several "next"(new) layers
 	size_t numberOfNextPdeTimeLayers = 0;
 	/// maximal in modulus eigenvalue of all gcm matrices
@@ -164,6 +191,7 @@ private:
 		}
 		gcmMatrices.resize(this->sizeOfAllNodes(), GcmMatricesPtr());
 		materials.resize(this->sizeOfAllNodes(), MaterialPtr());
+		++materialsVersion;
 	}
 };
 
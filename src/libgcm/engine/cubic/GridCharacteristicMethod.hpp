@@ -24,6 +24,7 @@ public:
 template<typename Mesh>
 class GridCharacteristicMethod : public GridCharacteristicMethodBase {
 public:
+	typedef typename Mesh::Model                 Model;
 	typedef typename Mesh::Matrix                Matrix;
 	typedef typename Mesh::PdeVector             PdeVector;
 	typedef typename Mesh::Iterator              Iterator;
@@ -43,9 +44,8 @@ public:
 			const int s, const real& timeStep, AbstractGrid& mesh_) const override {
 		Mesh& mesh = dynamic_cast<Mesh&>(mesh_);
 		for (auto it : mesh) {
-			mesh._pdeNew(0, it) = localGcmStep(
-					mesh.matrices(it)->m[s].U1,
-					mesh.matrices(it)->m[s].U,
+			mesh._pdeNew(0, it) = Model::localGcmStep(
+					mesh.matrices(it)->m[s],
 					interpolateValuesAround(mesh, s, it,
 							crossingPoints(it, s, timeStep, mesh)));
 		}
@@ -33,7 +33,7 @@ public:
 			const GridConstructionPack& constructionPack,
 			const size_t numberOfNextPdeTimeLayers) = 0;
 	
-	virtual GcmPtr createGcm(const GcmType gcmType) = 0;
+	virtual GcmPtr createGcm(const GcmType gcmType, const int interpolationOrder) = 0;
 	
 	virtual OdePtr createOde(const Odes::T type) = 0;
 	
@@ -62,20 +62,33 @@ public:
 				task, gridId, constructionPack, numberOfNextPdeTimeLayers);
 	}
 	
-	virtual GcmPtr createGcm(const GcmType gcmType) override {
+	virtual GcmPtr createGcm(
+			const GcmType gcmType, const int interpolationOrder) override {
 		switch(gcmType) {
 		case GcmType::ADVECT_RIEMANN_INVARIANTS:
+			if (interpolationOrder != 2) {
+				THROW_UNSUPPORTED("Riemann invariants are interpolated with second order only");
+			}
 			return std::make_shared<GridCharacteristicMethodInRiemannInvariants<Mesh>>();
 		case GcmType::ADVECT_PDE_VECTORS:
-			return std::make_shared<GridCharacteristicMethodInPdeVectors<Mesh>>();
+			return std::make_shared<GridCharacteristicMethodInPdeVectors<Mesh>>(
+					interpolationOrder);
 		default:
 			THROW_UNSUPPORTED("Unknown or unsupported type of gcm-method");
 		}
 	}
 	
 	virtual OdePtr createOde(const Odes::T type) override {
-		assert_true(Odes::T::MAXWELL_VISCOSITY == type); // TODO
-		return std::make_shared<MaxwellViscosityOde<Mesh>>();
+		switch (type) {
+			case Odes::T::MAXWELL_VISCOSITY:
+				return std::make_shared<MaxwellViscosityOde<Mesh>>();
+			case Odes::T::CONTINUAL_DAMAGE:
+				return std::make_shared<ContinualDamageOde<Mesh>>();
+			case Odes::T::IDEAL_PLASTIC_FLOW:
+				return std::make_shared<IdealPlasticFlowCorrector<Mesh>>();
+			default:
+				THROW_UNSUPPORTED("Unknown or unsupported type of ODE");
+		}
 	}
 	
 	virtual SnapPtr createSnapshotter(
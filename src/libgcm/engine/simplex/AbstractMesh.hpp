@@ -17,6 +17,8 @@ public:
 	typedef typename Grid::RealD            RealD;
 	typedef typename Grid::MatrixDD         MatrixDD;
 	typedef typename Grid::ConstructionPack ConstructionPack;
+	typedef typename Grid::LocalVertexIndex LocalVertexIndex;
+	typedef typename Grid::InnerIterator    InnerIterator;
 	
 	/**
 	 * Constructor: grid creation only. We delay with PDE setup
@@ -60,12 +62,96 @@ public:
 	virtual void swapCurrAndNextPdeTimeLayer(const int indexOfNextPde) = 0;
 	
 	/**
-	 * Average all next PDE time layers into current PDE time layer
-	 * (which is single)
+	 * Add next PDE time layer by index 'indexOfNextPde' to the accumulator
+	 * of stages results. On the first stage, the accumulator is just
+	 * replaced by the next layer. The current PDE time layer is untouched.
 	 * Useful for directional splitting into SUMM of stages,
 	 * i.e u_{n+1} = (A_1 * u_{n} + A_2 * u_{n} + A_3 * u_{n}) / 3
 	 */
-	virtual void averageNewPdeLayersToCurrent() = 0;
+	virtual void accumulateNewPdeLayer(
+			const int indexOfNextPde, const bool isFirstStage) = 0;
+	
+	/**
+	 * Set current PDE time layer (which is single) to the average
+	 * of the accumulator and the next PDE time layer by index 'indexOfNextPde'.
+	 * It is called after the last stage instead of accumulateNewPdeLayer.
+	 * @param numberOfStages total number of summed stages
+	 */
+	virtual void averageAccumulatedAndNewPdeLayersToCurrent(
+			const int indexOfNextPde, const int numberOfStages) = 0;
+	
+	
+	/// Local time stepping @{
+	/**
+	 * Distribute inner nodes among time levels.
+	 * Inner nodes of level l are calculated with time step 2^l times larger
+	 * than the finest one, i.e once per 2^l substeps of the finest level.
+	 * Between their calculations, values of coarse nodes are linearly
+	 * interpolated in time, so that the current PDE time layer always
+	 * corresponds to the same time for all nodes of the mesh. At their
+	 * substeps, coarse nodes go through the stages of the splitting as the
+	 * fine ones, but with their time step.
+	 * Border and contact nodes are always on the finest level 0.
+	 * Without the call, all inner nodes are on the level 0.
+	 * @param levels time level for each node of the grid (ignored for
+	 * border and contact nodes), levels of neighbor nodes must differ
+	 * not more than by one
+	 */
+	void setInnerTimeLevels(const std::vector<int>& levels) {
+		assert_eq(levels.size(), this->sizeOfRealNodes());
+		innerIndicesByTimeLevel.clear();
+		for (auto it = this->innerBegin(); it != this->innerEnd(); ++it) {
+			const int level = levels[this->getIndex(*it)];
+			assert_ge(level, 0);
+			if ((int)innerIndicesByTimeLevel.size() <= level) {
+				innerIndicesByTimeLevel.resize((size_t)level + 1);
+			}
+			innerIndicesByTimeLevel[(size_t)level].push_back(*it);
+		}
+	}
+	
+	int numberOfTimeLevels() const {
+		return std::max(1, (int)innerIndicesByTimeLevel.size());
+	}
+	
+	/** Ratio of the time step of the level to the finest time step */
+	static int timeLevelMultiplier(const int level) { return 1 << level; }
+	
+	/** Are nodes of the level calculated at the current substep */
+	bool isTimeLevelActive(const int level) const {
+		return currentSubstep % timeLevelMultiplier(level) == 0;
+	}
+	
+	InnerIterator timeLevelBegin(const int level) const {
+		if (innerIndicesByTimeLevel.empty()) { return this->innerBegin(); }
+		return innerIndicesByTimeLevel[(size_t)level].begin();
+	}
+	
+	InnerIterator timeLevelEnd(const int level) const {
+		if (innerIndicesByTimeLevel.empty()) { return this->innerEnd(); }
+		return innerIndicesByTimeLevel[(size_t)level].end();
+	}
+	
+	/**
+	 * Called before calculation of the substep with given number
+	 * (counted from the beginning of the coarsest time step)
+	 */
+	virtual void beforeSubstep(const int substep) = 0;
+	
+	/**
+	 * Called after calculation of the substep with given number.
+	 * Sets values of coarse nodes, calculated at this substep or before,
+	 * to their time interpolation to the end of the substep.
+	 */
+	virtual void afterSubstep(const int substep) = 0;
+	/// @}
+	
+	
+protected:
+	/// inner nodes indices divided by time levels, empty if only one level
+	std::vector<std::vector<LocalVertexIndex>> innerIndicesByTimeLevel;
+	/// number of the current substep of the coarsest time step
+	int currentSubstep = 0;
 };
 
 } // namespace simplex 
@@ -9,6 +9,7 @@
 #include <libgcm/rheology/models/ElasticModel.hpp>
 #include <libgcm/rheology/models/AcousticModel.hpp>
 #include <libgcm/rheology/materials/IsotropicMaterial.hpp>
+#include <libgcm/rheology/materials/OrthotropicMaterial.hpp>
 
 
 namespace gcm {
@@ -319,45 +320,50 @@ public:
 			const Task::BorderCondition& condition,
 			const Models::T model, const Materials::T material) {
 		
-		if (material != Materials::T::ISOTROPIC) {
-			THROW_UNSUPPORTED("Unsupported material");
+		switch (material) {
+		
+		case Materials::T::ISOTROPIC:
+		switch (model) {
+			case Models::T::ELASTIC:
+				return create<ElasticModelD, IsotropicMaterial>(gcmType, condition);
+			case Models::T::ACOUSTIC:
+				return create<AcousticModelD, IsotropicMaterial>(gcmType, condition);
+			default:
+				THROW_INVALID_ARG("Unknown type of model");
+		}
+		
+		case Materials::T::ORTHOTROPIC:
+		switch (model) {
+			case Models::T::ELASTIC:
+				return create<ElasticModelD, OrthotropicMaterial>(gcmType, condition);
+			default:
+				THROW_UNSUPPORTED("Unknown or inappropriate model type");
+		}
+		
+		default:
+		THROW_UNSUPPORTED("Unsupported material");
+		
 		}
+	}
+
+
+private:
+	template<typename TModel, typename TMaterial>
+	static std::shared_ptr<AbstractBorderCorrector<TGrid>> create(
+			const GcmType gcmType, const Task::BorderCondition& condition) {
 		
-		// TODO - this is a horrible shit:
 		switch (gcmType) {
 		
 		case GcmType::ADVECT_RIEMANN_INVARIANTS:
 		switch (condition.type) {
 			case BorderConditions::T::FIXED_FORCE:
-				switch (model) {
-					case Models::T::ELASTIC:
-						return std::make_shared<BorderCorrectorInRiemannInvariants<
-								ElasticModelD, IsotropicMaterial, TGrid,
-								FixedForceBorderMatrixCreator<ElasticModelD>>>(
-										condition);
-					case Models::T::ACOUSTIC:
-						return std::make_shared<BorderCorrectorInRiemannInvariants<
-								AcousticModelD, IsotropicMaterial, TGrid,
-								FixedForceBorderMatrixCreator<AcousticModelD>>>(
-										condition);
-					default:
-						THROW_INVALID_ARG("Unknown type of model");
-				}
+				return std::make_shared<BorderCorrectorInRiemannInvariants<
+						TModel, TMaterial, TGrid,
+						FixedForceBorderMatrixCreator<TModel>>>(condition);
 			case BorderConditions::T::FIXED_VELOCITY:
-				switch (model) {
-					case Models::T::ELASTIC:
-						return std::make_shared<BorderCorrectorInRiemannInvariants<
-								ElasticModelD, IsotropicMaterial, TGrid,
-								FixedVelocityBorderMatrixCreator<ElasticModelD>>>(
-										condition);
-					case Models::T::ACOUSTIC:
-						return std::make_shared<BorderCorrectorInRiemannInvariants<
-								AcousticModelD, IsotropicMaterial, TGrid,
-								FixedVelocityBorderMatrixCreator<AcousticModelD>>>(
-										condition);
-					default:
-						THROW_INVALID_ARG("Unknown type of model");
-				}
+				return std::make_shared<BorderCorrectorInRiemannInvariants<
+						TModel, TMaterial, TGrid,
+						FixedVelocityBorderMatrixCreator<TModel>>>(condition);
 			default:
 				THROW_INVALID_ARG("Unknown type of border condition");
 		}
@@ -365,35 +371,13 @@ public:
 		case GcmType::ADVECT_PDE_VECTORS:
 		switch (condition.type) {
 			case BorderConditions::T::FIXED_FORCE:
-				switch (model) {
-					case Models::T::ELASTIC:
-						return std::make_shared<BorderCorrectorInPdeVectors<
-								ElasticModelD, IsotropicMaterial, TGrid,
-								FixedForceBorderMatrixCreator<ElasticModelD>>>(
-										condition);
-					case Models::T::ACOUSTIC:
-						return std::make_shared<BorderCorrectorInPdeVectors<
-								AcousticModelD, IsotropicMaterial, TGrid,
-								FixedForceBorderMatrixCreator<AcousticModelD>>>(
-										condition);
-					default:
-						THROW_INVALID_ARG("Unknown type of model");
-				}
+				return std::make_shared<BorderCorrectorInPdeVectors<
+						TModel, TMaterial, TGrid,
+						FixedForceBorderMatrixCreator<TModel>>>(condition);
 			case BorderConditions::T::FIXED_VELOCITY:
-				switch (model) {
-					case Models::T::ELASTIC:
-						return std::make_shared<BorderCorrectorInPdeVectors<
-								ElasticModelD, IsotropicMaterial, TGrid,
-								FixedVelocityBorderMatrixCreator<ElasticModelD>>>(
-										condition);
-					case Models::T::ACOUSTIC:
-						return std::make_shared<BorderCorrectorInPdeVectors<
-								AcousticModelD, IsotropicMaterial, TGrid,
-								FixedVelocityBorderMatrixCreator<AcousticModelD>>>(
-										condition);
-					default:
-						THROW_INVALID_ARG("Unknown type of model");
-				}
+				return std::make_shared<BorderCorrectorInPdeVectors<
+						TModel, TMaterial, TGrid,
+						FixedVelocityBorderMatrixCreator<TModel>>>(condition);
 			default:
 				THROW_INVALID_ARG("Unknown type of border condition");
 		}
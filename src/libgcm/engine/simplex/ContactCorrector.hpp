@@ -8,6 +8,7 @@
 #include <libgcm/rheology/models/ElasticModel.hpp>
 #include <libgcm/rheology/models/AcousticModel.hpp>
 #include <libgcm/rheology/materials/IsotropicMaterial.hpp>
+#include <libgcm/rheology/materials/OrthotropicMaterial.hpp>
 
 
 namespace gcm {
@@ -380,7 +381,7 @@ private:
 	
 	void matchInnersAndOuters(WaveIndices& outersA, WaveIndices& outersB,
 			PdeVector& a, PdeVector& b) const {
-		const size_t N = (outersA.size() + outersB.size()) / OUTER_NUMBER;
+		const int N = (outersA.size() + outersB.size()) / OUTER_NUMBER;
 		if (N % 2 == 0) {
 			return;
 		} else if (N == 3) {
@@ -500,14 +501,10 @@ public:
 		switch (condition) {
 			case ContactConditions::T::ADHESION:
 				if (model1 == Models::T::ELASTIC &&
-				    model2 == Models::T::ELASTIC &&
-				    material1 == Materials::T::ISOTROPIC &&
-				    material2 == Materials::T::ISOTROPIC) {
+				    model2 == Models::T::ELASTIC) {
 					
-					return std::make_shared<ContactCorrectorInRiemannInvariants<
-							ElasticModelD, IsotropicMaterial,
-							ElasticModelD, IsotropicMaterial, TGrid,
-							AdhesionContactMatrixCreator<ElasticModelD, ElasticModelD>>>(condition);
+					return createElasticAdhesion<ContactCorrectorInRiemannInvariants>(
+							condition, material1, material2);
 					
 				} else {
 					THROW_UNSUPPORTED("Incompatible or unsupported contact conditions, \
@@ -538,14 +535,10 @@ public:
 		switch (condition) {
 			case ContactConditions::T::ADHESION:
 				if (model1 == Models::T::ELASTIC &&
-					model2 == Models::T::ELASTIC &&
-					material1 == Materials::T::ISOTROPIC &&
-					material2 == Materials::T::ISOTROPIC) {
+					model2 == Models::T::ELASTIC) {
 					
-					return std::make_shared<ContactCorrectorInPdeVectors<
-							ElasticModelD, IsotropicMaterial,
-							ElasticModelD, IsotropicMaterial, TGrid,
-							AdhesionContactMatrixCreator<ElasticModelD, ElasticModelD>>>(condition);
+					return createElasticAdhesion<ContactCorrectorInPdeVectors>(
+							condition, material1, material2);
 					
 				} else {
 					THROW_UNSUPPORTED("Incompatible or unsupported contact conditions, \
@@ -577,6 +570,45 @@ public:
 		
 		}
 	}
+
+
+private:
+	/** Adhesion of elastic bodies, any of them can be orthotropic */
+	template<template<typename, typename, typename, typename, typename, typename>
+	         class TCorrector>
+	static std::shared_ptr<AbstractContactCorrector<TGrid>> createElasticAdhesion(
+			const ContactConditions::T condition,
+			const Materials::T material1, const Materials::T material2) {
+		switch (material1) {
+			case Materials::T::ISOTROPIC:
+				return createElasticAdhesionWith<TCorrector, IsotropicMaterial>(
+						condition, material2);
+			case Materials::T::ORTHOTROPIC:
+				return createElasticAdhesionWith<TCorrector, OrthotropicMaterial>(
+						condition, material2);
+			default:
+				THROW_UNSUPPORTED("Unsupported material");
+		}
+	}
+	
+	template<template<typename, typename, typename, typename, typename, typename>
+	         class TCorrector, typename TMaterialA>
+	static std::shared_ptr<AbstractContactCorrector<TGrid>> createElasticAdhesionWith(
+			const ContactConditions::T condition, const Materials::T material2) {
+		typedef AdhesionContactMatrixCreator<ElasticModelD, ElasticModelD> MatrixCreator;
+		switch (material2) {
+			case Materials::T::ISOTROPIC:
+				return std::make_shared<TCorrector<
+						ElasticModelD, TMaterialA,
+						ElasticModelD, IsotropicMaterial, TGrid, MatrixCreator>>(condition);
+			case Materials::T::ORTHOTROPIC:
+				return std::make_shared<TCorrector<
+						ElasticModelD, TMaterialA,
+						ElasticModelD, OrthotropicMaterial, TGrid, MatrixCreator>>(condition);
+			default:
+				THROW_UNSUPPORTED("Unsupported material");
+		}
+	}
 };
 
 
@@ -1,7 +1,13 @@
 #ifndef LIBGCM_SIMPLEX_DEFAULTMESH_HPP
 #define LIBGCM_SIMPLEX_DEFAULTMESH_HPP
 
+#include <array>
+#include <cmath>
+#include <exception>
+#include <map>
+
 #include <libgcm/engine/simplex/AbstractMesh.hpp>
+#include <libgcm/rheology/variables/OdeVariables.hpp>
 #include <libgcm/util/task/InitialCondition.hpp>
 
 
@@ -22,9 +28,9 @@ public:
 	typedef TModel                              Model;
 	typedef typename Model::PdeVariables        PdeVariables;
 	typedef typename Model::PdeVector           PdeVector;
-	typedef typename Model::GCM_MATRICES        GCM_MATRICES;
-	typedef typename Model::GcmMatricesPtr      GcmMatricesPtr;
-	typedef typename Model::ConstGcmMatricesPtr ConstGcmMatricesPtr;
+	typedef typename Model::LEAN_GCM_MATRICES   GCM_MATRICES;
+	typedef std::shared_ptr<GCM_MATRICES>       GcmMatricesPtr;
+	typedef std::shared_ptr<const GCM_MATRICES> ConstGcmMatricesPtr;
 	typedef typename GCM_MATRICES::Matrix       Matrix;
 	/// Type of auxiliary info sent from inner gcm to border/contact correctors
 	typedef typename Model::WaveIndices         WaveIndices;
@@ -36,6 +42,7 @@ public:
 	typedef typename Base::RealD                RealD;
 	typedef typename Base::MatrixDD             MatrixDD;
 	typedef typename Grid::Iterator             Iterator;
+	typedef gcm::OdeVariables<Iterator>         OdeVariables;
 	
 	typedef TMaterial                           Material;
 	typedef std::shared_ptr<Material>           MaterialPtr;
@@ -66,6 +73,7 @@ public:
 		pdeIsSetUp = true;
 		allocate();
 		applyMaterialsCondition(task, innerBasis, borderCalcMode);
+		odeVariables.allocate(*this, task);
 		InitialCondition<Model, Grid, Material, DefaultMesh>::apply(task, this);
 	}
 	
@@ -106,9 +114,22 @@ public:
 		return this->materials[this->getIndex(it)];
 	}
 	
-	/** Read-only access to WaveIndices */
+	/**
+	 * The number changes whenever materials of nodes may have changed,
+	 * so caches of per-node materials know when to be rebuilt
+	 */
+	size_t getMaterialsVersion() const {
+		return materialsVersion;
+	}
+	
+	/** Read-only access to WaveIndices (border and contact nodes only) */
 	WaveIndices waveIndices(const Iterator& it) const {
-		return this->waveIndicesData[this->getIndex(it)];
+		return this->waveIndicesData[waveIndicesSlot(it)];
+	}
+	
+	/** Read-only access to internal variables of ODEs */
+	const OdeVariables& odeVars() const {
+		return this->odeVariables;
 	}
 	
 	
@@ -140,14 +161,20 @@ public:
 		return this->gcmMatrices[this->getIndex(it)];
 	}
 	
-	/** Read / write access to actual GCM matrices */
+	/** Read / write access to material, counts as its change */
 	MaterialPtr& _material(const Iterator& it) {
+		++materialsVersion;
 		return this->materials[this->getIndex(it)];
 	}
 	
-	/** Read / write access to WaveIndices */
+	/** Read / write access to internal variables of ODEs */
+	OdeVariables& _odeVars() {
+		return this->odeVariables;
+	}
+	
+	/** Read / write access to WaveIndices (border and contact nodes only) */
 	WaveIndices& _waveIndices(const Iterator& it) {
-		return this->waveIndicesData[this->getIndex(it)];
+		return this->waveIndicesData[waveIndicesSlot(it)];
 	}
 	
 	
@@ -156,13 +183,75 @@ public:
 		return maximalEigenvalue;
 	}
 	
-	virtual void averageNewPdeLayersToCurrent() override {
-		for (Iterator it : *this) {
-			_pde(it) = PdeVector::Zeros();
+	virtual void accumulateNewPdeLayer(
+			const int indexOfNextPde, const bool isFirstStage) override {
+		assert_lt(indexOfNextPde, (int)numberOfNextPdeTimeLayers);
+		std::vector<PdeVariables>& next = pdeVariablesNew[(size_t)indexOfNextPde];
+		if (isFirstStage) {
+			/// next layer is fully rewritten by each stage, so no copy is needed
+			if (pdeVariablesAccumulated.size() != next.size()) {
+				pdeVariablesAccumulated.resize(next.size());
+			}
+			std::swap(pdeVariablesAccumulated, next);
+			return;
+		}
+		assert_eq(pdeVariablesAccumulated.size(), next.size());
+		const size_t size = next.size();
+		#pragma omp parallel for
+		for (size_t i = 0; i < size; i++) {
+			pdeVariablesAccumulated[i] += next[i];
+		}
+	}
+	
+	virtual void averageAccumulatedAndNewPdeLayersToCurrent(
+			const int indexOfNextPde, const int numberOfStages) override {
+		assert_lt(indexOfNextPde, (int)numberOfNextPdeTimeLayers);
+		const std::vector<PdeVariables>& next =
+				pdeVariablesNew[(size_t)indexOfNextPde];
+		assert_eq(pdeVariablesAccumulated.size(), next.size());
+		assert_eq(pdeVariables.size(), next.size());
+		const real w = real(1) / real(numberOfStages);
+		const size_t size = next.size();
+		#pragma omp parallel for
+		for (size_t i = 0; i < size; i++) {
+			PdeVector& current = pdeVariables[i];
+			current = (pdeVariablesAccumulated[i] + next[i]) * w;
 		}
-		for (int s = 0; s < (int)numberOfNextPdeTimeLayers; s++) {
-			for (Iterator it : *this) {
-				_pde(it) += pdeNew(s, it) / numberOfNextPdeTimeLayers;
+	}
+	
+	virtual void beforeSubstep(const int substep) override {
+		this->currentSubstep = substep;
+		if (this->numberOfTimeLevels() == 1) { return; }
+		if (pdeVariablesLevelStart.size() != pdeVariables.size()) {
+			pdeVariablesLevelStart.resize(pdeVariables.size());
+			pdeVariablesLevelEnd.resize(pdeVariables.size());
+		}
+		/// remember values at the beginning of time steps of coarse levels
+		for (int level = 1; level < this->numberOfTimeLevels(); level++) {
+			if (!this->isTimeLevelActive(level)) { continue; }
+			for (auto it = this->timeLevelBegin(level);
+			          it != this->timeLevelEnd(level); ++it) {
+				const size_t i = this->getIndex(*it);
+				pdeVariablesLevelStart[i] = pdeVariables[i];
+			}
+		}
+	}
+	
+	virtual void afterSubstep(const int substep) override {
+		assert_eq(substep, this->currentSubstep);
+		for (int level = 1; level < this->numberOfTimeLevels(); level++) {
+			const int multiplier = this->timeLevelMultiplier(level);
+			const bool isActive = this->isTimeLevelActive(level);
+			const real w = real(substep % multiplier + 1) / real(multiplier);
+			for (auto it = this->timeLevelBegin(level);
+			          it != this->timeLevelEnd(level); ++it) {
+				const size_t i = this->getIndex(*it);
+				if (isActive) {
+					pdeVariablesLevelEnd[i] = pdeVariables[i];
+				}
+				PdeVector& current = pdeVariables[i];
+				current = pdeVariablesLevelStart[i] +
+						(pdeVariablesLevelEnd[i] - pdeVariablesLevelStart[i]) * w;
 			}
 		}
 	}
@@ -197,11 +286,24 @@ protected:
 	/// Data storage @{
 	std::vector<PdeVariables> pdeVariables;
 	std::vector<std::vector<PdeVariables>> pdeVariablesNew;
+	/// sum of stages results for SUMM splitting, allocated on demand
+	std::vector<PdeVariables> pdeVariablesAccumulated;
+	/// values of coarse time levels nodes at the beginning and the end of
+	/// their time step, allocated on demand, @see AbstractMesh::setInnerTimeLevels
+	std::vector<PdeVariables> pdeVariablesLevelStart;
+	std::vector<PdeVariables> pdeVariablesLevelEnd;
 	std::vector<GcmMatricesPtr> gcmMatrices;
 	std::vector<MaterialPtr> materials;
+	/// internal variables of ODEs for nodes whose materials need them
+	OdeVariables odeVariables;
+	/// only for contact and border nodes, in order of contact and border
+	/// indices of the grid, @see waveIndicesSlot
 	std::vector<WaveIndices> waveIndicesData;
 	/// @}
 	
+	/// incremented on each write access to materials
+	size_t materialsVersion = 0;
+	
 	/// there is only one "current" PDE time layer, but several "next"(new) layers
 	size_t numberOfNextPdeTimeLayers = 0;
 	/// maximal in modulus eigenvalue of all gcm matrices
@@ -219,9 +321,35 @@ private:
 		}
 		gcmMatrices.resize(this->sizeOfAllNodes(), GcmMatricesPtr());
 		materials.resize(this->sizeOfAllNodes(), MaterialPtr());
-		// yes, it's not used in inner nodes at all.
-		// but saving this not a big amount of memory requires much pain
-		waveIndicesData.resize(this->sizeOfAllNodes());
+		++materialsVersion;
+		waveIndicesData.resize(numberOfContactNodes() + numberOfBorderNodes());
+	}
+	
+	size_t numberOfContactNodes() const {
+		return (size_t)(this->contactEnd() - this->contactBegin());
+	}
+	
+	size_t numberOfBorderNodes() const {
+		return (size_t)(this->borderEnd() - this->borderBegin());
+	}
+	
+	/**
+	 * Position of the border or contact node in waveIndicesData.
+	 * Contact nodes go first, border nodes go after them.
+	 * Contact and border indices of the grid are sorted ascending,
+	 * so binary search is used instead of a per-node storage.
+	 */
+	size_t waveIndicesSlot(const Iterator& it) const {
+		const size_t index = this->getIndex(it);
+		const auto contact = std::lower_bound(
+				this->contactBegin(), this->contactEnd(), index);
+		if (contact != this->contactEnd() && *contact == index) {
+			return (size_t)(contact - this->contactBegin());
+		}
+		const auto border = std::lower_bound(
+				this->borderBegin(), this->borderEnd(), index);
+		assert_true(border != this->borderEnd() && *border == index);
+		return numberOfContactNodes() + (size_t)(border - this->borderBegin());
 	}
 	
 	void applyMaterialsCondition(const Task& task, const MatrixDD& innerBasis,
@@ -244,23 +372,67 @@ private:
 		
 		if (borderCalcMode == BorderCalcMode::GLOBAL_BASIS) { return; }
 		
+		std::vector<std::pair<Iterator, RealD>> localBasisNodes;
 		for (auto it = this->borderBegin(); it != this->borderEnd(); ++it) {
-			const RealD borderNormal = this->borderNormal(*it);
-			_matrices(*it) = std::make_shared<GCM_MATRICES>();
-			Model::constructGcmMatrices(_matrices(*it), concreteMaterial,
-					linal::createLocalBasisWithX(borderNormal));
-			if (matrices(*it)->getMaximalEigenvalue() > maximalEigenvalue) {
-				maximalEigenvalue = matrices(*it)->getMaximalEigenvalue();
+			localBasisNodes.push_back({*it, this->borderNormal(*it)});
+		}
+		for (auto it = this->contactBegin(); it != this->contactEnd(); ++it) {
+			localBasisNodes.push_back({*it, this->contactNormal(*it)});
+		}
+		constructLocalBasisMatrices(localBasisNodes);
+	}
+	
+	/**
+	 * Construct GCM matrices of border and contact nodes in local bases
+	 * given by their normals. Nodes of the same material with equal normals
+	 * (e.g., on a flat part of the border) share matrices, because for
+	 * anisotropic materials their construction involves eigenproblems.
+	 * Normals are compared on a grid with step NORMAL_QUANTUM, so
+	 * roundoff in normals of a flat border does not split the cache.
+	 * Distinct matrices are constructed in parallel.
+	 */
+	void constructLocalBasisMatrices(
+			const std::vector<std::pair<Iterator, RealD>>& localBasisNodes) {
+		static constexpr real NORMAL_QUANTUM = 1e-9;
+		typedef std::array<long long, (size_t)DIMENSIONALITY> Normal;
+		std::map<std::pair<const Material*, Normal>, size_t> cache;
+		std::vector<std::pair<ConstMaterialPtr, RealD>> distinct;
+		std::vector<size_t> cached;
+		for (const auto& node : localBasisNodes) {
+			const ConstMaterialPtr nodeMaterial = material(node.first);
+			Normal normal;
+			for (int i = 0; i < DIMENSIONALITY; i++) {
+				normal[(size_t)i] = std::llround(node.second(i) / NORMAL_QUANTUM);
 			}
+			const auto found = cache.insert(
+					{{nodeMaterial.get(), normal}, distinct.size()});
+			if (found.second) {
+				distinct.push_back({nodeMaterial, node.second});
+			}
+			cached.push_back(found.first->second);
 		}
 		
-		for (auto it = this->contactBegin(); it != this->contactEnd(); ++it) {
-			const RealD contactNormal = this->contactNormal(*it);
-			_matrices(*it) = std::make_shared<GCM_MATRICES>();
-			Model::constructGcmMatrices(_matrices(*it), concreteMaterial,
-					linal::createLocalBasisWithX(contactNormal));
-			if (matrices(*it)->getMaximalEigenvalue() > maximalEigenvalue) {
-				maximalEigenvalue = matrices(*it)->getMaximalEigenvalue();
+		std::vector<GcmMatricesPtr> distinctMatrices(distinct.size());
+		std::vector<std::exception_ptr> errors(distinct.size());
+		#pragma omp parallel for
+		for (size_t k = 0; k < distinct.size(); k++) {
+			try {
+				distinctMatrices[k] = std::make_shared<GCM_MATRICES>();
+				Model::constructGcmMatrices(distinctMatrices[k], distinct[k].first,
+						linal::createLocalBasisWithX(distinct[k].second));
+			} catch (...) {
+				errors[k] = std::current_exception();
+			}
+		}
+		for (const std::exception_ptr& error : errors) {
+			if (error) { std::rethrow_exception(error); }
+		}
+		
+		for (size_t i = 0; i < localBasisNodes.size(); i++) {
+			_matrices(localBasisNodes[i].first) = distinctMatrices[cached[i]];
+			const real eigenvalue = distinctMatrices[cached[i]]->getMaximalEigenvalue();
+			if (eigenvalue > maximalEigenvalue) {
+				maximalEigenvalue = eigenvalue;
 			}
 		}
 	}
@@ -1,7 +1,12 @@
 #include <libgcm/engine/simplex/Engine.hpp>
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
 
+#include <algorithm>
 #include <limits>
+#include <cmath>
+#include <exception>
+#include <numeric>
 
 using namespace gcm;
 using namespace gcm::simplex;
@@ -15,17 +20,23 @@ Engine(const Task& task) :
 		triangulation(task),
 		movable(task.simplexGrid.movable),
 		borderCalcMode(task.simplexGrid.borderCalcMode),
+		maxTimeLevel(task.simplexGrid.maxTimeLevel),
+		interpolationOrder(task.simplexGrid.interpolationOrder),
 		gcmType(task.globalSettings.gcmType),
-		splittingType(task.globalSettings.splittingType),
-		stageVsLayerMap(createStageVsLayerMap(splittingType)) {
+		splittingType(task.globalSettings.splittingType) {
+	
+	/// Riemann invariants are calculated in each node by its own matrices,
+	/// so invariants of border nodes in local bases and invariants of
+	/// their neighbors in the global basis can't be interpolated together
+	if (borderCalcMode == BorderCalcMode::LOCAL_BASIS &&
+			gcmType == GcmType::ADVECT_RIEMANN_INVARIANTS) {
+		THROW_UNSUPPORTED("Borders in local basis require advection of pde vectors");
+	}
 	
 	initializeCalculationBasis(task);
-	createMeshes(task);
+	measure("meshes creation", [&] { createMeshes(task); });
 	createContacts(task);
-	for (auto vertexIter  = triangulation.verticesBegin();
-	          vertexIter != triangulation.verticesEnd(); ++vertexIter) {
-		addBorderOrContact(vertexIter);
-	}
+	measure("borders and contacts search", [&] { findBordersAndContacts(); });
 	
 	LOG_INFO("Found contacts:");
 	for (const auto& contact : contacts) {
@@ -42,33 +53,177 @@ Engine(const Task& task) :
 					<< body.borders[i].borderNodes.size());
 		}
 	}
-	applyPlainBorderContactCorrection(Clock::Time());
+	measure("initial border and contact correction", [&] {
+		applyPlainBorderContactCorrection(Clock::Time()); });
+	if (maxTimeLevel > 0) {
+		measure("time levels assignment", [&] { assignTimeLevels(); });
+	}
 	
 	afterConstruction(task);
 }
 
 
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+void Engine<Dimensionality, TriangulationT>::
+assignTimeLevels() {
+/// Inner node goes to the coarsest level l such that its local stable
+/// time step (by minimal height of incident cells) is not less than
+/// 2^l finest time steps. Border and contact nodes with their neighbors
+/// are kept on the finest level, because time interpolation of values
+/// of border and contact nodes is not supported by correctors.
+	assert_gt(maxTimeLevel, 0);
+	const real finest = finestTimeStep();
+	int coarsestLevel = 0;
+	
+	for (const Body& body : bodies) {
+		const Mesh& mesh = *body.mesh;
+		const std::vector<real> heights = mesh.nodalMinimalHeights();
+		const size_t size = mesh.sizeOfRealNodes();
+		std::vector<int> levels(size, 0);
+		
+		for (auto it = mesh.innerBegin(); it != mesh.innerEnd(); ++it) {
+			const size_t i = mesh.getIndex(*it);
+			const real ratio = CourantNumber * heights[i] /
+					mesh.getMaximalEigenvalue() / finest;
+			if (ratio >= 2) {
+				levels[i] = std::min(maxTimeLevel, (int)std::floor(std::log2(ratio)));
+			}
+		}
+		
+		/// CSR-like storage of neighbors: neighbors of the node i are
+		/// between neighborsOffsets[i] and neighborsOffsets[i + 1];
+		/// count them by cells, fill in, then drop repeats of common edges
+		std::vector<size_t> neighborsOffsets(size + 1, 0);
+		for (auto ch = mesh.cellBegin(); ch != mesh.cellEnd(); ++ch) {
+			const auto cell = mesh.createCell(*ch);
+			for (int k = 0; k < cell.n; k++) {
+				neighborsOffsets[mesh.getIndex(cell(k)) + 1] += (size_t)cell.n - 1;
+			}
+		}
+		for (size_t i = 0; i < size; i++) {
+			neighborsOffsets[i + 1] += neighborsOffsets[i];
+		}
+		std::vector<size_t> neighbors(neighborsOffsets.back());
+		std::vector<size_t> filled(neighborsOffsets.begin(), neighborsOffsets.end() - 1);
+		for (auto ch = mesh.cellBegin(); ch != mesh.cellEnd(); ++ch) {
+			const auto cell = mesh.createCell(*ch);
+			for (int k = 0; k < cell.n; k++) {
+				const size_t i = mesh.getIndex(cell(k));
+				for (int l = 0; l < cell.n; l++) {
+					if (l != k) { neighbors[filled[i]++] = mesh.getIndex(cell(l)); }
+				}
+			}
+		}
+		size_t unique = 0;
+		for (size_t i = 0; i < size; i++) {
+			const auto begin = neighbors.begin() + (std::ptrdiff_t)neighborsOffsets[i];
+			const auto end = neighbors.begin() + (std::ptrdiff_t)neighborsOffsets[i + 1];
+			std::sort(begin, end);
+			neighborsOffsets[i] = unique;
+			for (auto j = begin; j != end; ++j) {
+				if (j == begin || *j != neighbors[unique - 1]) { neighbors[unique++] = *j; }
+			}
+		}
+		neighborsOffsets[size] = unique;
+		neighbors.resize(unique);
+		
+		auto keepOnFinestLevel = [&](const Iterator it) {
+			const size_t i = mesh.getIndex(it);
+			for (size_t j = neighborsOffsets[i]; j < neighborsOffsets[i + 1]; j++) {
+				levels[neighbors[j]] = 0;
+			}
+		};
+		for (auto it = mesh.contactBegin(); it != mesh.contactEnd(); ++it) {
+			keepOnFinestLevel(*it);
+		}
+		for (auto it = mesh.borderBegin(); it != mesh.borderEnd(); ++it) {
+			keepOnFinestLevel(*it);
+		}
+		
+		/// levels of neighbor nodes must differ not more than by one
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (auto it = mesh.innerBegin(); it != mesh.innerEnd(); ++it) {
+				const size_t i = mesh.getIndex(*it);
+				for (size_t j = neighborsOffsets[i]; j < neighborsOffsets[i + 1]; j++) {
+					const int bound = levels[neighbors[j]] + 1;
+					if (levels[i] > bound) {
+						levels[i] = bound;
+						changed = true;
+					}
+				}
+			}
+		}
+		
+		body.mesh->setInnerTimeLevels(levels);
+		coarsestLevel = std::max(coarsestLevel, mesh.numberOfTimeLevels() - 1);
+		
+		for (int level = 0; level < mesh.numberOfTimeLevels(); level++) {
+			LOG_INFO("Body " << mesh.id << ": number of inner nodes on time level "
+					<< level << " = "
+					<< mesh.timeLevelEnd(level) - mesh.timeLevelBegin(level));
+		}
+	}
+	
+	numberOfSubsteps = Mesh::timeLevelMultiplier(coarsestLevel);
+	LOG_INFO("Local time stepping: number of substeps = " << numberOfSubsteps);
+}
+
+
 template<int Dimensionality,
          template<int, typename, typename> class TriangulationT>
 void Engine<Dimensionality, TriangulationT>::
 createMeshes(const Task& task) {
+	/// cells of all grids are found in one pass over the triangulation
+	auto cellsOfAllGrids = Grid::cellsOfAllGrids(&triangulation);
+	
+	std::vector<GridId> gridIds;
+	std::vector<const Task::Body*> taskBodies;
+	std::vector<const std::vector<CellHandle>*> cells;
+	std::vector<std::shared_ptr<AbstractFactoryBase<Grid>>> factories;
 	for (const auto& taskBody : task.bodies) {
+		gridIds.push_back(taskBody.first);
+		taskBodies.push_back(&taskBody.second);
+		cells.push_back(&cellsOfAllGrids[taskBody.first]);
+		factories.push_back(createAbstractFactory(taskBody.second));
+	}
+	
+	/// grids do not write to the triangulation shared data,
+	/// so they can be constructed in parallel
+	const size_t size = taskBodies.size();
+	std::vector<std::shared_ptr<Mesh>> meshes(size);
+	std::vector<std::exception_ptr> errors(size);
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t i = 0; i < size; i++) {
+		try {
+			meshes[i] = factories[i]->createMesh(task, gridIds[i],
+					{&triangulation, cells[i]}, 1);
+		} catch (...) {
+			errors[i] = std::current_exception();
+		}
+	}
+	for (const std::exception_ptr& error : errors) {
+		if (error) { std::rethrow_exception(error); }
+	}
+	
+	for (size_t i = 0; i < size; i++) {
 		Body body;
-		const GridId gridId = taskBody.first;
-		auto factory = createAbstractFactory(taskBody.second);
+		const Task::Body& taskBody = *taskBodies[i];
+		auto factory = factories[i];
 		
-		body.mesh = factory->createMesh(
-				task, gridId, {&triangulation}, numberOfNextPdeTimeLayers());
+		body.mesh = meshes[i];
 		body.mesh->setUpPde(task, calculationBasis.basis, borderCalcMode);
 		
-		body.gcm = factory->createGcm(gcmType);
+		body.gcm = factory->createGcm(gcmType, interpolationOrder);
 		
 		for (const Snapshotters::T snapType : task.globalSettings.snapshottersId) {
 			body.snapshotters.push_back(
 					factory->createSnapshotter(task, snapType));
 		}
 		
-		for (const Odes::T odeType : taskBody.second.odes) {
+		for (const Odes::T odeType : taskBody.odes) {
 			body.odes.push_back(factory->createOde(odeType));
 		}
 		
@@ -97,13 +252,19 @@ void Engine<Dimensionality, TriangulationT>::
 nextTimeStep() {
 	changeCalculationBasis();
 	
-	applyPlainBorderContactCorrection(Clock::Time() + Clock::TimeStep());
-	for (int stage = 0; stage < Dimensionality; stage++) {
-		gcmStage(stage, Clock::Time(), Clock::TimeStep());
-	}
-	if (splittingType == SplittingType::SUMM) {
+	/// without local time stepping, the only substep is the whole time step
+	const real substepTime = Clock::TimeStep() / numberOfSubsteps;
+	for (int substep = 0; substep < numberOfSubsteps; substep++) {
+		const real currentTime = Clock::Time() + substep * substepTime;
+		for (const Body& body : bodies) {
+			body.mesh->beforeSubstep(substep);
+		}
+		applyPlainBorderContactCorrection(currentTime + substepTime);
+		for (int stage = 0; stage < Dimensionality; stage++) {
+			gcmStage(stage, currentTime, substepTime);
+		}
 		for (const Body& body : bodies) {
-			body.mesh->averageNewPdeLayersToCurrent();
+			body.mesh->afterSubstep(substep);
 		}
 	}
 	
@@ -120,23 +281,37 @@ template<int Dimensionality,
 void Engine<Dimensionality, TriangulationT>::
 gcmStage(const int stage, const real currentTime, const real timeStep) {
 	for (const Body& body : bodies) {
-		body.gcm->beforeStage(stageVsLayerMap[(size_t)stage], stage, *body.mesh);
+		body.gcm->beforeStage(0, stage, *body.mesh);
 	}
 	for (const Body& body : bodies) {
-		body.gcm->contactAndBorderStage(
-				stageVsLayerMap[(size_t)stage], stage, timeStep, *body.mesh);
+		body.gcm->contactAndBorderStage(0, stage, timeStep, *body.mesh);
 	}
 	correctContactsAndBorders(stage, currentTime + timeStep);
 	for (const Body& body : bodies) {
-		body.gcm->innerStage(stageVsLayerMap[(size_t)stage], stage, timeStep, *body.mesh);
+		body.gcm->innerStage(0, stage, timeStep, *body.mesh);
 	}
 	for (const Body& body : bodies) {
-		body.gcm->afterStage(stageVsLayerMap[(size_t)stage], stage, *body.mesh);
+		body.gcm->afterStage(0, stage, *body.mesh);
 	}
-	if (splittingType == SplittingType::PRODUCT) {
-		for (const Body& body : bodies) {
-			body.mesh->swapCurrAndNextPdeTimeLayer(0);
-		}
+	switch (splittingType) {
+		case SplittingType::PRODUCT:
+			for (const Body& body : bodies) {
+				body.mesh->swapCurrAndNextPdeTimeLayer(0);
+			}
+			break;
+			
+		case SplittingType::SUMM:
+			for (const Body& body : bodies) {
+				if (stage == Dimensionality - 1) {
+					body.mesh->averageAccumulatedAndNewPdeLayersToCurrent(0, Dimensionality);
+				} else {
+					body.mesh->accumulateNewPdeLayer(0, stage == 0);
+				}
+			}
+			break;
+			
+		default:
+			THROW_BAD_CONFIG("Unknown splitting type");
 	}
 }
 
@@ -149,7 +324,7 @@ correctContactsAndBorders(const int stage, const real timeAtNextLayer) {
 		case BorderCalcMode::GLOBAL_BASIS:
 			for (const auto& contact : contacts) {
 				contact.second.contactCorrector->applyInGlobalBasis(
-						stageVsLayerMap[(size_t)stage],
+						0,
 						stage,
 						getBody(contact.first.first).mesh,
 						getBody(contact.first.second).mesh,
@@ -158,7 +333,7 @@ correctContactsAndBorders(const int stage, const real timeAtNextLayer) {
 			for (const Body& body : bodies) {
 				for (const Border& border : body.borders) {
 					border.borderCorrector->applyInGlobalBasis(
-							stageVsLayerMap[(size_t)stage],
+							0,
 							stage,
 							body.mesh,
 							border.borderNodes,
@@ -249,63 +424,125 @@ createContacts(const Task& task) {
 template<int Dimensionality,
          template<int, typename, typename> class TriangulationT>
 void Engine<Dimensionality, TriangulationT>::
-addBorderOrContact(const VertexHandle vh) {
-	std::set<GridId> incidentGrids = triangulation.incidentGridsIds(vh);
-	if (incidentGrids.size() == 1) { return; }
+findBordersAndContacts() {
+/// A vertex shared by several grids (or a grid and empty space) is
+/// a contact node, if there are exactly two grids around it,
+/// or a border node of every grid around it otherwise.
+/// Grids around the vertex and normals are gathered from boundary facets
+	typedef typename Grid::BoundaryVertex   BoundaryVertex;
+	typedef typename Grid::LocalVertexIndex LocalVertexIndex;
 	
-	if (incidentGrids.erase((size_t)EmptySpaceFlag)) {
-		for (const GridId id : incidentGrids) {
-			addBorderNode(vh, id);
-		}
-	} else {
-		if (incidentGrids.size() == 2) {
-			addContactNode(vh, {*incidentGrids.begin(), *incidentGrids.rbegin()});
-		} else {
-			for (const GridId id : incidentGrids) {
-				addBorderNode(vh, id);
-			}
-		}
+	std::vector<std::vector<BoundaryVertex>> boundaries(bodies.size());
+	size_t numberOfBoundaryVertices = 0;
+	for (size_t b = 0; b < bodies.size(); b++) {
+		boundaries[b] = bodies[b].mesh->boundaryVertices();
+		numberOfBoundaryVertices += boundaries[b].size();
 	}
-}
-
-
-template<int Dimensionality,
-         template<int, typename, typename> class TriangulationT>
-void Engine<Dimensionality, TriangulationT>::
-addContactNode(const VertexHandle vh, const GridsPair gridsIds) {
+	LOG_INFO("Number of boundary vertices of all grids: " << numberOfBoundaryVertices);
 	
-	Iterator firstIter = getBody(gridsIds.first).mesh->localVertexIndex(vh);
-	Iterator secondIter = getBody(gridsIds.second).mesh->localVertexIndex(vh);
-	RealD normal = getBody(gridsIds.first).mesh->contactNormal(firstIter, gridsIds.second);
-	if (normal != RealD::Zeros()) {
-		contacts.at(gridsIds).nodesInContact.push_back(
-				{ firstIter, secondIter, normal });
-	}
-}
-
-
-template<int Dimensionality,
-         template<int, typename, typename> class TriangulationT>
-void Engine<Dimensionality, TriangulationT>::
-addBorderNode(const VertexHandle vh, const GridId gridId) {
-	assert_ne(gridId, EmptySpaceFlag);
-	std::shared_ptr<Mesh> mesh = getBody(gridId).mesh;
-	Iterator iter = mesh->localVertexIndex(vh);
-	const bool isMulticontact = mesh->borderNormal(iter) == RealD::Zeros();
+	/// boundary info of the vertex in the body (it must be there)
+	auto boundaryOf = [&](const size_t b, const VertexHandle vh) -> const BoundaryVertex& {
+		const LocalVertexIndex it = bodies[b].mesh->localVertexIndex(vh);
+		const auto found = std::lower_bound(boundaries[b].begin(), boundaries[b].end(),
+				it, [](const BoundaryVertex& a, const LocalVertexIndex i) {
+						return a.vertex < i; });
+		assert_true(found != boundaries[b].end() && found->vertex == it);
+		return *found;
+	};
 	
-	// for a concrete node, not more than one border condition can be applied
-	Border* chosenBorder = nullptr;
-	for (Border& border : getBody(gridId).borders) {
-		if ( border.correctionArea->contains(mesh->coords(iter)) &&
-				(!isMulticontact || border.useForMulticontactNodes) ) {
-			chosenBorder = &border;
+	for (size_t b = 0; b < bodies.size(); b++) {
+		const Body& body = bodies[b];
+		const Mesh& mesh = *body.mesh;
+		const std::vector<BoundaryVertex>& boundary = boundaries[b];
+		const size_t size = boundary.size();
+		
+		/// what to do with the vertex: contact with some grid
+		/// or border condition to apply (if any)
+		std::vector<GridId> contactWith(size, EmptySpaceFlag);
+		std::vector<int> chosenBorder(size, -1);
+		std::vector<RealD> normals(size, RealD::Zeros());
+		/// bodyIndex and boundaryOf can throw, but not out of the parallel region
+		std::vector<std::exception_ptr> errors(size);
+		
+		#pragma omp parallel for schedule(dynamic, 64)
+		for (size_t i = 0; i < size; i++) {
+			try {
+				const BoundaryVertex& boundaryVertex = boundary[i];
+				const VertexHandle vh = mesh.vertexHandle(boundaryVertex.vertex);
+				
+				/// all grids around the vertex, including those seen
+				/// only from boundary facets of other grids
+				std::set<GridId> grids(boundaryVertex.neighborIds.begin(),
+				                       boundaryVertex.neighborIds.end());
+				grids.insert(mesh.id);
+				std::vector<GridId> toVisit(grids.begin(), grids.end());
+				std::set<GridId> visited = {mesh.id, EmptySpaceFlag};
+				while (!toVisit.empty()) {
+					const GridId gridId = toVisit.back();
+					toVisit.pop_back();
+					if (!visited.insert(gridId).second) { continue; }
+					for (const GridId other : boundaryOf(bodyIndex(gridId), vh).neighborIds) {
+						if (grids.insert(other).second) { toVisit.push_back(other); }
+					}
+				}
+				
+				const auto& ids = boundaryVertex.neighborIds;
+				auto sumOfNormals = [&](const GridId neighborId) -> RealD {
+					const auto found = std::lower_bound(ids.begin(), ids.end(), neighborId);
+					if (found == ids.end() || *found != neighborId) { return RealD::Zeros(); }
+					return boundaryVertex.normals[(size_t) (found - ids.begin())];
+				};
+				
+				const bool border = grids.count(EmptySpaceFlag) || grids.size() > 2;
+				if (!border) {
+					/// contact is added by the grid with lesser id
+					const GridId other = *grids.rbegin();
+					if (other == mesh.id) { continue; }
+					const RealD normal = sumOfNormals(other);
+					if (normal == RealD::Zeros()) { continue; }
+					contactWith[i] = other;
+					normals[i] = linal::normalize(normal);
+					continue;
+				}
+				
+				/// for a concrete node, not more than one border condition can be applied
+				const bool isMulticontact = sumOfNormals(EmptySpaceFlag) == RealD::Zeros();
+				const Real3 coords = mesh.coords(boundaryVertex.vertex);
+				for (size_t k = 0; k < body.borders.size(); k++) {
+					const Border& condition = body.borders[k];
+					if (condition.correctionArea->contains(coords) &&
+							(!isMulticontact || condition.useForMulticontactNodes)) {
+						chosenBorder[i] = (int) k;
+					}
+				}
+				if (chosenBorder[i] == -1) { continue; }
+				
+				const RealD normal = std::accumulate(boundaryVertex.normals.begin(),
+						boundaryVertex.normals.end(), RealD::Zeros());
+				assert_true(normal != RealD::Zeros());
+				normals[i] = linal::normalize(normal);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		for (const std::exception_ptr& error : errors) {
+			if (error) { std::rethrow_exception(error); }
+		}
+		
+		for (size_t i = 0; i < size; i++) {
+			const Iterator iter = boundary[i].vertex;
+			if (contactWith[i] != EmptySpaceFlag) {
+				const Iterator otherIter = getBody(contactWith[i]).mesh->localVertexIndex(
+						mesh.vertexHandle(boundary[i].vertex));
+				contacts.at({mesh.id, contactWith[i]}).nodesInContact.push_back(
+						{ iter, otherIter, normals[i] });
+			}
+			if (chosenBorder[i] != -1) {
+				bodies[b].borders[(size_t) chosenBorder[i]].borderNodes.push_back(
+						{ iter, normals[i] });
+			}
 		}
 	}
-	if (chosenBorder == nullptr) { return; }
-	
-	RealD normal = mesh->commonNormal(iter);
-	assert_true(normal != RealD::Zeros());
-	chosenBorder->borderNodes.push_back({ iter, normal });
 }
 
 
@@ -324,4 +561,6 @@ writeSnapshots(const int step) {
 
 template class Engine<2, CgalTriangulation>;
 template class Engine<3, CgalTriangulation>;
+template class Engine<2, FlatTriangulation>;
+template class Engine<3, FlatTriangulation>;
 
@@ -7,6 +7,9 @@
 #include <libgcm/engine/simplex/ContactCorrector.hpp>
 #include <libgcm/engine/simplex/BorderCorrector.hpp>
 
+#include <chrono>
+#include <exception>
+
 
 namespace gcm {
 namespace simplex {
@@ -76,6 +79,12 @@ protected:
 	virtual void writeSnapshots(const int step) override;
 	
 	virtual real estimateTimeStep() override {
+		/// with local time stepping, time step of the coarsest level
+		return finestTimeStep() * numberOfSubsteps;
+	}
+	
+	/** Time step of the finest level of local time stepping */
+	real finestTimeStep() const {
 		/// minimal among all bodies
 		real minimalTimeStep = std::numeric_limits<real>::max();
 		for (const Body& body : bodies) {
@@ -123,40 +132,24 @@ private:
 	/// method of border/contacts calculation
 	const BorderCalcMode borderCalcMode;
 	
+	/// Local time stepping @{
+	/// maximal allowed time level, zero for off
+	const int maxTimeLevel;
+	/// number of substeps of the finest level in the coarsest time step
+	int numberOfSubsteps = 1;
+	/// @}
+	
+	/// Order of interpolation in cells
+	const int interpolationOrder;
+	
 	/// Type of gcm-method to use for calculations
 	const GcmType gcmType;
 	
-	/// Type of splitting by directions approach @{
+	/// Type of splitting by directions approach.
+	/// All stages are calculated to the single next PDE time layer,
+	/// SUMM splitting sums stage results up in the mesh accumulator
 	const SplittingType splittingType;
 	
-	/// Map between stage number and index of next PDE time layer for that stage calculation
-	const std::array<int, Dimensionality> stageVsLayerMap;
-	
-	static std::array<int, Dimensionality> createStageVsLayerMap(
-			const SplittingType splittingType) {
-		std::array<int, Dimensionality> ans;
-		switch(splittingType) {
-			case SplittingType::PRODUCT: /// all stages to 0'th
-				for (size_t i = 0; i < Dimensionality; i++) {
-					ans[i] = 0;
-				}
-				break;
-			case SplittingType::SUMM: /// all stages to each own
-				for (size_t i = 0; i < Dimensionality; i++) {
-					ans[i] = int(i);
-				}
-				break;
-			default:
-				THROW_BAD_CONFIG("Unknown splitting type");
-		}
-		return ans;
-	}
-	
-	size_t numberOfNextPdeTimeLayers() const {
-		return (size_t) stageVsLayerMap[Dimensionality - 1] + 1;
-	}
-	/// @}
-	
 	
 	struct CalculationBasis {
 	/// Current basis of calculations --
@@ -200,8 +193,19 @@ private:
 		if (!calculationBasis.createNewRandomAtEachTimeStep) { return; }
 		calculationBasis.basis = linal::randomBasis(calculationBasis.basis);
 //		LOG_INFO("New calculation basis:" << calculationBasis.basis);
-		for (const Body& body : bodies) {
-			body.mesh->setInnerCalculationBasis(calculationBasis.basis);
+		/// matrices of orthotropic materials need eigenproblem solution,
+		/// bodies are independent
+		std::vector<std::exception_ptr> errors(bodies.size());
+		#pragma omp parallel for
+		for (size_t i = 0; i < bodies.size(); i++) {
+			try {
+				bodies[i].mesh->setInnerCalculationBasis(calculationBasis.basis);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		for (const std::exception_ptr& error : errors) {
+			if (error) { std::rethrow_exception(error); }
 		}
 	}
 	
@@ -209,21 +213,39 @@ private:
 	void correctContactsAndBorders(const int stage, const real timeAtNextLayer);
 	void applyPlainBorderContactCorrection(const real timeForBorderCondition);
 	
+	void assignTimeLevels();
+	
 	void createMeshes(const Task& task);
 	void createContacts(const Task& task);
 	
-	void addBorderOrContact(const VertexHandle vh);
-	void addContactNode(const VertexHandle vh, const GridsPair gridsIds);
-	void addBorderNode(const VertexHandle vh, const GridId gridId);
+	void findBordersAndContacts();
+	
+	/** Index of the body in bodies */
+	size_t bodyIndex(const GridId gridId) const {
+		for (size_t i = 0; i < bodies.size(); i++) {
+			if (bodies[i].mesh->id == gridId) { return i; }
+		}
+		THROW_INVALID_ARG("There isn't a body with given id");
+	}
+	
+	/** Startup profiling: call the phase and log its time */
+	template<typename Phase>
+	void measure(const std::string& phaseName, const Phase phase) {
+		const auto t1 = std::chrono::high_resolution_clock::now();
+		phase();
+		const auto t2 = std::chrono::high_resolution_clock::now();
+		SUPPRESS_WUNUSED(t1); SUPPRESS_WUNUSED(t2); SUPPRESS_WUNUSED(phaseName);
+		LOG_INFO("Time of " << phaseName << ", microseconds = " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+	}
 	
 	
 	/** Creation of the factory of meshes and snapshotters */
 	std::shared_ptr<AbstractFactoryBase<Grid>>
 	createAbstractFactory(const Task::Body& body) {
-		if (body.materialId != Materials::T::ISOTROPIC) {
-			THROW_UNSUPPORTED("Unsupported material type");
-		}
+		switch (body.materialId) {
 		
+		case Materials::T::ISOTROPIC:
 		switch (body.modelId) {
 			case (Models::T::ACOUSTIC):
 				return std::make_shared<AbstractFactory<
@@ -237,6 +259,20 @@ private:
 				THROW_UNSUPPORTED("Unknown model type");
 		}
 		
+		case Materials::T::ORTHOTROPIC:
+		switch (body.modelId) {
+			case (Models::T::ELASTIC):
+				return std::make_shared<AbstractFactory<
+						ElasticModel<Dimensionality>,
+						Grid, OrthotropicMaterial>>();
+			default:
+				THROW_UNSUPPORTED("Unknown or inappropriate model type");
+		}
+		
+		default:
+		THROW_UNSUPPORTED("Unsupported material type");
+		
+		}
 	}
 	
 };
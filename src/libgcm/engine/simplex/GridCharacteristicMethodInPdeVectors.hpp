@@ -33,6 +33,21 @@ public:
 	typedef typename Mesh::Model                               Model;
 	static const int OUTER_NUMBER = Model::OUTER_NUMBER;
 	static const int DIMENSIONALITY = Mesh::DIMENSIONALITY;
+	static const int CELL_POINTS_NUMBER = Mesh::CELL_POINTS_NUMBER;
+	
+	typedef SimplexBatchInterpolator<DIMENSIONALITY, PdeVector> BatchInterpolator;
+	typedef typename BatchInterpolator::Query                  InterpolationQuery;
+	
+	/**
+	 * @param interpolationOrder_ order of interpolation in cells:
+	 * 2 - quadratic by gradients, 3 - cubic by gradients and Hessians
+	 */
+	GridCharacteristicMethodInPdeVectors(const int interpolationOrder_ = 2) :
+			interpolationOrder(interpolationOrder_) {
+		if (interpolationOrder != 2 && interpolationOrder != 3) {
+			THROW_UNSUPPORTED("Only second or third order of interpolation is supported");
+		}
+	}
 	
 	virtual void beforeStage(
 			const int /*nextPdeLayerIndex*/,
@@ -41,6 +56,9 @@ public:
 		/// in order to use them multiple times while stage calculation 
 		const Mesh& mesh = dynamic_cast<const Mesh&>(mesh_);
 		DIFFERENTIATION::estimateGradient(mesh, gradients);
+		if (interpolationOrder == 3) {
+			DIFFERENTIATION::estimateHessian(mesh, gradients, hessians);
+		}
 	}
 	
 	
@@ -53,8 +71,8 @@ public:
 		for (auto iter = mesh.contactBegin(); iter < mesh.contactEnd(); ++iter) {
 			const GcmMatrices& gcmMatrices = *mesh.matrices(*iter);
 			const RealD direction = gcmMatrices.basis.getColumn(s);
-			mesh._pdeNew(nextPdeLayerIndex, *iter) = localGcmStep(
-				gcmMatrices(s).U1, gcmMatrices(s).U,
+			mesh._pdeNew(nextPdeLayerIndex, *iter) = Model::localGcmStep(
+				gcmMatrices(s),
 				interpolateValuesAround(nextPdeLayerIndex, s, mesh, direction, *iter,
 					Base::crossingPoints(*iter, s, timeStep, mesh), false));
 			mesh._waveIndices(*iter) = outerInvariants;
@@ -64,8 +82,8 @@ public:
 		for (auto iter = mesh.borderBegin(); iter < mesh.borderEnd(); ++iter) {
 			const GcmMatrices& gcmMatrices = *mesh.matrices(*iter);
 			const RealD direction = gcmMatrices.basis.getColumn(s);
-			mesh._pdeNew(nextPdeLayerIndex, *iter) = localGcmStep(
-				gcmMatrices(s).U1, gcmMatrices(s).U,
+			mesh._pdeNew(nextPdeLayerIndex, *iter) = Model::localGcmStep(
+				gcmMatrices(s),
 				interpolateValuesAround(nextPdeLayerIndex, s, mesh, direction, *iter,
 					Base::crossingPoints(*iter, s, timeStep, mesh), false));
 			mesh._waveIndices(*iter) = outerInvariants;
@@ -79,15 +97,21 @@ public:
 		Mesh& mesh = dynamic_cast<Mesh&>(mesh_);
 		const RealD direction = mesh.getInnerCalculationBasis().getColumn(s);
 		
-		/// calculate inner nodes
-		for (auto innerIter = mesh.innerBegin(); 
-		          innerIter < mesh.innerEnd(); ++innerIter) {
-			mesh._pdeNew(nextPdeLayerIndex, *innerIter) = localGcmStep(
-				mesh.matrices(*innerIter)->m[s].U1,
-				mesh.matrices(*innerIter)->m[s].U,
-				interpolateValuesAround(nextPdeLayerIndex, s, mesh, direction, *innerIter,
-					Base::crossingPoints(*innerIter, s, timeStep, mesh), true));
-			assert_eq(outerInvariants.size(), 0);
+		/// calculate inner nodes level by level of local time stepping
+		for (int level = 0; level < mesh.numberOfTimeLevels(); level++) {
+			if (!mesh.isTimeLevelActive(level)) {
+				Base::skipTimeLevel(nextPdeLayerIndex, level, mesh);
+				continue;
+			}
+			const real levelTimeStep = timeStep * mesh.timeLevelMultiplier(level);
+			for (auto innerIter = mesh.timeLevelBegin(level); 
+			          innerIter < mesh.timeLevelEnd(level); ++innerIter) {
+				mesh._pdeNew(nextPdeLayerIndex, *innerIter) = Model::localGcmStep(
+					mesh.matrices(*innerIter)->m[s],
+					interpolateValuesAround(nextPdeLayerIndex, s, mesh, direction, *innerIter,
+						Base::crossingPoints(*innerIter, s, levelTimeStep, mesh), true));
+				assert_eq(outerInvariants.size(), 0);
+			}
 		}
 	}
 	
@@ -121,6 +145,12 @@ private:
 	                               const bool canInterpolateInSpaceTime) {
 		outerInvariants.clear();
 		Matrix ans = Matrix::Zeros();
+		const auto cells = mesh.findCellsCrossedByTheRay(it, direction, dx);
+		
+		/// points inside the body are interpolated all together after the loop
+		InterpolationQuery queries[PdeVector::M];
+		int queryColumns[PdeVector::M];
+		int numberOfQueries = 0;
 		
 		for (int k = 0; k < PdeVector::M; k++)  {
 			
@@ -132,24 +162,25 @@ private:
 			
 			// point to interpolate respectively to point by given iterator
 			RealD shift = direction * dx(k);
-			Cell t = mesh.findCellCrossedByTheRay(it, shift);
+			const Cell& t = cells[(size_t)k];
 			PdeVector u = PdeVector::Zeros();
 			
 			if (t.n == t.N) {
 			// characteristic hits into body
 			// second order interpolate inner value in triangle on current time layer
-				u = interpolateInSpace(mesh, mesh.coordsD(it) + shift, t);
+				queries[numberOfQueries] = interpolationQuery(mesh, mesh.coordsD(it) + shift, t);
+				queryColumns[numberOfQueries++] = k;
 				
 			} else if (t.n == 0) {
 			// outer characteristic from border/contact node
-				outerInvariants.push_back(k);
+				outerInvariants.insert(k);
 				
 			} else if (t.n == t.N - 1) {
 			// characteristic hits out of body going throughout border face
 				if (canInterpolateInSpaceTime) {
 					u = interpolateInSpaceTime(nextPdeLayerIndex, s, mesh, it, shift, t);
 				} else {
-					outerInvariants.push_back(k);
+					outerInvariants.insert(k);
 				}
 				
 			} else if (t.n == t.N - 2) {
@@ -157,7 +188,7 @@ private:
 				if (canInterpolateInSpaceTime) {
 					u = interpolateInSpaceTime1D(nextPdeLayerIndex, s, mesh, it, shift, t);
 				} else {
-					outerInvariants.push_back(k);
+					outerInvariants.insert(k);
 				}
 				
 			}
@@ -165,30 +196,33 @@ private:
 			ans.setColumn(k, u);
 		}
 		
+		PdeVector interpolated[PdeVector::M];
+		if (interpolationOrder == 3) {
+			BatchInterpolator::hybridCubicInterpolate(numberOfQueries, queries, interpolated);
+		} else {
+			BatchInterpolator::hybridInterpolate(numberOfQueries, queries, interpolated);
+		}
+		for (int q = 0; q < numberOfQueries; q++) {
+			ans.setColumn(queryColumns[q], interpolated[q]);
+		}
+		
 		return ans;
 	}
 	
 	
-	/** Interpolate PdeVector from space on current time layer (2D case) */
-	inline
-	PdeVector interpolateInSpace(const Mesh& mesh, const Real2& query, const Cell& c) const {
-		return TriangleInterpolator<PdeVector>::hybridInterpolate(
-				mesh.coordsD(c(0)), mesh.pde(c(0)), gradients[mesh.getIndex(c(0))],
-				mesh.coordsD(c(1)), mesh.pde(c(1)), gradients[mesh.getIndex(c(1))],
-				mesh.coordsD(c(2)), mesh.pde(c(2)), gradients[mesh.getIndex(c(2))],
-				query);
-	}
-	
-	
-	/** Interpolate PdeVector from space on current time layer (3D case) */
-	inline
-	PdeVector interpolateInSpace(const Mesh& mesh, const Real3& query, const Cell& c) const {
-		return TetrahedronInterpolator<PdeVector>::hybridInterpolate(
-				mesh.coordsD(c(0)), mesh.pde(c(0)), gradients[mesh.getIndex(c(0))],
-				mesh.coordsD(c(1)), mesh.pde(c(1)), gradients[mesh.getIndex(c(1))],
-				mesh.coordsD(c(2)), mesh.pde(c(2)), gradients[mesh.getIndex(c(2))],
-				mesh.coordsD(c(3)), mesh.pde(c(3)), gradients[mesh.getIndex(c(3))],
-				query);
+	/** Query to interpolate PdeVector from space on current time layer */
+	InterpolationQuery interpolationQuery(
+			const Mesh& mesh, const RealD& query, const Cell& c) const {
+		InterpolationQuery ans;
+		ans.lambda = mesh.barycentricCoordinates(c, query);
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			ans.shift[i] = query - mesh.coordsD(c(i));
+			ans.value[i] = &mesh.pde(c(i));
+			ans.gradient[i] = &gradients[mesh.getIndex(c(i))];
+			ans.hessian[i] = (interpolationOrder == 3) ?
+					&hessians[mesh.getIndex(c(i))] : nullptr;
+		}
+		return ans;
 	}
 	
 	
@@ -264,9 +298,12 @@ private:
 	
 	/// The storage of gradients of mesh pde values.
 	std::vector<PdeGradient> gradients;
-	/// The storage of hessians of mesh pde values. (Unused now)
+	/// The storage of hessians of mesh pde values (for third order only)
 	std::vector<PdeHessian> hessians;
 	
+	/// Order of interpolation in cells
+	const int interpolationOrder;
+	
 	USE_AND_INIT_LOGGER("gcm.simplex.GridCharacteristicMethodInPdeVectors")
 };
 
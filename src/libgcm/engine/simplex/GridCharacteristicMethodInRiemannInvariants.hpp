@@ -102,13 +102,21 @@ public:
 		Mesh& mesh = dynamic_cast<Mesh&>(mesh_);
 		const RealD direction = mesh.getInnerCalculationBasis().getColumn(s);
 		
-		/// calculate inner nodes
-		for (auto iter = mesh.innerBegin(); iter < mesh.innerEnd(); ++iter) {
-			mesh._pdeNew(nextPdeLayerIndex, *iter) = interpolateValuesAround(
-					nextPdeLayerIndex,
-					s, mesh, direction, *iter,
-					Base::crossingPoints(*iter, s, timeStep, mesh), true);
-			assert_eq(outerInvariants.size(), 0);
+		/// calculate inner nodes level by level of local time stepping
+		for (int level = 0; level < mesh.numberOfTimeLevels(); level++) {
+			if (!mesh.isTimeLevelActive(level)) {
+				Base::skipTimeLevel(nextPdeLayerIndex, level, mesh);
+				continue;
+			}
+			const real levelTimeStep = timeStep * mesh.timeLevelMultiplier(level);
+			for (auto iter = mesh.timeLevelBegin(level);
+			          iter < mesh.timeLevelEnd(level); ++iter) {
+				mesh._pdeNew(nextPdeLayerIndex, *iter) = interpolateValuesAround(
+						nextPdeLayerIndex,
+						s, mesh, direction, *iter,
+						Base::crossingPoints(*iter, s, levelTimeStep, mesh), true);
+				assert_eq(outerInvariants.size(), 0);
+			}
 		}
 	}
 	
@@ -150,6 +158,7 @@ private:
 			const bool canInterpolateInSpaceTime) {
 		outerInvariants.clear();
 		PdeVector ans = PdeVector::Zeros();
+		const auto cells = mesh.findCellsCrossedByTheRay(it, direction, dx);
 		
 		for (int k = 0; k < PdeVector::M; k++) {
 			
@@ -161,7 +170,7 @@ private:
 			
 			// point to interpolate respectively to point by given iterator
 			RealD shift = direction * dx(k);
-			Cell t = mesh.findCellCrossedByTheRay(it, shift);
+			const Cell& t = cells[(size_t)k];
 			RiemannInvariant u = 0;
 			
 			if (t.n == t.N) {
@@ -171,14 +180,14 @@ private:
 				
 			} else if (t.n == 0) {
 			// outer characteristic from border/contact node
-				outerInvariants.push_back(k);
+				outerInvariants.insert(k);
 				
 			} else if (t.n == t.N - 1) {
 			// characteristic hits out of body going throughout border face
 				if (canInterpolateInSpaceTime) {
 					u = interpolateInSpaceTime(s, mesh, it, shift, t, nextPdeLayerIndex, k);
 				} else {
-					outerInvariants.push_back(k);
+					outerInvariants.insert(k);
 				}
 				
 			} else if (t.n == t.N - 2) {
@@ -186,7 +195,7 @@ private:
 				if (canInterpolateInSpaceTime) {
 					u = interpolateInSpaceTime1D(s, mesh, it, shift, t, nextPdeLayerIndex, k);
 				} else {
-					outerInvariants.push_back(k);
+					outerInvariants.insert(k);
 				}
 				
 			}
@@ -208,6 +217,7 @@ private:
 			        gradients[mesh.getIndex(c(i))](1)(k)};
 		}
 		return TriangleInterpolator<RiemannInvariant>::hybridInterpolate(
+				mesh.barycentricCoordinates(c, query),
 				mesh.coordsD(c(0)), mesh.pde(c(0))(k), g[0],
 				mesh.coordsD(c(1)), mesh.pde(c(1))(k), g[1],
 				mesh.coordsD(c(2)), mesh.pde(c(2))(k), g[2],
@@ -226,6 +236,7 @@ private:
 			        gradients[mesh.getIndex(c(i))](2)(k)};
 		}
 		return TetrahedronInterpolator<RiemannInvariant>::hybridInterpolate(
+				mesh.barycentricCoordinates(c, query),
 				mesh.coordsD(c(0)), mesh.pde(c(0))(k), g[0],
 				mesh.coordsD(c(1)), mesh.pde(c(1))(k), g[1],
 				mesh.coordsD(c(2)), mesh.pde(c(2))(k), g[2],
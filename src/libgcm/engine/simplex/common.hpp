@@ -52,6 +52,21 @@ protected:
 	}
 	
 	
+	/**
+	 * Nodes of the time level which is not calculated at the current substep
+	 * just keep their values (whatever is stored in the current layer)
+	 */
+	template<typename Mesh>
+	static inline
+	void skipTimeLevel(const int nextPdeLayerIndex,
+			const int level, Mesh& mesh) {
+		for (auto iter = mesh.timeLevelBegin(level);
+		          iter < mesh.timeLevelEnd(level); ++iter) {
+			mesh._pdeNew(nextPdeLayerIndex, *iter) = mesh.pde(*iter);
+		}
+	}
+	
+	
 	/**
 	 * Handle the case when characteristic goes inside the body and then cross 
 	 * the border in some point (2D case):
@@ -155,7 +170,7 @@ inline
 typename Model::OuterMatrix getColumnsFromGcmMatrices(
 		const int stage,
 		const typename Model::WaveIndices columnsIndices,
-		std::shared_ptr<const typename Model::GCM_MATRICES> m) {
+		std::shared_ptr<const typename Model::LEAN_GCM_MATRICES> m) {
 	typename Model::OuterMatrix ans = Model::OuterMatrix::Zeros();
 	int counter = 0;
 	for (const int i : columnsIndices) {
@@ -3,6 +3,7 @@
 
 #include <libgcm/linal/linal.hpp>
 #include <libgcm/util/math/AABB.hpp>
+#include <libgcm/util/math/Area.hpp>
 #include <libgcm/engine/GlobalVariables.hpp>
 #include <libgcm/grid/AbstractGrid.hpp>
 
@@ -97,6 +98,27 @@ public:
 		return AABB::translate(global, -start);
 	}
 	
+	/**
+	 * All real nodes of the grid inside the area.
+	 * Only nodes inside the area bounding box are checked.
+	 */
+	std::vector<Iterator> findVerticesInside(const Area& area) const {
+		const AxesAlignedBoundaryBox<Real3> boundingBox = area.boundingBox();
+		IntD min, max;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			const real left = (boundingBox.min(i) - startR()(i)) / h(i);
+			const real right = (boundingBox.max(i) - startR()(i)) / h(i);
+			min(i) = (int) std::max(std::floor(left), 0.0);
+			max(i) = (int) std::min(std::ceil(right) + 1, (real) sizes(i));
+			if (min(i) >= max(i)) { return {}; }
+		}
+		std::vector<Iterator> ans;
+		for (PartIterator it = box(min, max); it != it.end(); ++it) {
+			if (area.contains(coords(it))) { ans.push_back(it); }
+		}
+		return ans;
+	}
+	
 	
 	/** Struct for grid constructor */
 	struct ConstructionPack {
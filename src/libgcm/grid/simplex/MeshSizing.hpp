@@ -0,0 +1,192 @@
+#ifndef LIBGCM_MESHSIZING_HPP
+#define LIBGCM_MESHSIZING_HPP
+
+#include <cmath>
+#include <limits>
+
+#include <libgcm/util/task/Task.hpp>
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+
+
+namespace gcm {
+
+/**
+ * Sizing field for meshers derived from materials of bodies.
+ * The local spatial step is the wavelength of the slowest wave
+ * of the local material at the source frequency divided by the number
+ * of nodes per wavelength. So slow materials are meshed finely and
+ * fast ones coarsely at equal accuracy.
+ * All the data is constant after construction, so const methods
+ * can be called concurrently, e.g. by parallel CGAL meshing.
+ * @see Task::SimplexGrid::nodesPerWavelength
+ */
+class MeshSizing {
+public:
+	MeshSizing(const Task& task) :
+			materialConditions(task.materialConditions),
+			spatialStep(task.simplexGrid.spatialStep),
+			nodesPerWavelength(task.simplexGrid.nodesPerWavelength),
+			sourceFrequency(task.simplexGrid.sourceFrequency),
+			models(modelsOfBodies(task)) { }
+	
+	/** Whether the sizing depends on materials, not uniform spatialStep */
+	bool isWaveSpeedAware() const {
+		return nodesPerWavelength > 0 && sourceFrequency > 0;
+	}
+	
+	/**
+	 * Whether the sizing depends on areas of materials. Areas are
+	 * arbitrary shapes, so such sizing can't be identified by a hash.
+	 */
+	bool dependsOnAreas() const {
+		return isWaveSpeedAware() &&
+				materialConditions.type == Task::MaterialCondition::Type::BY_AREAS &&
+				!materialConditions.byAreas.materials.empty();
+	}
+	
+	/**
+	 * Spatial step at the point inside the body with given id
+	 * @threadsafe
+	 */
+	real operator()(const Real3& point, const size_t bodyId) const {
+		if (!isWaveSpeedAware()) { return spatialStep; }
+		return step(materialAt(point, bodyId), model(bodyId));
+	}
+	
+	/** The finest spatial step over all materials of the task */
+	real minimalStep() const {
+		if (!isWaveSpeedAware()) { return spatialStep; }
+		real ans = std::numeric_limits<real>::max();
+		for (const auto& material : allMaterials()) {
+			ans = fmin(ans, step(*material.second, model(material.first)));
+		}
+		return ans;
+	}
+	
+	/** Spatial steps of all materials of the task in the fixed order */
+	std::vector<real> materialSteps() const {
+		std::vector<real> ans;
+		for (const auto& material : allMaterials()) {
+			ans.push_back(step(*material.second, model(material.first)));
+		}
+		return ans;
+	}
+	
+	/** Velocity of the slowest wave in the material by the rheology model */
+	static real minimalWaveVelocity(
+			const AbstractMaterial& material, const Models::T model) {
+		
+		if (const auto isotropic = dynamic_cast<const IsotropicMaterial*>(&material)) {
+			assert_gt(isotropic->rho, 0);
+			if (model == Models::T::ACOUSTIC || model == Models::T::MAXWELL_ACOUSTIC) {
+				return std::sqrt(isotropic->lambda / isotropic->rho);
+			}
+			const real modulus = (isotropic->mu > 0) ?
+					isotropic->mu : isotropic->lambda + 2 * isotropic->mu;
+			return std::sqrt(modulus / isotropic->rho);
+		}
+		
+		if (const auto orthotropic = dynamic_cast<const OrthotropicMaterial*>(&material)) {
+			assert_gt(orthotropic->rho, 0);
+			/// shear moduli along the main axes, zero ones are not used in 2D
+			real modulus = std::numeric_limits<real>::max();
+			for (const real c : {orthotropic->c44, orthotropic->c55, orthotropic->c66}) {
+				if (c > 0) { modulus = fmin(modulus, c); }
+			}
+			assert_lt(modulus, std::numeric_limits<real>::max());
+			return std::sqrt(modulus / orthotropic->rho);
+		}
+		
+		THROW_UNSUPPORTED("Unknown type of material");
+	}
+	
+	
+private:
+	typedef Task::MaterialCondition::Material Material;
+	
+	const Task::MaterialCondition materialConditions;
+	const real spatialStep;
+	const real nodesPerWavelength;
+	const real sourceFrequency;
+	const std::map<size_t, Models::T> models;
+	
+	
+	static std::map<size_t, Models::T> modelsOfBodies(const Task& task) {
+		std::map<size_t, Models::T> ans;
+		for (const auto& body : task.bodies) {
+			ans[body.first] = body.second.modelId;
+		}
+		return ans;
+	}
+	
+	real step(const AbstractMaterial& material, const Models::T model) const {
+		const real wavelength = minimalWaveVelocity(material, model) / sourceFrequency;
+		const real ans = wavelength / nodesPerWavelength;
+		return (spatialStep > 0) ? fmin(ans, spatialStep) : ans;
+	}
+	
+	Models::T model(const size_t bodyId) const {
+		const auto it = models.find(bodyId);
+		return (it != models.end()) ? it->second : Models::T::ELASTIC;
+	}
+	
+	/** The same order of overwriting as in MaterialsCondition */
+	const AbstractMaterial& materialAt(const Real3& point, const size_t bodyId) const {
+		switch (materialConditions.type) {
+			case Task::MaterialCondition::Type::BY_AREAS:
+			{
+				const auto& byAreas = materialConditions.byAreas;
+				for (auto m = byAreas.materials.rbegin(); m != byAreas.materials.rend(); ++m) {
+					if (m->area->contains(point)) { return *m->material; }
+				}
+				return *byAreas.defaultMaterial;
+			}
+			case Task::MaterialCondition::Type::BY_BODIES:
+			{
+				return *materialConditions.byBodies.bodyMaterialMap.at(bodyId);
+			}
+			default:
+			{
+				THROW_UNSUPPORTED("Unknown type of material condition");
+			}
+		}
+	}
+	
+	/** All materials of the task with ids of bodies they are in */
+	std::vector<std::pair<size_t, Material>> allMaterials() const {
+		std::vector<std::pair<size_t, Material>> ans;
+		switch (materialConditions.type) {
+			case Task::MaterialCondition::Type::BY_AREAS:
+			{
+				/// any material can be in any body
+				std::vector<size_t> bodyIds;
+				for (const auto& m : models) { bodyIds.push_back(m.first); }
+				if (bodyIds.empty()) { bodyIds.push_back(0); }
+				for (const size_t bodyId : bodyIds) {
+					ans.push_back({bodyId, materialConditions.byAreas.defaultMaterial});
+					for (const auto& m : materialConditions.byAreas.materials) {
+						ans.push_back({bodyId, m.material});
+					}
+				}
+				break;
+			}
+			case Task::MaterialCondition::Type::BY_BODIES:
+			{
+				for (const auto& m : materialConditions.byBodies.bodyMaterialMap) {
+					ans.push_back(m);
+				}
+				break;
+			}
+			default:
+			{
+				THROW_UNSUPPORTED("Unknown type of material condition");
+			}
+		}
+		return ans;
+	}
+};
+
+
+}
+
+#endif // LIBGCM_MESHSIZING_HPP
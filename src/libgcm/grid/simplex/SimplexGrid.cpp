@@ -1,10 +1,14 @@
 #include <libgcm/grid/simplex/SimplexGrid.hpp>
 
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
 #include <libgcm/grid/simplex/cgal/LineWalker.hpp>
 #include <libgcm/util/snapshot/VtkUtils.hpp>
 #include <libgcm/util/math/Histogram.hpp>
 
+#include <algorithm>
+#include <limits>
+
 
 using namespace gcm;
 
@@ -18,32 +22,37 @@ SimplexGrid(const GridId id_, const ConstructionPack& constructionPack) :
 	assert_ne(id, EmptySpaceFlag);
 	LOG_INFO("Start construction of the grid " << id << " ...");
 	
-	/// find local cells and vertices in global triangulation
-	std::set<VertexHandle> localVertices;
-	for (auto cellIter  = triangulation->allCellsBegin();
-	          cellIter != triangulation->allCellsEnd(); ++cellIter) {
-		if (cellIter->info().getGridId() == id) {
-			cellHandles.push_back(cellIter);
-			for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
-				localVertices.insert(cellIter->vertex(i));
-			}
-		}
+	/// find local cells in global triangulation, if not found in advance
+	if (constructionPack.cells != nullptr) {
+		cellHandles = *constructionPack.cells;
+	} else {
+		cellHandles = std::move(cellsOfAllGrids(triangulation)[id]);
 	}
-	vertexHandles.assign(localVertices.begin(), localVertices.end());
 	
-	/// write local vertices indices to vertices info
-	/// note (!) later, it will be invalidated by other grids constructors,
-	/// so it is just a temporary auxiliary info 
-	/// (and thus no parallelize grids construction in that way!)
-	for (size_t i = 0; i < vertexHandles.size(); i++) {
-		vertexHandles[i]->info() = i;
+	/// local vertices are sorted by handles to use binary search below
+	vertexHandles.reserve(cellHandles.size());
+	for (const CellHandle cell : cellHandles) {
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			vertexHandles.push_back(cell->vertex(i));
+		}
+	}
+	std::sort(vertexHandles.begin(), vertexHandles.end());
+	vertexHandles.erase(std::unique(vertexHandles.begin(), vertexHandles.end()),
+			vertexHandles.end());
+	vertexCoordinates.reserve(vertexHandles.size());
+	for (const VertexHandle vh : vertexHandles) {
+		vertexCoordinates.push_back(triangulation->coordsD(vh));
 	}
 	
-	/// write local vertices indices to cells info
-	/// this is not temporary, because cell belongs to the only one grid
-	for (CellIterator cell = cellBegin(); cell != cellEnd(); ++cell) {
+	/// write local vertices and cell indices to cells info;
+	/// vertices info is not touched, so grids can be constructed in parallel
+	for (size_t c = 0; c < cellHandles.size(); c++) {
+		const CellHandle cell = cellHandles[c];
+		cell->info().localCellIndex = c;
 		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
-			(*cell)->info().localVertexIndices[i] = (*cell)->vertex(i)->info();
+			cell->info().localVertexIndices[i] = (LocalVertexIndex) (std::lower_bound(
+					vertexHandles.begin(), vertexHandles.end(), cell->vertex(i)) -
+							vertexHandles.begin());
 		}
 	}
 	
@@ -51,6 +60,25 @@ SimplexGrid(const GridId id_, const ConstructionPack& constructionPack) :
 	// because this information is equal for all grids in contact
 	markInnersAndBorders();
 	collectCellHeightsStatistics();
+	buildSpatialIndices();
+	buildCellGeometries();
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::map<GridId, std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::CellHandle>>
+SimplexGrid<Dimensionality, TriangulationT>::
+cellsOfAllGrids(const Triangulation* triangulation) {
+	std::map<GridId, std::vector<CellHandle>> ans;
+	for (auto cellIter  = triangulation->allCellsBegin();
+	          cellIter != triangulation->allCellsEnd(); ++cellIter) {
+		const GridId gridId = cellIter->info().getGridId();
+		if (gridId != EmptySpaceFlag) {
+			ans[gridId].push_back(cellIter);
+		}
+	}
+	return ans;
 }
 
 
@@ -80,7 +108,8 @@ findCellCrossedByTheRay(const Iterator& it, const RealD& shift) const {
 	
 	/// Now, two situations are possible:
 	/// - the ray is going out of the grid from a border (contact) node,
-	/// - we have some numerical inexactness in geometrical operations.
+	/// - we have some inexactness in geometrical operations (not expected
+	///   with exact predicates of the walk, @see numberOfFallbackWalks).
 	/// In order to avoid inexactness try to start from the inside of
 	/// the incident cell which is crossed by the search direction
 	CellHandle startCell = triangulation->findCrossedIncidentCell(
@@ -98,7 +127,11 @@ findCellCrossedByTheRay(const Iterator& it, const RealD& shift) const {
 	cellsAlong = LINE_WALKER::cellsAlongSegment(
 			triangulation, isLocalCell, startCell, startPoint, query);
 	foundCell = checkLineWalkFoundCell(it, cellsAlong, start, query);
-	if (foundCell.n > 0) { return foundCell; }
+	if (foundCell.n > 0) {
+		#pragma omp atomic
+		++fallbackWalksCounter;
+		return foundCell;
+	}
 	
 	/// Now, the majority (unlikely all) of inexactness cases are handled.
 	/// Also, the case when the ray starts from the border node and 
@@ -112,6 +145,66 @@ findCellCrossedByTheRay(const Iterator& it, const RealD& shift) const {
 }
 
 
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+void
+SimplexGrid<Dimensionality, TriangulationT>::
+findCellsCrossedByTheRay(const Iterator& it, const RealD& direction,
+		const int number, const real distances[], Cell cells[]) const {
+	typedef LineWalker<Triangulation, DIMENSIONALITY> LINE_WALKER;
+	assert_le(number, MAX_NUMBER_OF_POINTS_ON_THE_RAY);
+	const RealD start = coordsD(it);
+	const auto isLocalCell = [=](const CellHandle c) {
+		return belongsToTheGrid(c);
+	};
+	for (int k = 0; k < number; k++) {
+		cells[k] = createCell();
+	}
+	
+	int order[MAX_NUMBER_OF_POINTS_ON_THE_RAY];
+	for (const real side : {1.0, -1.0}) {
+		/// Indices of points on this side of the vertex sorted by distance
+		int size = 0;
+		for (int k = 0; k < number; k++) {
+			if (distances[k] * side <= 0) { continue; }
+			int i = size++;
+			while (i > 0 && fabs(distances[order[i - 1]]) > fabs(distances[k])) {
+				order[i] = order[i - 1];
+				i--;
+			}
+			order[i] = k;
+		}
+		if (size == 0) { continue; }
+		
+		/// Walk to the farthest point once and search for the nearer points
+		/// among the cells along that walk. The points which are not inside
+		/// the walked local cells (the ray goes out of the grid, numerical
+		/// inexactness) are searched separately with all fallbacks
+		const RealD farthest = start + direction * distances[order[size - 1]];
+		const std::vector<CellHandle> cellsAlong = LINE_WALKER::cellsAlongSegment(
+				triangulation, isLocalCell, vertexHandle(it), farthest);
+		size_t current = 0;
+		for (int i = 0; i < size; i++) {
+			const int k = order[i];
+			const RealD shift = direction * distances[k];
+			const RealD query = start + shift;
+			while (current < cellsAlong.size() &&
+					belongsToTheGrid(cellsAlong[current]) &&
+					!Triangulation::contains(
+							cellsAlong[current], query, EQUALITY_TOLERANCE)) {
+				++current;
+			}
+			if (current < cellsAlong.size() &&
+					belongsToTheGrid(cellsAlong[current])) {
+				cells[k] = createCell(cellsAlong[current]);
+			} else {
+				cells[k] = findCellCrossedByTheRay(it, shift);
+			}
+		}
+	}
+}
+
+
 template<int Dimensionality,
          template<int, typename, typename> class TriangulationT>
 typename SimplexGrid<Dimensionality, TriangulationT>::Cell
@@ -169,12 +262,90 @@ template<int Dimensionality,
 typename SimplexGrid<Dimensionality, TriangulationT>::Iterator
 SimplexGrid<Dimensionality, TriangulationT>::
 findVertexByCoordinates(const RealD& coordinates) const {
-	for (const auto& it : *this) {
-		if (coordsD(it) == coordinates) {
-			return it;
+	const int found = verticesIndex.find(coordinates, [=](const int i) {
+		return coordsD((size_t)i) == coordinates;
+	});
+	if (found == SpatialIndex<DIMENSIONALITY>::NoIndex) {
+		THROW_INVALID_ARG("There isn't a node with such coordinates");
+	}
+	return (size_t)found;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+typename SimplexGrid<Dimensionality, TriangulationT>::Iterator
+SimplexGrid<Dimensionality, TriangulationT>::
+findNearestVertex(const RealD& point) const {
+	const int found = verticesIndex.nearest(point, [=](const int i) {
+		return linal::length(coordsD((size_t)i) - point);
+	});
+	assert_ne(found, SpatialIndex<DIMENSIONALITY>::NoIndex);
+	return (size_t)found;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::Iterator>
+SimplexGrid<Dimensionality, TriangulationT>::
+findVerticesInBox(const RealD& min, const RealD& max) const {
+	std::vector<Iterator> ans;
+	verticesIndex.forEachInBox({min, max}, [&](const int i) {
+		ans.push_back((size_t)i);
+	});
+	std::sort(ans.begin(), ans.end());
+	return ans;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::Iterator>
+SimplexGrid<Dimensionality, TriangulationT>::
+findVerticesInSphere(const RealD& center, const real radius) const {
+	std::vector<Iterator> ans = findVerticesInBox(
+			center - radius * RealD::Ones(), center + radius * RealD::Ones());
+	ans.erase(std::remove_if(ans.begin(), ans.end(), [=](const Iterator it) {
+		return linal::length(coordsD(it) - center) >= radius;
+	}), ans.end());
+	return ans;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::Iterator>
+SimplexGrid<Dimensionality, TriangulationT>::
+findVerticesInside(const Area& area) const {
+	const AxesAlignedBoundaryBox<Real3> boundingBox = area.boundingBox();
+	RealD min, max;
+	for (int i = 0; i < DIMENSIONALITY; i++) {
+		min(i) = boundingBox.min(i);
+		max(i) = boundingBox.max(i);
+	}
+	std::vector<Iterator> ans = findVerticesInBox(min, max);
+	ans.erase(std::remove_if(ans.begin(), ans.end(), [&](const Iterator it) {
+		return !area.contains(coords(it));
+	}), ans.end());
+	return ans;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+typename SimplexGrid<Dimensionality, TriangulationT>::Cell
+SimplexGrid<Dimensionality, TriangulationT>::
+locateCell(const RealD& point) const {
+	for (const real eps : {0.0, EQUALITY_TOLERANCE}) {
+		const int found = cellsIndex.find(point, [=](const int i) {
+			return Triangulation::contains(cellHandles[(size_t)i], point, eps);
+		}, eps);
+		if (found != SpatialIndex<DIMENSIONALITY>::NoIndex) {
+			return createCell(cellHandles[(size_t)found]);
 		}
 	}
-	THROW_INVALID_ARG("There isn't a node with such coordinates");
+	return createCell();
 }
 
 
@@ -211,6 +382,111 @@ allMinimalBorderHeights() const {
 }
 
 
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<real>
+SimplexGrid<Dimensionality, TriangulationT>::
+nodalMinimalHeights() const {
+	std::vector<real> ans(sizeOfRealNodes(), std::numeric_limits<real>::max());
+	for (auto cell = cellBegin(); cell != cellEnd(); ++cell) {
+		const real h = Triangulation::minimalCellHeight(*cell);
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			real& nodal = ans[getIndex(iterator(*cell, i))];
+			nodal = std::min(nodal, h);
+		}
+	}
+	return ans;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::BoundaryFacet>
+SimplexGrid<Dimensionality, TriangulationT>::
+boundaryFacets() const {
+/// facets are counted and then written in parallel
+/// to keep them in the order of cells
+	const size_t size = cellHandles.size();
+	std::vector<size_t> offsets(size + 1, 0);
+	#pragma omp parallel for
+	for (size_t i = 0; i < size; i++) {
+		for (int j = 0; j < CELL_POINTS_NUMBER; j++) {
+			if (!belongsToTheGrid(cellHandles[i]->neighbor(j))) { ++offsets[i + 1]; }
+		}
+	}
+	for (size_t i = 0; i < size; i++) {
+		offsets[i + 1] += offsets[i];
+	}
+	
+	std::vector<BoundaryFacet> ans(offsets.back());
+	#pragma omp parallel for
+	for (size_t i = 0; i < size; i++) {
+		const CellHandle cell = cellHandles[i];
+		size_t k = offsets[i];
+		for (int j = 0; j < CELL_POINTS_NUMBER; j++) {
+			const GridId neighborId = cell->neighbor(j)->info().getGridId();
+			if (neighborId != id) { ans[k++] = {cell, j, neighborId}; }
+		}
+	}
+	return ans;
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+std::vector<typename SimplexGrid<Dimensionality, TriangulationT>::BoundaryVertex>
+SimplexGrid<Dimensionality, TriangulationT>::
+boundaryVertices() const {
+	const std::vector<BoundaryFacet> facets = boundaryFacets();
+	
+	/// incident boundary facets of vertices in CSR format
+	std::vector<size_t> offsets(sizeOfRealNodes() + 1, 0);
+	for (const BoundaryFacet& facet : facets) {
+		for (int j = 0; j < CELL_POINTS_NUMBER; j++) {
+			if (j != facet.indexInCell) {
+				++offsets[(size_t) iterator(facet.cell, j) + 1];
+			}
+		}
+	}
+	std::vector<LocalVertexIndex> vertices;
+	for (size_t i = 0; i < sizeOfRealNodes(); i++) {
+		if (offsets[i + 1] > 0) { vertices.push_back((LocalVertexIndex) i); }
+		offsets[i + 1] += offsets[i];
+	}
+	std::vector<size_t> incidentFacets(offsets.back());
+	std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+	for (size_t f = 0; f < facets.size(); f++) {
+		for (int j = 0; j < CELL_POINTS_NUMBER; j++) {
+			if (j != facets[f].indexInCell) {
+				incidentFacets[filled[(size_t) iterator(facets[f].cell, j)]++] = f;
+			}
+		}
+	}
+	
+	std::vector<BoundaryVertex> ans(vertices.size());
+	#pragma omp parallel for
+	for (size_t i = 0; i < vertices.size(); i++) {
+		BoundaryVertex& boundaryVertex = ans[i];
+		boundaryVertex.vertex = vertices[i];
+		const size_t v = (size_t) vertices[i];
+		for (size_t k = offsets[v]; k < offsets[v + 1]; k++) {
+			const BoundaryFacet& facet = facets[incidentFacets[k]];
+			auto& ids = boundaryVertex.neighborIds;
+			const auto place = std::lower_bound(ids.begin(), ids.end(), facet.neighborId);
+			const size_t n = (size_t) (place - ids.begin());
+			if (place == ids.end() || *place != facet.neighborId) {
+				ids.insert(place, facet.neighborId);
+				boundaryVertex.normals.insert(
+						boundaryVertex.normals.begin() + (long) n, RealD::Zeros());
+			}
+			boundaryVertex.normals[n] += Triangulation::contactNormal(
+					facet.cell, facet.cell->neighbor(facet.indexInCell));
+		}
+	}
+	return ans;
+}
+
+
 template<int Dimensionality,
          template<int, typename, typename> class TriangulationT>
 void
@@ -218,16 +494,38 @@ SimplexGrid<Dimensionality, TriangulationT>::
 markInnersAndBorders() {
 /// insert indices of contact vertices into contactIndices
 /// insert indices of border vertices into borderIndices
-/// and indices of inner vertices into innerIndices
+/// and indices of inner vertices into innerIndices.
+/// Vertices not lying on boundary facets are inner, the others are
+/// border, contact or multicontact by grids behind their boundary facets
 	contactIndices.clear();
 	borderIndices.clear();
 	innerIndices.clear();
+	contactGridIds.clear();
 	size_t multicontactCounter = 0;
 	
+	const size_t size = sizeOfRealNodes();
+	borderStates.assign(size, BorderState::INNER);
+	/// grid behind the first found boundary facet of the vertex
+	std::vector<GridId> neighborIds(size, id);
+	for (const BoundaryFacet& facet : boundaryFacets()) {
+		for (int j = 0; j < CELL_POINTS_NUMBER; j++) {
+			if (j == facet.indexInCell) { continue; }
+			const size_t v = (size_t) iterator(facet.cell, j);
+			if (borderStates[v] == BorderState::INNER) {
+				neighborIds[v] = facet.neighborId;
+				borderStates[v] = (facet.neighborId == EmptySpaceFlag) ?
+						BorderState::BORDER : BorderState::CONTACT;
+			} else if (neighborIds[v] != facet.neighborId) {
+				borderStates[v] = BorderState::MULTICONTACT;
+			}
+		}
+	}
+	
 	for (const auto it : *this) {
-		switch (borderState(it)) {
+		switch (borderStates[(size_t)it]) {
 			case BorderState::CONTACT:
 				contactIndices.push_back(it);
+				contactGridIds.push_back(neighborIds[(size_t)it]);
 				break;
 				
 			case BorderState::BORDER:
@@ -285,6 +583,59 @@ collectCellHeightsStatistics() {
 }
 
 
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+void
+SimplexGrid<Dimensionality, TriangulationT>::
+buildSpatialIndices() {
+	typedef typename SpatialIndex<DIMENSIONALITY>::Box Box;
+	
+	std::vector<Box> boxes;
+	boxes.reserve(sizeOfRealNodes());
+	for (const auto& it : *this) {
+		boxes.push_back({coordsD(it), coordsD(it)});
+	}
+	verticesIndex.build(boxes);
+	
+	boxes.clear();
+	boxes.reserve(cellHandles.size());
+	for (auto cell = cellBegin(); cell != cellEnd(); ++cell) {
+		Box box = {coordsD(iterator(*cell, 0)), coordsD(iterator(*cell, 0))};
+		for (int i = 1; i < CELL_POINTS_NUMBER; i++) {
+			const RealD point = coordsD(iterator(*cell, i));
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				box.min(j) = std::min(box.min(j), point(j));
+				box.max(j) = std::max(box.max(j), point(j));
+			}
+		}
+		boxes.push_back(box);
+	}
+	cellsIndex.build(boxes);
+}
+
+
+template<int Dimensionality,
+         template<int, typename, typename> class TriangulationT>
+void
+SimplexGrid<Dimensionality, TriangulationT>::
+buildCellGeometries() {
+	cellGeometries.resize(cellHandles.size());
+	#pragma omp parallel for
+	for (size_t c = 0; c < cellHandles.size(); c++) {
+		/// @see linal::barycentricCoordinates
+		CellGeometry& geometry = cellGeometries[c];
+		geometry.origin = coordsD(iterator(cellHandles[c], DIMENSIONALITY));
+		MatrixDD map;
+		for (int j = 0; j < DIMENSIONALITY; j++) {
+			map.setColumn(j, coordsD(iterator(cellHandles[c], j)) - geometry.origin);
+		}
+		geometry.isDegenerate = (linal::determinant(map) == 0);
+		geometry.inverseMap = geometry.isDegenerate ?
+				MatrixDD::Zeros() : linal::invert(map);
+	}
+}
+
+
 template<int Dimensionality,
          template<int, typename, typename> class TriangulationT>
 void SimplexGrid<Dimensionality, TriangulationT>::
@@ -304,4 +655,6 @@ writeCellsToVtk(const std::vector<CellHandle>& cells, const std::string filename
 
 template class SimplexGrid<2, CgalTriangulation>;
 template class SimplexGrid<3, CgalTriangulation>;
+template class SimplexGrid<2, FlatTriangulation>;
+template class SimplexGrid<3, FlatTriangulation>;
 
@@ -1,12 +1,17 @@
 #ifndef LIBGCM_SIMPLEXGRID_HPP
 #define LIBGCM_SIMPLEXGRID_HPP
 
+#include <algorithm>
+#include <array>
 #include <numeric>
 #include <list>
+#include <map>
 
 #include <libgcm/util/infrastructure/infrastructure.hpp>
 #include <libgcm/grid/simplex/UnstructuredGrid.hpp>
 #include <libgcm/grid/simplex/VertexInfoAndCellInfo.hpp>
+#include <libgcm/util/math/SpatialIndex.hpp>
+#include <libgcm/util/math/Area.hpp>
 
 
 namespace gcm {
@@ -32,6 +37,8 @@ class SimplexGrid : public UnstructuredGrid {
 public:
 	/// Index of a global triangulation vertex in the grid
 	typedef Iterator::Index LocalVertexIndex;
+	/// Index of a global triangulation cell in the grid
+	typedef size_t LocalCellIndex;
 	
 	/// Space dimensionality
 	static const int DIMENSIONALITY = Dimensionality;
@@ -68,7 +75,11 @@ public:
 	
 	
 	/// Triangulation cell as set of its vertices iterators
-	typedef elements::Element<Iterator, CELL_POINTS_NUMBER> Cell;
+	struct Cell : public elements::Element<Iterator, CELL_POINTS_NUMBER> {
+		using elements::Element<Iterator, CELL_POINTS_NUMBER>::Element;
+		/// index of the cell in the grid, valid if all vertices are set
+		LocalCellIndex index = 0;
+	};
 	
 	
 	/// @name Iterators 
@@ -119,8 +130,23 @@ public:
 	/** Struct for grid constructor */
 	struct ConstructionPack {
 		Triangulation* triangulation;
+		/// optional cells of the grid found in advance by cellsOfAllGrids;
+		/// if null, the grid looks for its cells in the whole triangulation
+		const std::vector<CellHandle>* cells;
+		
+		ConstructionPack(Triangulation* triangulation_,
+				const std::vector<CellHandle>* cells_ = nullptr) :
+						triangulation(triangulation_), cells(cells_) { }
 	};
 	
+	/**
+	 * Group all cells of the triangulation by grids in one pass.
+	 * The result is used to construct several grids without
+	 * repeated iteration over the whole triangulation.
+	 */
+	static std::map<GridId, std::vector<CellHandle>> cellsOfAllGrids(
+			const Triangulation* triangulation);
+	
 	SimplexGrid(const GridId id_, const ConstructionPack& constructionPack);
 	virtual ~SimplexGrid() { }
 	
@@ -161,15 +187,48 @@ public:
 	
 	/** Id of the grid the node is in contact with */
 	GridId contactGridId(const Iterator& it) const {
-		std::set<GridId> incidentGrids = gridsAroundVertex(it);
-		assert_true(incidentGrids.erase(id));
-		assert_eq(incidentGrids.size(), 1);
-		const GridId ans = *incidentGrids.begin();
+		const auto found = std::lower_bound(
+				contactIndices.begin(), contactIndices.end(), (LocalVertexIndex) it);
+		assert_true(found != contactIndices.end() && *found == it);
+		const GridId ans = contactGridIds[(size_t) (found - contactIndices.begin())];
 		assert_ne(ans, EmptySpaceFlag);
 		return ans;
 	}
 	
 	
+	/**
+	 * Facet of the grid's cell, which neighbor cell belongs to
+	 * other grid or empty space
+	 */
+	struct BoundaryFacet {
+		CellHandle cell;   ///< local cell
+		int indexInCell;   ///< index of the vertex opposite to the facet
+		GridId neighborId; ///< grid id of the neighbor cell
+	};
+	
+	/** All boundary facets of the grid. @threadsafe */
+	std::vector<BoundaryFacet> boundaryFacets() const;
+	
+	/** Boundary vertex with information gathered from its boundary facets */
+	struct BoundaryVertex {
+		LocalVertexIndex vertex;
+		/// sorted ids of grids (including EmptySpaceFlag) behind incident
+		/// boundary facets of this grid
+		std::vector<GridId> neighborIds;
+		/// sums of normals of incident boundary facets
+		/// behind which are the corresponding neighborIds, not normalized
+		std::vector<RealD> normals;
+	};
+	
+	/**
+	 * All vertices of the grid lying on its boundary facets, sorted by vertex.
+	 * Facets are found once and then all vertices are processed in parallel.
+	 * Normals are the same as from contactNormal, but grids which touch
+	 * the vertex without common facets with this grid are not in neighborIds.
+	 */
+	std::vector<BoundaryVertex> boundaryVertices() const;
+	
+	
 	bool isInner(const Iterator& it) const {
 		return borderState(it) == BorderState::INNER;
 	}
@@ -197,19 +256,58 @@ public:
 	 */
 	Cell findCellCrossedByTheRay(const Iterator& it, const RealD& shift) const;
 	
+	/**
+	 * Number of cases in this grid when the line walk in
+	 * findCellCrossedByTheRay failed to find the cell found then by the
+	 * fallback walk from inside of the incident cell. Geometric predicates
+	 * of the walk are exact, so the number is expected to be zero.
+	 */
+	size_t numberOfFallbackWalks() const { return fallbackWalksCounter; }
+	
+	
+	/**
+	 * The same as findCellCrossedByTheRay for several points on the same ray
+	 * (it + direction * distances(k)), but performs at most one line walk
+	 * on each side of the vertex instead of one walk per point.
+	 * For zero distances cell.n == 0 is returned.
+	 */
+	template<int M>
+	std::array<Cell, (size_t)M> findCellsCrossedByTheRay(const Iterator& it,
+			const RealD& direction, const linal::Vector<M>& distances) const {
+		real d[(size_t)M];
+		for (int k = 0; k < M; k++) {
+			d[k] = distances(k);
+		}
+		std::array<Cell, (size_t)M> ans;
+		findCellsCrossedByTheRay(it, direction, M, d, ans.data());
+		return ans;
+	}
+	
+	/// Maximal number of points for one call of findCellsCrossedByTheRay
+	static const int MAX_NUMBER_OF_POINTS_ON_THE_RAY = 16;
+	
+	/** @see findCellsCrossedByTheRay above */
+	void findCellsCrossedByTheRay(const Iterator& it, const RealD& direction,
+			const int number, const real distances[], Cell cells[]) const;
+	
 	
 	/**
 	 * Locate cell contains point on specified distance (shift)
-	 * from specified vertex (it) by triangulation->locate function.
+	 * from specified vertex (it) by the spatial index of the grid.
 	 * It uses different algorithm than findCellCrossedByTheRay.
 	 * @see findCellCrossedByTheRay
 	 */
 	Cell locateOwnerCell(const Iterator& it, const RealD& shift) const {
-		CellHandle ch = triangulation->locateOwnerCell(vertexHandle(it), shift);
-		if (belongsToTheGrid(ch)) { return createCell(ch); }
-		else                      { return createCell(); }
+		return locateCell(coordsD(it) + shift);
 	}
 	
+	/**
+	 * Cell of the grid which contains the point.
+	 * If the point is outside the grid, cell.n == 0.
+	 * @threadsafe
+	 */
+	Cell locateCell(const RealD& point) const;
+	
 	
 	/** Average height among all simplices */
 	real getAverageHeight() const {
@@ -226,8 +324,32 @@ public:
 	
 	
 	/** Read-only access to points coordinates in DIMENSIONALITY space */
-	RealD coordsD(const Iterator& it) const {
-		return triangulation->coordsD(vertexHandle(it));
+	const RealD& coordsD(const Iterator& it) const {
+		return vertexCoordinates[it];
+	}
+	
+	
+	/**
+	 * Barycentric coordinates of the point in the cell of the grid
+	 * (cell.n == CELL_POINTS_NUMBER) in the order of cell vertices.
+	 * The inverse affine map of the cell is cached at grid construction,
+	 * so it is one small matrix-vector product.
+	 */
+	linal::Vector<CELL_POINTS_NUMBER> barycentricCoordinates(
+			const Cell& cell, const RealD& point) const {
+		assert_eq(cell.n, CELL_POINTS_NUMBER);
+		const CellGeometry& geometry = cellGeometries[cell.index];
+		if (geometry.isDegenerate) {
+			THROW_INVALID_ARG("Barycentric coordinates in degenerate cell");
+		}
+		const RealD lambda = geometry.inverseMap * (point - geometry.origin);
+		linal::Vector<CELL_POINTS_NUMBER> ans;
+		ans(DIMENSIONALITY) = 1;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			ans(i) = lambda(i);
+			ans(DIMENSIONALITY) -= lambda(i);
+		}
+		return ans;
 	}
 	
 	
@@ -244,6 +366,15 @@ public:
 	/** Find node with specified coordinates */
 	Iterator findVertexByCoordinates(const RealD& coordinates) const;
 	
+	/** The nearest to the point node of the grid */
+	Iterator findNearestVertex(const RealD& point) const;
+	
+	/** @name Nodes inside regions of space, sorted by index @{ */
+	std::vector<Iterator> findVerticesInBox(const RealD& min, const RealD& max) const;
+	std::vector<Iterator> findVerticesInSphere(const RealD& center, const real radius) const;
+	std::vector<Iterator> findVerticesInside(const Area& area) const;
+	/** @} */
+	
 	
 	/** Returns all nodes from this grid connected with given node */
 	std::set<Iterator> findNeighborVertices(const Iterator& it) const {
@@ -263,6 +394,7 @@ public:
 	Cell createCell(const CellHandle ch) const {
 		Cell ans;
 		ans.n = CELL_POINTS_NUMBER;
+		ans.index = ch->info().localCellIndex;
 		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
 			ans(i) = iterator(ch, i);
 		}
@@ -286,6 +418,12 @@ public:
 	 */
 	std::vector<real> allMinimalBorderHeights() const;
 	
+	/**
+	 * For each node of the grid, the minimal among minimal heights
+	 * of all cells of the grid incident to the node
+	 */
+	std::vector<real> nodalMinimalHeights() const;
+	
 	
 	/** Debugging helper */
 	void printCell(const Cell& c) const {
@@ -310,18 +448,39 @@ private:
 	
 	/// Pointers to triangulation vertices this grid owns.
 	/// LocalVertexIndex is the index of VertexHandle in this vector.
-	/// One vertex can be shared between several grids
+	/// One vertex can be shared between several grids.
+	/// Sorted by handles, so local index of the handle is found by binary search
 	std::vector<VertexHandle> vertexHandles;
 	
 	std::vector<LocalVertexIndex> contactIndices; ///< indices of contact vertices in vertexHandles
 	std::vector<LocalVertexIndex> borderIndices;  ///< indices of border vertices in vertexHandles
 	std::vector<LocalVertexIndex> innerIndices;   ///< indices of inner vertices in vertexHandles
 	
+	/// Coordinates of the vertices (addressed by LocalVertexIndex)
+	/// copied from triangulation to the contiguous storage
+	std::vector<RealD> vertexCoordinates;
+	
 	/// Pointers to global triangulation cells this grid owns.
 	/// Each cell is marked by id of the grid the cell belongs to.
 	/// A cell in triangulation can belong to the only one grid (unlike vertices)
 	std::vector<CellHandle> cellHandles;
 	
+	/// Geometry of a cell cached for barycentric coordinates:
+	/// lambda_i = (inverseMap * (point - origin))_i, i < DIMENSIONALITY,
+	/// and the last vertex of the cell is the origin
+	struct CellGeometry {
+		MatrixDD inverseMap;
+		RealD origin;
+		bool isDegenerate;
+	};
+	/// Cached geometry of the cells (addressed by index in cellHandles)
+	std::vector<CellGeometry> cellGeometries;
+	
+	/// Spatial indices for point queries; objects are the local vertices
+	/// (addressed by LocalVertexIndex) and the cells (by index in cellHandles)
+	SpatialIndex<DIMENSIONALITY> verticesIndex;
+	SpatialIndex<DIMENSIONALITY> cellsIndex;
+	
 	/// Minimal among all cells heights of this grid
 	real minimalSpatialStep = 0;
 	/// Average among all cells minimal heights of this grid
@@ -332,6 +491,9 @@ private:
 	friend class simplex::Engine<Dimensionality, TriangulationT>;
 	USE_AND_INIT_LOGGER("gcm.SimplexGrid")
 	
+	/// @see numberOfFallbackWalks
+	mutable size_t fallbackWalksCounter = 0;
+	
 	/** Iterator of vertex at indexInCell position in ch */
 	static LocalVertexIndex iterator(
 			const CellHandle ch, const int indexInCell) {
@@ -341,11 +503,12 @@ private:
 	
 	/** Returns local index of the given vertex */
 	LocalVertexIndex localVertexIndex(const VertexHandle vh) const {
-		std::list<CellHandle> incidentCells = triangulation->allIncidentCells(vh);
-		for (const CellHandle ch : incidentCells) {
-			if (belongsToTheGrid(ch)) { return localVertexIndex(vh, ch); }
+		const auto found = std::lower_bound(
+				vertexHandles.begin(), vertexHandles.end(), vh);
+		if (found == vertexHandles.end() || *found != vh) {
+			THROW_UNSUPPORTED("Given vertex does not belong to this grid");
 		}
-		THROW_UNSUPPORTED("Given vertex does not belong to this grid");
+		return (LocalVertexIndex) (found - vertexHandles.begin());
 	}
 	
 	/** Returns local index of the given vertex using info from given cell */
@@ -375,49 +538,36 @@ private:
 	}
 	
 	
-	/** Fill in innerIndices, borderIndices, contactIndices */
+	/**
+	 * Fill in innerIndices, borderIndices, contactIndices, contactGridIds
+	 * and borderStates by grids behind the boundary facets of vertices
+	 */
 	void markInnersAndBorders();
 	
 	
-	enum class BorderState {
+	enum class BorderState : char {
 		MULTICONTACT,
 		CONTACT,
 		BORDER,
 		INNER
 	};
+	/// State of each vertex, @see markInnersAndBorders
+	std::vector<BorderState> borderStates;
+	/// Ids of the grids behind contact vertices, in order of contactIndices
+	std::vector<GridId> contactGridIds;
+	
 	BorderState borderState(const LocalVertexIndex it) const {
-		std::set<GridId> incidentGrids = gridsAroundVertex(it);
-		assert_true(incidentGrids.erase(id));
-		if (incidentGrids.empty()) { return BorderState::INNER; }
-		if (incidentGrids.size() > 1) { return BorderState::MULTICONTACT; }
-		if (*incidentGrids.begin() == EmptySpaceFlag) { return BorderState::BORDER; }
-		return BorderState::CONTACT;
+		return borderStates[(size_t) it];
 	}
 	
 	
 	/** Incident cells which belong to this grid */
-	std::list<CellHandle> localIncidentCells(const LocalVertexIndex it) const {
-		VertexHandle vh = vertexHandle(it);
-		std::list<CellHandle> ans = triangulation->allIncidentCells(vh);
-		auto listIter = ans.begin();
-		while (listIter != ans.end()) {
-			if (belongsToTheGrid(*listIter)) {
-				++listIter;
-			} else {
-				listIter = ans.erase(listIter);
-			}
-		}
-		return ans;
-	}
-	
-	
-	/** All different gridIds from all cells incident to the vertex */
-	std::set<GridId> gridsAroundVertex(const Iterator it) const {
+	std::vector<CellHandle> localIncidentCells(const LocalVertexIndex it) const {
 		VertexHandle vh = vertexHandle(it);
-		std::list<CellHandle> cells = triangulation->allIncidentCells(vh);
-		std::set<GridId> ans;
-		for (const auto cell : cells) {
-			ans.insert(cell->info().getGridId());
+		const auto allCells = triangulation->allIncidentCells(vh);
+		std::vector<CellHandle> ans;
+		for (const CellHandle ch : allCells) {
+			if (belongsToTheGrid(ch)) { ans.push_back(ch); }
 		}
 		return ans;
 	}
@@ -426,7 +576,7 @@ private:
 	template<typename Predicate>
 	RealD normal(const Iterator& it, const Predicate isOuterCellToUse) const {
 		std::list<RealD> facesNormals;
-		const std::list<CellHandle> localCells = localIncidentCells(it);
+		const std::vector<CellHandle> localCells = localIncidentCells(it);
 		for (const CellHandle localCell : localCells) {
 			for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
 				CellHandle outerCell = localCell->neighbor(i);
@@ -451,6 +601,8 @@ private:
 	
 	
 	void collectCellHeightsStatistics();
+	void buildSpatialIndices();
+	void buildCellGeometries();
 };
 
 
@@ -0,0 +1,410 @@
+#ifndef LIBGCM_TRIANGULATIONSANITIZER_HPP
+#define LIBGCM_TRIANGULATIONSANITIZER_HPP
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include <libgcm/util/Enum.hpp>
+#include <libgcm/util/Utils.hpp>
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+
+
+namespace gcm {
+
+/**
+ * Cleaning of the triangulation from bad material cases.
+ *
+ * The first case is "hanged cells": some cell of the triangulation
+ * has no neighbors with the same material id. The material of such cell
+ * is replaced with the most common material of neighbors.
+ *
+ * The second case is "disconnected cells sets": in some vertex of the
+ * triangulation cells of the same material(id) are not neighbors of each
+ * other. This is demonstrated on picture for material A: A(3) is not
+ * connected with A(1) and A(2). Thus, for material A we have two so called
+ * "disconnected cells sets" (and one cells set for B and for C):
+ *    \       /
+ *     \  B  /
+ *      \   /  A(1)
+ *       \ /________
+ *  A(3) /|\
+ *      / | \  A(2)
+ *     /  |  \
+ *    / C | C \
+ * For such cases, the border normal for material A is meaningless.
+ * All sets of such material but the largest one are given to other material.
+ *
+ * The triangulation is given by flat arrays as in FlatTriangulationStorage.
+ * Both passes have no recursion and run in parallel. Hanged cells are
+ * corrected by materials of neighbors before the pass. Vertices propose
+ * changes by materials around them before the round; proposals of vertices
+ * with common incident cells are applied in order of vertices indices,
+ * the rest ones are proposed again in the next round.
+ * @tparam CellSize number of vertices in cell
+ */
+template<int CellSize>
+class TriangulationSanitizer {
+public:
+	/// the same as in FlatTriangulationStorage
+	typedef int Index;
+	typedef std::array<Index, (size_t)CellSize> Cell;
+	
+	/**
+	 * @param cellVertices_ vertices of all cells including infinite ones
+	 * @param cellNeighbors_ i'th neighbor is opposite to i'th vertex
+	 * @param incidentCellsOffsets_ incident cells of the finite vertex v are
+	 * stored between incidentCellsOffsets[v] and incidentCellsOffsets[v + 1]
+	 * @param incidentCells_ @see incidentCellsOffsets_
+	 * @param infiniteVertex_ finite vertices are numbered before it
+	 */
+	TriangulationSanitizer(const std::vector<Cell>& cellVertices_,
+			const std::vector<Cell>& cellNeighbors_,
+			const std::vector<Index>& incidentCellsOffsets_,
+			const std::vector<Index>& incidentCells_, const Index infiniteVertex_) :
+			cellVertices(cellVertices_), cellNeighbors(cellNeighbors_),
+			incidentCellsOffsets(incidentCellsOffsets_), incidentCells(incidentCells_),
+			infiniteVertex(infiniteVertex_) {
+		assert_eq(cellVertices.size(), cellNeighbors.size());
+		assert_ge(incidentCellsOffsets.size(), (size_t)infiniteVertex + 1);
+	}
+	
+	
+	/**
+	 * Find incident cells of finite vertices in the format
+	 * required by the constructor
+	 */
+	static void findIncidentCells(const std::vector<Cell>& cellVertices,
+			const Index infiniteVertex,
+			std::vector<Index>& offsets, std::vector<Index>& cells) {
+		offsets.assign((size_t)infiniteVertex + 2, 0);
+		for (const Cell& vertices : cellVertices) {
+			for (const Index v : vertices) {
+				if (v != infiniteVertex) { offsets[(size_t)v + 1]++; }
+			}
+		}
+		for (size_t v = 0; v < (size_t)infiniteVertex; v++) {
+			offsets[v + 1] += offsets[v];
+		}
+		offsets.back() = offsets[(size_t)infiniteVertex];
+		cells.resize((size_t)offsets.back());
+		std::vector<Index> filled(offsets.begin(), offsets.end() - 1);
+		for (size_t c = 0; c < cellVertices.size(); c++) {
+			for (const Index v : cellVertices[c]) {
+				if (v != infiniteVertex) { cells[(size_t)filled[(size_t)v]++] = (Index)c; }
+			}
+		}
+	}
+	
+	
+	/**
+	 * Correct hanged cells and disconnected cells sets by turns
+	 * until nothing is changed or maxIterations is reached
+	 * @param gridIds materials of all cells to correct
+	 */
+	void sanitize(std::vector<GridId>& gridIds, const int maxIterations = 10) const {
+		USE_AND_INIT_LOGGER("gcm.TriangulationSanitizer")
+		int hangedCellsCounter = 1;
+		int disconnectedCellsSetsCaseCounter = 1;
+		int iterationsCounter = 0;
+		while (disconnectedCellsSetsCaseCounter > 0 || hangedCellsCounter > 0) {
+			if (++iterationsCounter > maxIterations) { break; }
+			LOG_INFO("Cleaning the triangulation from bad material cases: "
+					<< "iteration " << iterationsCounter);
+			
+			hangedCellsCounter = correctHangedCells(gridIds);
+			LOG_INFO(hangedCellsCounter << " hanged cells cases was found");
+			
+			disconnectedCellsSetsCaseCounter = clearFromDisconnectedCellSets(gridIds);
+			LOG_INFO(disconnectedCellsSetsCaseCounter << " DCS cases was found");
+		}
+	}
+	
+	
+	/**
+	 * Replace materials of finite cells without neighbors of the same
+	 * material with the most common material of neighbors
+	 * @return number of replaced cells
+	 */
+	int correctHangedCells(std::vector<GridId>& gridIds) const {
+		assert_eq(gridIds.size(), cellVertices.size());
+		std::vector<GridId> newIds(gridIds);
+		int hangsCounter = 0;
+		
+		#pragma omp parallel for schedule(dynamic, 1024) reduction(+:hangsCounter)
+		for (size_t c = 0; c < cellVertices.size(); c++) {
+			if (isInfinite(c)) { continue; }
+			std::array<GridId, (size_t)CellSize> neighborsIds;
+			for (size_t i = 0; i < (size_t)CellSize; i++) {
+				neighborsIds[i] = gridIds[(size_t)cellNeighbors[c][i]];
+			}
+			if (std::find(neighborsIds.begin(), neighborsIds.end(), gridIds[c]) !=
+					neighborsIds.end()) { continue; }
+			
+			++hangsCounter;
+			/// the smallest one among equally common ids
+			std::sort(neighborsIds.begin(), neighborsIds.end());
+			GridId theMostCommonId = neighborsIds[0];
+			size_t maxCount = 0;
+			for (size_t i = 0; i < (size_t)CellSize; ) {
+				size_t j = i;
+				while (j < (size_t)CellSize && neighborsIds[j] == neighborsIds[i]) { ++j; }
+				if (j - i > maxCount) {
+					maxCount = j - i;
+					theMostCommonId = neighborsIds[i];
+				}
+				i = j;
+			}
+			newIds[c] = theMostCommonId;
+		}
+		
+		gridIds.swap(newIds);
+		return hangsCounter;
+	}
+	
+	
+	/**
+	 * Give all disconnected cells sets but the largest one
+	 * of some material in some vertex to other material until
+	 * there are no such cases (or maxRounds is reached)
+	 * @return number of corrected cases
+	 */
+	int clearFromDisconnectedCellSets(std::vector<GridId>& gridIds,
+			const int maxRounds = 1000) const {
+		USE_AND_INIT_LOGGER("gcm.TriangulationSanitizer")
+		assert_eq(gridIds.size(), cellVertices.size());
+		std::vector<Index> vertices((size_t)infiniteVertex);
+		for (size_t v = 0; v < vertices.size(); v++) { vertices[v] = (Index)v; }
+		/// cells incident to the vertices with applied proposals in the round
+		std::vector<char> locked(cellVertices.size(), false);
+		std::vector<Proposal> proposals, accepted;
+		std::vector<Index> cellsToChange;
+		int casesCounter = 0;
+		
+		for (int round = 0; !vertices.empty(); round++) {
+			if (round == maxRounds) {
+				LOG_WARN("Cleaning from DCS is stopped after " << round << " rounds");
+				break;
+			}
+			
+			proposals.clear();
+			cellsToChange.clear();
+			#pragma omp parallel
+			{
+				Workspace workspace;
+				std::vector<Proposal> localProposals;
+				std::vector<Index> localCells;
+				#pragma omp for schedule(dynamic, 1024) nowait
+				for (size_t k = 0; k < vertices.size(); k++) {
+					propose(vertices[k], round, gridIds,
+							workspace, localProposals, localCells);
+				}
+				#pragma omp critical
+				{
+				const size_t shift = cellsToChange.size();
+				cellsToChange.insert(cellsToChange.end(), localCells.begin(), localCells.end());
+				for (Proposal p : localProposals) {
+					p.begin += shift;
+					p.end += shift;
+					proposals.push_back(p);
+				}
+				}
+			}
+			std::sort(proposals.begin(), proposals.end(),
+					[](const Proposal& a, const Proposal& b) { return a.vertex < b.vertex; });
+			
+			/// conflict resolution
+			std::vector<Index> nextVertices;
+			accepted.clear();
+			for (const Proposal& p : proposals) {
+				const Index* begin = incidentBegin(p.vertex);
+				const Index* end = incidentEnd(p.vertex);
+				if (std::any_of(begin, end, [&](const Index c) { return locked[(size_t)c]; })) {
+					nextVertices.push_back(p.vertex);
+					continue;
+				}
+				for (const Index* c = begin; c != end; ++c) { locked[(size_t)*c] = true; }
+				accepted.push_back(p);
+			}
+			casesCounter += (int)accepted.size();
+			
+			/// accepted proposals change disjoint sets of cells
+			#pragma omp parallel for
+			for (size_t k = 0; k < accepted.size(); k++) {
+				for (size_t i = accepted[k].begin; i < accepted[k].end; i++) {
+					gridIds[(size_t)cellsToChange[i]] = accepted[k].newId;
+				}
+			}
+			
+			/// vertices around changed cells are checked again
+			for (const Proposal& p : accepted) {
+				for (const Index* c = incidentBegin(p.vertex); c != incidentEnd(p.vertex); ++c) {
+					locked[(size_t)*c] = false;
+				}
+				for (size_t i = p.begin; i < p.end; i++) {
+					for (const Index v : cellVertices[(size_t)cellsToChange[i]]) {
+						if (v != infiniteVertex) { nextVertices.push_back(v); }
+					}
+				}
+			}
+			std::sort(nextVertices.begin(), nextVertices.end());
+			nextVertices.erase(std::unique(nextVertices.begin(), nextVertices.end()),
+					nextVertices.end());
+			vertices.swap(nextVertices);
+		}
+		
+		return casesCounter;
+	}
+	
+	
+private:
+	const std::vector<Cell>& cellVertices;
+	const std::vector<Cell>& cellNeighbors;
+	const std::vector<Index>& incidentCellsOffsets;
+	const std::vector<Index>& incidentCells;
+	const Index infiniteVertex;
+	
+	/// Change of materials of cells
+	/// cellsToChange[begin, end) around the vertex
+	struct Proposal {
+		Index vertex;
+		GridId newId;
+		size_t begin, end;
+	};
+	
+	/// Material statistics around the vertex
+	struct MaterialInfo {
+		GridId id;
+		size_t numberOfCcsWithId;
+		size_t numberOfCellsWithId;
+	};
+	
+	/// Buffers reused by the thread for all vertices
+	struct Workspace {
+		std::vector<int> labels;
+		std::vector<size_t> stack;
+		std::vector<GridId> componentIds;
+		std::vector<size_t> componentSizes;
+		std::vector<MaterialInfo> materials;
+	};
+	
+	
+	bool isInfinite(const size_t c) const {
+		const Cell& vertices = cellVertices[c];
+		return std::find(vertices.begin(), vertices.end(), infiniteVertex) != vertices.end();
+	}
+	
+	const Index* incidentBegin(const Index v) const {
+		return incidentCells.data() + incidentCellsOffsets[(size_t)v];
+	}
+	
+	const Index* incidentEnd(const Index v) const {
+		return incidentCells.data() + incidentCellsOffsets[(size_t)v + 1];
+	}
+	
+	
+	/**
+	 * Find connected cells sets around the vertex and propose
+	 * the change if some material has several ones
+	 */
+	void propose(const Index v, const int round, const std::vector<GridId>& gridIds,
+			Workspace& w, std::vector<Proposal>& proposals,
+			std::vector<Index>& cellsToChange) const {
+		
+		const Index* cells = incidentBegin(v);
+		const size_t n = (size_t)(incidentEnd(v) - cells);
+		if (std::all_of(cells, cells + n, [&](const Index c) {
+				return gridIds[(size_t)c] == gridIds[(size_t)cells[0]]; })) { return; }
+		
+		/// connected cells sets by depth-first search through faces around v
+		w.labels.assign(n, -1);
+		w.componentIds.clear();
+		w.componentSizes.clear();
+		for (size_t k = 0; k < n; k++) {
+			if (w.labels[k] >= 0) { continue; }
+			const int component = (int)w.componentIds.size();
+			const GridId id = gridIds[(size_t)cells[k]];
+			size_t size = 0;
+			w.labels[k] = component;
+			w.stack.assign(1, k);
+			while (!w.stack.empty()) {
+				const size_t c = (size_t)cells[w.stack.back()];
+				w.stack.pop_back();
+				++size;
+				for (size_t i = 0; i < (size_t)CellSize; i++) {
+					if (cellVertices[c][i] == v) { continue; }
+					const Index neighbor = cellNeighbors[c][i];
+					if (gridIds[(size_t)neighbor] != id) { continue; }
+					const size_t l = (size_t)(std::find(cells, cells + n, neighbor) - cells);
+					if (l < n && w.labels[l] < 0) {
+						w.labels[l] = component;
+						w.stack.push_back(l);
+					}
+				}
+			}
+			w.componentIds.push_back(id);
+			w.componentSizes.push_back(size);
+		}
+		
+		/// materials sorted by ids
+		w.materials.clear();
+		for (size_t s = 0; s < w.componentIds.size(); s++) {
+			auto m = std::find_if(w.materials.begin(), w.materials.end(),
+					[&](const MaterialInfo& info) { return info.id == w.componentIds[s]; });
+			if (m == w.materials.end()) {
+				w.materials.push_back({w.componentIds[s], 0, 0});
+				m = w.materials.end() - 1;
+			}
+			++m->numberOfCcsWithId;
+			m->numberOfCellsWithId += w.componentSizes[s];
+		}
+		std::sort(w.materials.begin(), w.materials.end(),
+				[](const MaterialInfo& a, const MaterialInfo& b) { return a.id < b.id; });
+		
+		/// the id with the biggest number of disconnected cells sets (DCS),
+		/// the lowest number of cells among them and the biggest id
+		auto toRemove = w.materials.begin();
+		for (auto m = w.materials.begin(); m != w.materials.end(); ++m) {
+			if (std::make_tuple(m->numberOfCcsWithId, toRemove->numberOfCellsWithId, m->id) >
+					std::make_tuple(toRemove->numberOfCcsWithId, m->numberOfCellsWithId, toRemove->id)) {
+				toRemove = m;
+			}
+		}
+		if (toRemove->numberOfCcsWithId == 1) { return; }
+		
+		/// other material is chosen pseudo-randomly, but reproducibly
+		const Index seed[2] = {v, round};
+		size_t choice = Utils::hash(seed, sizeof(seed)) % (w.materials.size() - 1);
+		if (choice >= (size_t)(toRemove - w.materials.begin())) { ++choice; }
+		
+		const GridId idToRemove = toRemove->id;
+		int largestSet = -1;
+		for (size_t s = 0; s < w.componentIds.size(); s++) {
+			if (w.componentIds[s] == idToRemove && (largestSet < 0 ||
+					w.componentSizes[(size_t)largestSet] < w.componentSizes[s])) {
+				largestSet = (int)s;
+			}
+		}
+		
+		Proposal proposal;
+		proposal.vertex = v;
+		proposal.newId = w.materials[choice].id;
+		proposal.begin = cellsToChange.size();
+		for (size_t k = 0; k < n; k++) {
+			const int s = w.labels[k];
+			if (w.componentIds[(size_t)s] == idToRemove && s != largestSet &&
+					!isInfinite((size_t)cells[k])) {
+				cellsToChange.push_back(cells[k]);
+			}
+		}
+		proposal.end = cellsToChange.size();
+		/// other sets can consist of infinite cells only
+		if (proposal.end > proposal.begin) { proposals.push_back(proposal); }
+	}
+};
+
+
+}
+
+#endif // LIBGCM_TRIANGULATIONSANITIZER_HPP
@@ -20,6 +20,10 @@ struct CellInfoT {
 	/// the same with their pointers (VertexHandles)
 	typedef size_t LocalVertexIndex;
 	LocalVertexIndex localVertexIndices[CELL_POINTS_NUMBER];
+	
+	/// index of the cell among cells of the grid it belongs to
+	typedef size_t LocalCellIndex;
+	LocalCellIndex localCellIndex;
 };
 
 /** Auxiliary information stored in global triangulation vertices */
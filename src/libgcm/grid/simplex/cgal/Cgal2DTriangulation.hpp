@@ -7,6 +7,7 @@
 #include <CGAL/Triangulation_face_base_with_info_2.h>
 
 #include <libcgalmesher/Cgal2DMesher.hpp>
+#include <libgcm/grid/simplex/MeshSizing.hpp>
 
 #include <libgcm/linal/linal.hpp>
 #include <libgcm/util/task/Task.hpp>
@@ -62,8 +63,18 @@ public:
 		}
 		
 		LOG_DEBUG("Call Cgal2DMesher");
-		cgalmesher::Cgal2DMesher::triangulate(
-				task.simplexGrid.spatialStep, bodies, triangulation);
+		const MeshSizing sizing(task);
+		if (sizing.isWaveSpeedAware()) {
+			LOG_INFO("Wave-speed-aware meshing, minimal spatial step: "
+					<< sizing.minimalStep());
+			cgalmesher::Cgal2DMesher::triangulate(
+					[&sizing] (const Body::Point& p, const size_t bodyId) {
+						return sizing({p[0], p[1], 0}, bodyId);
+					}, bodies, triangulation);
+		} else {
+			cgalmesher::Cgal2DMesher::triangulate(
+					task.simplexGrid.spatialStep, bodies, triangulation);
+		}
 		
 		LOG_INFO("Number of all vertices after meshing: " << triangulation.number_of_vertices());
 		LOG_INFO("Number of all cells after meshing: " << triangulation.number_of_faces());
@@ -7,7 +7,9 @@
 #include <CGAL/Triangulation_cell_base_with_info_3.h>
 
 #include <libcgalmesher/Cgal3DMesher.hpp>
+#include <libgcm/grid/simplex/MeshSizing.hpp>
 #include <libgcm/grid/simplex/mesh_loaders/InmMeshLoader.hpp>
+#include <libgcm/grid/simplex/mesh_loaders/BinaryMeshLoader.hpp>
 
 #include <libgcm/linal/linal.hpp>
 #include <libgcm/util/task/Task.hpp>
@@ -57,14 +59,20 @@ public:
 		switch (task.simplexGrid.mesher) {
 			case Task::SimplexGrid::Mesher::CGAL_MESHER:
 				LOG_DEBUG("Call Cgal3DMesher");
-				cgalmesher::Cgal3DMesher::triangulate(
-						task.simplexGrid.spatialStep, task.simplexGrid.detectSharpEdges,
-						task.simplexGrid.fileName, triangulation);
+				if (task.simplexGrid.parallelMeshing &&
+						!cgalmesher::Cgal3DMesher::isParallelMeshingAvailable()) {
+					LOG_WARN("CGAL is linked without TBB, meshing is sequential");
+				}
+				triangulate(task);
 				break;
 			case Task::SimplexGrid::Mesher::INM_MESHER:
 				LOG_DEBUG("Call InmMeshLoader");
 				InmMeshLoader::load(task.simplexGrid.fileName, triangulation);
 				break;
+			case Task::SimplexGrid::Mesher::BINARY_MESHER:
+				LOG_DEBUG("Call BinaryMeshLoader");
+				loadBinaryMesh(task.simplexGrid.fileName);
+				break;
 			default:
 				THROW_UNSUPPORTED("Unknown mesher");
 		}
@@ -295,6 +303,55 @@ public:
 protected:
 	Triangulation triangulation; ///< CGAL triangulation structure
 	
+	/** Mesh the polyhedron by uniform or wave-speed-aware spatial step */
+	void triangulate(const Task& task) {
+		const Task::SimplexGrid& settings = task.simplexGrid;
+		const MeshSizing sizing(task);
+		if (!sizing.isWaveSpeedAware()) {
+			cgalmesher::Cgal3DMesher::triangulate(
+					settings.spatialStep, settings.detectSharpEdges,
+					settings.fileName, triangulation, settings.parallelMeshing);
+			return;
+		}
+		
+		LOG_INFO("Wave-speed-aware meshing, minimal spatial step: "
+				<< sizing.minimalStep());
+		/// the mesher produces the single body;
+		/// sizing is thread-safe as parallel meshing requires
+		const size_t bodyId = cgalmesher::Cgal3DMesher::BODY_ID;
+		cgalmesher::Cgal3DMesher::triangulate(
+				[&sizing, bodyId] (const std::array<double, 3>& p) {
+					return sizing({p[0], p[1], p[2]}, bodyId);
+				},
+				sizing.minimalStep(), settings.detectSharpEdges,
+				settings.fileName, triangulation, settings.parallelMeshing);
+	}
+	
+	/**
+	 * Points of the binary mesh are inserted into the triangulation
+	 * and its cells are matched with given ones as for INM meshes
+	 */
+	void loadBinaryMesh(const std::string& fileName) {
+		const BinaryMeshLoader mesh(fileName);
+		if (mesh.dimensionality() != DIMENSIONALITY) {
+			THROW_INVALID_INPUT("Binary mesh has wrong dimensionality");
+		}
+		std::vector<Real3> points(mesh.numberOfPoints());
+		for (size_t i = 0; i < points.size(); i++) {
+			points[i] = {mesh.point(i)[0], mesh.point(i)[1], mesh.point(i)[2]};
+		}
+		InmMeshLoader::Materials materials(mesh.numberOfCells());
+		for (size_t c = 0; c < materials.size(); c++) {
+			for (int i = 0; i < CELL_SIZE; i++) {
+				materials[c].first[(size_t)i] = (size_t)mesh.cellVertex(c, i) + 1;
+			}
+			std::sort(materials[c].first.begin(), materials[c].first.end());
+			materials[c].second = mesh.hasMaterials() ? mesh.material(c) : 0;
+		}
+		std::sort(materials.begin(), materials.end());
+		InmMeshLoader::load(points, materials, triangulation);
+	}
+	
 	USE_AND_INIT_LOGGER("gcm.Cgal3DTriangulation")
 	friend class CgalTriangulation<DIMENSIONALITY, VertexInfo, CellInfo>;
 };
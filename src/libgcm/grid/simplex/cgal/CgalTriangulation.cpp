@@ -11,102 +11,55 @@ CgalTriangulation(const Task& task) : Base(task) {
 	static_assert(CELL_POINTS_NUMBER == Base::CELL_SIZE, "");
 	static_assert(DIMENSIONALITY == Base::DIMENSIONALITY, "");
 	rescale(task.simplexGrid.scale);
-	
-	int hangedCellsCounter = 1;
-	int disconnectedCellsSetsCaseCounter = 1;
-	int iterationsCounter = 0;
-	while (disconnectedCellsSetsCaseCounter > 0 || hangedCellsCounter > 0) {
-		if (++iterationsCounter > 10 ) { break; }
-		LOG_INFO("Cleaning the triangulation from bad material cases: "
-				<< "iteration " << iterationsCounter);
-		
-		hangedCellsCounter = correctHangedCells();
-		LOG_INFO(hangedCellsCounter << " hanged cells cases was found");
-		
-		
-		disconnectedCellsSetsCaseCounter = 0;
-		for (auto vertexIter = verticesBegin();
-		          vertexIter != verticesEnd(); ++vertexIter) {
-			while (clearFromDisconnectedCellSets(vertexIter)) {
-				++disconnectedCellsSetsCaseCounter;
-			}
-		}
-		LOG_INFO(disconnectedCellsSetsCaseCounter << " DCS cases was found");
-	}
+	sanitize();
 }
 
 
 template<int Dimensionality, typename VertexInfo, typename CellInfo>
-int
+void
 CgalTriangulation<Dimensionality, VertexInfo, CellInfo>::
-correctHangedCells() {
-	int hangsCounter = 0;
-	for (auto cell = this->allCellsBegin();
-			cell != this->allCellsEnd(); ++cell) if (!isInfinite(cell)) {
-		std::multiset<GridId> neighborsId;
+sanitize() {
+	typedef TriangulationSanitizer<CELL_POINTS_NUMBER> Sanitizer;
+	typedef typename Sanitizer::Index Index;
+	
+	/// the triangulation is copied to flat arrays as in FlatTriangulationStorage;
+	/// indices are kept in infos, cell infos are rewritten by grids later
+	Index numberOfVertices = 0;
+	for (auto v = verticesBegin(); v != verticesEnd(); ++v) {
+		v->info() = (VertexInfo)numberOfVertices++;
+	}
+	const Index infiniteVertex = numberOfVertices;
+	this->triangulation.infinite_vertex()->info() = (VertexInfo)infiniteVertex;
+	
+	std::vector<CellHandle> cells;
+	for (auto c = this->allCellsBegin(); c != this->allCellsEnd(); ++c) {
+		const CellHandle ch = c;
+		ch->info().localCellIndex = cells.size();
+		cells.push_back(ch);
+	}
+	
+	std::vector<typename Sanitizer::Cell> cellVertices(cells.size());
+	std::vector<typename Sanitizer::Cell> cellNeighbors(cells.size());
+	std::vector<GridId> gridIds(cells.size());
+	for (size_t c = 0; c < cells.size(); c++) {
 		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
-			neighborsId.insert(cell->neighbor(i)->info().getGridId());
-		}
-		if (neighborsId.find(cell->info().getGridId()) == neighborsId.end()) {
-		/// the cell has no neighbors with the same material id
-			++hangsCounter;
-			GridId theMostCommonId = *neighborsId.begin();
-			for (const GridId id : neighborsId) {
-				if (neighborsId.count(id) > neighborsId.count(theMostCommonId)) {
-					theMostCommonId = id;
-				}
-			}
-			cell->info().setGridId(theMostCommonId);
+			cellVertices[c][(size_t)i] = (Index)cells[c]->vertex(i)->info();
+			cellNeighbors[c][(size_t)i] = (Index)cells[c]->neighbor(i)->info().localCellIndex;
 		}
+		gridIds[c] = cells[c]->info().getGridId();
 	}
-	return hangsCounter;
-}
-
-
-template<int Dimensionality, typename VertexInfo, typename CellInfo>
-bool
-CgalTriangulation<Dimensionality, VertexInfo, CellInfo>::
-clearFromDisconnectedCellSets(VertexHandle vh) {
-	std::set<GridId> uniqueMaterials = incidentGridsIds(vh);
-	if (uniqueMaterials.size() == 1) { return false; }
-	CCSMultiset connectedCellsSets = constructCCSMultiset(vh);
 	
-	struct CcsInfo {
-		GridId id;
-		size_t numberOfCcsWithId = 0;
-		size_t numberOfCellsWithId = 0;
-	};
-	std::list<CcsInfo> idsSortedByNumberOfCells;
-	for (const GridId id : uniqueMaterials) {
-		CcsInfo ccsInfo;
-		ccsInfo.id = id;
-		const auto range = connectedCellsSets.equal_range(ConnectedCellsSet(id));
-		for (auto it = range.first; it != range.second; ++it) {
-			++ccsInfo.numberOfCcsWithId;
-			ccsInfo.numberOfCellsWithId += it->size();
+	std::vector<Index> incidentCellsOffsets, incidentCells;
+	Sanitizer::findIncidentCells(cellVertices, infiniteVertex,
+			incidentCellsOffsets, incidentCells);
+	Sanitizer(cellVertices, cellNeighbors, incidentCellsOffsets,
+			incidentCells, infiniteVertex).sanitize(gridIds);
+	
+	for (size_t c = 0; c < cells.size(); c++) {
+		if (!isInfinite(cells[c])) {
+			cells[c]->info().setGridId(gridIds[c]);
 		}
-		idsSortedByNumberOfCells.push_back(ccsInfo);
 	}
-	idsSortedByNumberOfCells.sort([](const CcsInfo& a, const CcsInfo& b) {
-		return a.numberOfCellsWithId > b.numberOfCellsWithId;}); // descending
-	std::list<CcsInfo> idsSortedByNumberOfCcs(idsSortedByNumberOfCells);
-	idsSortedByNumberOfCcs.sort([](const CcsInfo& a, const CcsInfo& b) {
-		return a.numberOfCcsWithId < b.numberOfCcsWithId;}); // ascending
-	// now, the id with the biggest number of disconnected cells sets (DCS)
-	// and the lowest (among equal number of DCS) number of cells is at the end:
-	CcsInfo toRemove = idsSortedByNumberOfCcs.back();
-	if (toRemove.numberOfCcsWithId == 1) { return false; }
-	// replace with id with the biggest number of cells:
-//	CcsInfo toInsert = idsSortedByNumberOfCells.front();
-//	if (toInsert.id == toRemove.id) {
-//		toInsert = *std::next(idsSortedByNumberOfCells.begin());
-//	}
-	GridId idToInsert =
-		Utils::chooseRandomElementExceptSpecified(uniqueMaterials, toRemove.id);
-	
-	removeDCS(toRemove.id, idToInsert, connectedCellsSets);
-//	std::cout << coordsD(vh);
-	return true;
 }
 
 
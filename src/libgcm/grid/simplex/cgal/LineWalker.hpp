@@ -16,8 +16,8 @@ public:
 	LineWalker() {}
 	
 	template<typename TA, typename TB, typename TC, typename TD>
-	static real orientation(const TA a, const TB b, const TC c, const TD d) {
-		return linal::orientedVolume(
+	static int orientation(const TA a, const TB b, const TC c, const TD d) {
+		return linal::orientation(
 				Triangulation::realD(a), Triangulation::realD(b),
 				Triangulation::realD(c), Triangulation::realD(d));
 	}
@@ -23,9 +23,9 @@ public:
 	static const int CELL_SIZE = Triangulation::CELL_POINTS_NUMBER;
 	
 	template<typename TA, typename TB, typename TD>
-	static real orientation(const TA a, const TB b, const TD d) {
-	/// oriented volume to determine where to go next
-		return linal::orientedArea(Triangulation::realD(a),
+	static int orientation(const TA a, const TB b, const TD d) {
+	/// exact sign of oriented volume to determine where to go next
+		return linal::orientation(Triangulation::realD(a),
 				Triangulation::realD(b), Triangulation::realD(d));
 	}
 	
@@ -56,8 +56,8 @@ public:
 	 * Collect cells along the line from the vertex q to point p.
 	 * The search accepts only "valid" cells in terms of given predicate:
 	 * if meet a not "valid" cell, the search is stopped.
-	 * This method is unstable to numerical inexactness, 
-	 * like going along borders and very long lines qp
+	 * Geometric predicates are exact, so the walk is stable to
+	 * numerical inexactness, like going along borders and very long lines qp
 	 */
 	template<typename Predicate>
 	static std::vector<CellHandle> cellsAlongSegment(
@@ -80,8 +80,8 @@ public:
 	 * Point q must lie inside the cell t (the search starts from t).
 	 * The search accepts only "valid" cells in terms of given predicate:
 	 * if meet a not "valid" cell, the search is stopped.
-	 * This method is more stable to numerical inexactness,
-	 * because it starts from inside of cell not from a vertex
+	 * Used as a fallback when the walk from the vertex doesn't find
+	 * the cell (e.g, the ray crosses the grid border)
 	 */
 	template<typename Predicate>
 	static std::vector<CellHandle> cellsAlongSegment(
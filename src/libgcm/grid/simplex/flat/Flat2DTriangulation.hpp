@@ -0,0 +1,183 @@
+#ifndef LIBGCM_FLAT2DTRIANGULATION_HPP
+#define LIBGCM_FLAT2DTRIANGULATION_HPP
+
+#include <libgcm/grid/simplex/flat/FlatTriangulationStorage.hpp>
+
+
+namespace gcm {
+
+/**
+ * 2D triangulation stored in contiguous arrays.
+ * Geometrical queries are the same as in Cgal2DTriangulation.
+ * @tparam VertexInfo type of auxiliary information stored in vertices
+ * @tparam CellInfo   type of auxiliary information stored in cells
+ */
+template<typename VertexInfo, typename CellInfo>
+class Flat2DTriangulation :
+		public FlatTriangulationStorage<2, VertexInfo, CellInfo> {
+public:
+	typedef FlatTriangulationStorage<2, VertexInfo, CellInfo> Storage;
+	typedef typename Storage::VertexHandle                    VertexHandle;
+	typedef typename Storage::CellHandle                      CellHandle;
+	typedef typename Storage::RealD                           RealD;
+	using Storage::realD;
+	
+	/// Space dimensionality
+	static const int DIMENSIONALITY = 2;
+	static const int CELL_SIZE = DIMENSIONALITY + 1;
+	/// An *estimation* of maximal possible number of vertices connected 
+	/// with some inner vertex in the grid (it can be more in a very rare cases)
+	static const int MAX_NUMBER_OF_NEIGHBOR_VERTICES = 8;
+	
+	
+	/// Indices of vertices clockwise and counterclockwise to i'th vertex
+	/// in the cell (vertices of cell are in counterclockwise order) @{
+	static int cw (const int i) { return (i + 2) % CELL_SIZE; }
+	static int ccw(const int i) { return (i + 1) % CELL_SIZE; }
+	/// @}
+	
+	
+	/**
+	 * Returns unity normal to contact surface between given cells
+	 * (must be neighbors). Direction of normal is from "from" to "to"
+	 */
+	static RealD contactNormal(const CellHandle from, const CellHandle to) {
+		const int oppositeVertexIndex = from->index(to);
+		RealD along = realD(from->vertex(cw(oppositeVertexIndex))) -
+		              realD(from->vertex(ccw(oppositeVertexIndex)));
+		return linal::normalize(
+				linal::perpendicularClockwise(along));
+	}
+	
+	
+	static real minimalCellHeight(const CellHandle ch) {
+		return linal::minimalHeight(
+				realD(ch->vertex(0)),
+				realD(ch->vertex(1)),
+				realD(ch->vertex(2)));
+	}
+	
+	
+	/** Is the cell with a small layer around contains the point */
+	static bool contains(const CellHandle ch, const RealD& q, const real eps) {
+		return linal::triangleContains(realD(ch->vertex(0)),
+				realD(ch->vertex(1)), realD(ch->vertex(2)), q, eps);
+	}
+	
+	
+	/** Is the cell is degenerate in terms of gcm::linal::isDegenerate */
+	static bool isDegenerate(const CellHandle ch, const real eps) {
+		return linal::isDegenerate(realD(ch->vertex(0)),
+				realD(ch->vertex(1)), realD(ch->vertex(2)), eps);
+	}
+	
+	
+	/**
+	 * Is the point q strictly on the other side of the face opposite
+	 * to i'th vertex of the cell than the vertex itself
+	 */
+	static bool isBehindFace(const CellHandle ch, const int i, const RealD& q) {
+		const RealD a = realD(ch->vertex(ccw(i)));
+		const RealD b = realD(ch->vertex(cw(i)));
+		return linal::orientedArea(a, b, realD(ch->vertex(i))) *
+		       linal::orientedArea(a, b, q) < 0;
+	}
+	
+	
+	/**
+	 * The face represented as a set of vertices. If the face is not crossed by
+	 * the line from start to query, return empty set, else return back given set
+	 */
+	static std::vector<VertexHandle> filterFaceNotCrossedByTheRay(
+			const std::vector<VertexHandle>& face,
+			const RealD& start, const RealD& query, const real eps) {
+		if (face.size() == 2) {
+			RealD a = realD(face[0]);
+			RealD b = realD(face[1]);
+			RealD intersection = linal::linesIntersection(a, b, start, query);
+			if (linal::segmentContains(
+					a, b, intersection, EQUALITY_TOLERANCE, eps)) {
+				return face;
+			}
+		} else if (face.size() == 1) {
+			if (linal::segmentContains(
+					start, query, realD(face[0]), EQUALITY_TOLERANCE, eps)) {
+				return face;
+			}
+		}
+		return std::vector<VertexHandle>();
+	}
+	
+	
+	/**
+	 * Returns incident to vh "valid" cell which is crossed by the ray 
+	 * from vh to query or NULL if there isn't such 
+	 * (i.e. crossed cell is not "valid")
+	 */
+	template<typename Predicate>
+	CellHandle findCrossedIncidentCell(const Predicate isValid,
+			const VertexHandle vh, const Real2 query, const real eps) const {
+		return this->findIncidentCell(vh, [&](const CellHandle candidate) {
+			if (!isValid(candidate)) { return false; }
+			VertexHandle a = otherVertex(candidate, vh, vh);
+			VertexHandle b = otherVertex(candidate, vh, a);
+			return linal::angleContains(
+					realD(vh), realD(a), realD(b), query, eps);
+		});
+	}
+	
+	
+	/**
+	 * The point q must lie inside the triangle t.
+	 * Find the edge of t which is crossed by the ray qp.
+	 * Write the result as a pair of vertices to a,b (or NULLs if not found).
+	 * Degenerate cases are not handled.
+	 */
+	static void findCrossedInsideOutFacet(
+			const CellHandle t, const Real2 q, const Real2 p,
+			VertexHandle& a, VertexHandle& b, const real eps) {
+		a = NULL; b = NULL;
+		for (int i = 0; i < CELL_SIZE; i++) {
+			VertexHandle a1 = t->vertex((i + 1) % CELL_SIZE);
+			VertexHandle b1 = t->vertex((i + 2) % CELL_SIZE);
+			if (linal::angleContains(q, realD(a1), realD(b1), p, eps)) {
+				a = a1; b = b1; break;
+			}
+		}
+	}
+	
+	
+	/** The center of the given cell */
+	static RealD center(const CellHandle t) {
+		return (realD(t->vertex(0)) + realD(t->vertex(1)) +
+		        realD(t->vertex(2))) / 3;
+	}
+	
+	
+	static int otherVertexIndex(
+			const CellHandle cell, const VertexHandle a, const VertexHandle b) {
+	/// return index of that vertex of cell, which is not a, b
+		for (int i = 0; i < CELL_SIZE; i++) {
+			VertexHandle d = cell->vertex(i);
+			if ( (d != a) && (d != b) ) { return i; }
+		}
+		THROW_BAD_MESH("Cell contains equal vertices");
+	}
+	
+	static CellHandle neighborThrough(
+			const CellHandle cell, const VertexHandle a, const VertexHandle b) {
+	/// return neighbor cell that shares with given cell vertices a, b
+		return cell->neighbor(otherVertexIndex(cell, a, b));
+	}
+	
+	static VertexHandle otherVertex(
+			const CellHandle cell, const VertexHandle a, const VertexHandle b) {
+	/// return that vertex of cell, which is not a, b
+		return cell->vertex(otherVertexIndex(cell, a, b));
+	}
+};
+
+
+}
+
+#endif // LIBGCM_FLAT2DTRIANGULATION_HPP
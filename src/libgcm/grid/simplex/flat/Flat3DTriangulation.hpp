@@ -0,0 +1,195 @@
+#ifndef LIBGCM_FLAT3DTRIANGULATION_HPP
+#define LIBGCM_FLAT3DTRIANGULATION_HPP
+
+#include <libgcm/grid/simplex/flat/FlatTriangulationStorage.hpp>
+
+
+namespace gcm {
+
+/**
+ * 3D triangulation stored in contiguous arrays.
+ * Geometrical queries are the same as in Cgal3DTriangulation.
+ * @tparam VertexInfo type of auxiliary information stored in vertices
+ * @tparam CellInfo   type of auxiliary information stored in cells
+ */
+template<typename VertexInfo, typename CellInfo>
+class Flat3DTriangulation :
+		public FlatTriangulationStorage<3, VertexInfo, CellInfo> {
+public:
+	typedef FlatTriangulationStorage<3, VertexInfo, CellInfo> Storage;
+	typedef typename Storage::VertexHandle                    VertexHandle;
+	typedef typename Storage::CellHandle                      CellHandle;
+	typedef typename Storage::RealD                           RealD;
+	using Storage::realD;
+	
+	/// Space dimensionality
+	static const int DIMENSIONALITY = 3;
+	static const int CELL_SIZE = DIMENSIONALITY + 1;
+	/// An *estimation* of maximal possible number of vertices connected 
+	/// with some inner vertex in the grid (it can be more in a very rare cases)
+	static const int MAX_NUMBER_OF_NEIGHBOR_VERTICES = 20;
+	
+	
+	/**
+	 * Returns unity normal to contact surface between given cells
+	 * (must be neighbors). Direction of normal is from "from" to "to"
+	 */
+	static RealD contactNormal(const CellHandle from, const CellHandle to) {
+		const int oppositeVertexIndex = from->index(to);
+		return linal::oppositeFaceNormal(
+				realD(from->vertex(oppositeVertexIndex)),
+				realD(from->vertex((oppositeVertexIndex + 1) % CELL_SIZE)),
+				realD(from->vertex((oppositeVertexIndex + 2) % CELL_SIZE)),
+				realD(from->vertex((oppositeVertexIndex + 3) % CELL_SIZE)));
+	}
+	
+	
+	static real minimalCellHeight(const CellHandle ch) {
+		return linal::minimalHeight(
+				realD(ch->vertex(0)),
+				realD(ch->vertex(1)),
+				realD(ch->vertex(2)),
+				realD(ch->vertex(3)));
+	}
+	
+	
+	/** Is the cell with a small layer around contains the point */
+	static bool contains(const CellHandle cell, const RealD& q, const real eps) {
+		return linal::tetrahedronContains(
+				realD(cell->vertex(0)), realD(cell->vertex(1)),
+				realD(cell->vertex(2)), realD(cell->vertex(3)), q, eps);
+	}
+	
+	
+	/** Is the cell is degenerate in terms of gcm::linal::isDegenerate */
+	static bool isDegenerate(const CellHandle ch, const real eps) {
+		return linal::isDegenerate(
+				realD(ch->vertex(0)), realD(ch->vertex(1)),
+				realD(ch->vertex(2)), realD(ch->vertex(3)), eps);
+	}
+	
+	
+	/**
+	 * Is the point q strictly on the other side of the face opposite
+	 * to i'th vertex of the cell than the vertex itself
+	 */
+	static bool isBehindFace(const CellHandle ch, const int i, const RealD& q) {
+		const RealD a = realD(ch->vertex((i + 1) % CELL_SIZE));
+		const RealD b = realD(ch->vertex((i + 2) % CELL_SIZE));
+		const RealD c = realD(ch->vertex((i + 3) % CELL_SIZE));
+		return linal::orientedVolume(a, b, c, realD(ch->vertex(i))) *
+		       linal::orientedVolume(a, b, c, q) < 0;
+	}
+	
+	
+	/**
+	 * The face represented as a set of vertices. If the face is not crossed by
+	 * the line from start to query, return empty set, else return back given set
+	 */
+	static std::vector<VertexHandle> filterFaceNotCrossedByTheRay(
+			const std::vector<VertexHandle>& face,
+			const RealD& start, const RealD& query, const real eps) {
+		if (face.size() == 3) {
+			std::vector<RealD> p = {
+				realD(face[0]), realD(face[1]), realD(face[2])
+			};
+			RealD intersection = linal::lineWithFlatIntersection(
+					p[0], p[1], p[2], start, query);
+			if (linal::triangleContains(
+					p[0], p[1], p[2], intersection, EQUALITY_TOLERANCE, eps)) {
+				return face;
+			}
+			for (size_t i = 0; i < 3; i++) {
+				for (size_t j = i + 1; j < 3; j++) {
+					if (linal::segmentContains(
+							p[i], p[j], intersection, EQUALITY_TOLERANCE, eps)) {
+						return std::vector<VertexHandle>({face[i], face[j]});
+					}
+				}
+			}
+			for (size_t i = 0; i < 3; i++) {
+				if (linal::segmentContains(start, query, p[i], EQUALITY_TOLERANCE, eps)) {
+					return std::vector<VertexHandle>({face[i]});
+				}
+			}
+		} else if (face.size() != 0) {
+			THROW_UNSUPPORTED("Unexpected variant");
+		}
+		return std::vector<VertexHandle>();
+	}
+	
+	
+	/**
+	 * Returns incident to vh "valid" cell which is crossed by the ray 
+	 * from vh to query or NULL if there isn't such 
+	 * (i.e. crossed cell is not "valid")
+	 */
+	template<typename Predicate>
+	CellHandle findCrossedIncidentCell(const Predicate isValid,
+			const VertexHandle vh, const Real3 query, const real eps) const {
+		return this->findIncidentCell(vh, [&](const CellHandle candidate) {
+			if (!isValid(candidate)) { return false; }
+			VertexHandle a = otherVertex(candidate, vh, vh, vh);
+			VertexHandle b = otherVertex(candidate, vh, vh, a);
+			VertexHandle c = otherVertex(candidate, vh, a, b);
+			return linal::solidAngleContains(
+					realD(vh), realD(a), realD(b), realD(c), query, eps);
+		});
+	}
+	
+	
+	/**
+	 * The point q must lie inside the tetrahedron t.
+	 * Find the face of t which is crossed by the ray qp.
+	 * Write the result as a triple of vertices to a,b,c.
+	 * Degenerate cases are not handled.
+	 */
+	static void findCrossedInsideOutFacet(
+			const CellHandle t, const Real3 q, const Real3 p,
+			VertexHandle& a, VertexHandle& b, VertexHandle& c, const real eps) {
+		a = NULL; b = NULL; c = NULL;
+		for (int i = 0; i < CELL_SIZE; i++) {
+			VertexHandle a1 = t->vertex((i + 1) % CELL_SIZE);
+			VertexHandle b1 = t->vertex((i + 2) % CELL_SIZE);
+			VertexHandle c1 = t->vertex((i + 3) % CELL_SIZE);
+			if (linal::solidAngleContains(q, realD(a1), realD(b1), realD(c1), p, eps)) {
+				a = a1; b = b1; c = c1; break;
+			}
+		}
+	}
+	
+	
+	/** The center of the given cell */
+	static RealD center(const CellHandle t) {
+		return (realD(t->vertex(0)) + realD(t->vertex(1)) +
+		        realD(t->vertex(2)) + realD(t->vertex(3))) / 4;
+	}
+	
+	
+	static int otherVertexIndex(const CellHandle cell,
+			const VertexHandle a, const VertexHandle b, const VertexHandle c) {
+	/// return index of that vertex of cell, which is not a, b, c
+		for (int i = 0; i < CELL_SIZE; i++) {
+			VertexHandle d = cell->vertex(i);
+			if ( (d != a) && (d != b) && (d != c) ) { return i; }
+		}
+		THROW_BAD_MESH("Cell contains equal vertices");
+	}
+	
+	static CellHandle neighborThrough(const CellHandle cell,
+			const VertexHandle a, const VertexHandle b, const VertexHandle c) {
+	/// return neighbor cell that shares with given cell vertices a, b, c
+		return cell->neighbor(otherVertexIndex(cell, a, b, c));
+	}
+	
+	static VertexHandle otherVertex(const CellHandle cell,
+			const VertexHandle a, const VertexHandle b, const VertexHandle c) {
+	/// return that vertex of cell, which is not a, b, c
+		return cell->vertex(otherVertexIndex(cell, a, b, c));
+	}
+};
+
+
+}
+
+#endif // LIBGCM_FLAT3DTRIANGULATION_HPP
@@ -0,0 +1,194 @@
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
+#include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/mesh_loaders/InmMeshLoader.hpp>
+#include <libgcm/grid/simplex/mesh_loaders/BinaryMeshLoader.hpp>
+#include <libgcm/grid/simplex/MeshSizing.hpp>
+#include <libgcm/grid/simplex/TriangulationSanitizer.hpp>
+#include <libgcm/grid/simplex/VertexInfoAndCellInfo.hpp>
+#include <libgcm/util/MappedFile.hpp>
+#include <libgcm/util/Utils.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+using namespace gcm;
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+FlatTriangulation<Dimensionality, VertexInfo, CellInfo>::
+FlatTriangulation(const Task& task) {
+	static_assert(CELL_POINTS_NUMBER == Base::CELL_SIZE, "");
+	static_assert(DIMENSIONALITY == Base::DIMENSIONALITY, "");
+	
+	const std::string& cacheDirectory = task.simplexGrid.triangulationCacheDirectory;
+	std::string cacheFileName;
+	uint64_t key = 0;
+	if (!cacheDirectory.empty() && MeshSizing(task).dependsOnAreas()) {
+		LOG_WARN("Triangulation sized by material areas is not cached");
+	} else if (!cacheDirectory.empty()) {
+		key = cacheKey(task);
+		std::ostringstream name;
+		name << cacheDirectory << "/triangulation" << (int)DIMENSIONALITY << "d_"
+				<< std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+		cacheFileName = name.str();
+	}
+	
+	readFromCache = !cacheFileName.empty() && this->readFromBinaryFile(cacheFileName, key);
+	if (readFromCache) {
+		LOG_INFO("Flat triangulation is read from cache " << cacheFileName);
+	} else {
+		if (task.simplexGrid.mesher == Task::SimplexGrid::Mesher::INM_MESHER) {
+			loadInmMesh(task.simplexGrid.fileName, task.simplexGrid.scale);
+			sanitizeMaterials();
+		} else if (task.simplexGrid.mesher == Task::SimplexGrid::Mesher::BINARY_MESHER) {
+			loadBinaryMesh(task.simplexGrid.fileName, task.simplexGrid.scale);
+			sanitizeMaterials();
+		} else {
+			/// CGAL triangulation is necessary at the construction step only
+			CgalTriangulation<Dimensionality, VertexInfo, CellInfo> cgalTriangulation(task);
+			this->copyFrom(cgalTriangulation);
+		}
+		if (!cacheFileName.empty()) {
+			this->writeToBinaryFile(cacheFileName, key);
+			LOG_INFO("Flat triangulation is written to cache " << cacheFileName);
+		}
+	}
+	
+	LOG_INFO("Flat triangulation is built: number of finite vertices = "
+			<< this->infiniteVertex << ", number of all cells = "
+			<< this->cellVertices.size());
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+void FlatTriangulation<Dimensionality, VertexInfo, CellInfo>::
+loadInmMesh(const std::string& fileName, const real scale) {
+	if (DIMENSIONALITY != InmMeshLoader::Dimensionality) {
+		THROW_UNSUPPORTED("INM meshes are three-dimensional only");
+	}
+	std::vector<Real3> inmPoints;
+	InmMeshLoader::Materials materials;
+	InmMeshLoader::readFromFile(fileName, inmPoints, materials);
+	
+	std::vector<RealD> scaledPoints(inmPoints.size());
+	for (size_t i = 0; i < scaledPoints.size(); i++) {
+		for (int j = 0; j < DIMENSIONALITY; j++) {
+			scaledPoints[i](j) = inmPoints[i](j) / scale;
+		}
+	}
+	
+	std::vector<std::array<typename Base::Index, (size_t)CELL_POINTS_NUMBER>> cells(
+			materials.size());
+	std::vector<CellInfo> infos(materials.size());
+	for (size_t c = 0; c < materials.size(); c++) {
+		/// vertices are numbered from one in INM format
+		for (size_t i = 0; i < (size_t)CELL_POINTS_NUMBER; i++) {
+			cells[c][i] = (typename Base::Index)materials[c].first[i] - 1;
+		}
+		infos[c].setGridId((GridId)materials[c].second);
+	}
+	CellInfo infiniteCellInfo;
+	infiniteCellInfo.setGridId(CellInfo::EmptySpaceFlag);
+	
+	this->buildFromCells(scaledPoints, cells, infos, infiniteCellInfo);
+	LOG_INFO("INM mesh is imported as is: " << materials.size() << " cells, "
+			<< this->cellVertices.size() - materials.size() << " border faces");
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+void FlatTriangulation<Dimensionality, VertexInfo, CellInfo>::
+loadBinaryMesh(const std::string& fileName, const real scale) {
+	const BinaryMeshLoader mesh(fileName);
+	if (mesh.dimensionality() != DIMENSIONALITY) {
+		THROW_INVALID_INPUT("Binary mesh has wrong dimensionality");
+	}
+	
+	std::vector<RealD> meshPoints(mesh.numberOfPoints());
+	for (size_t i = 0; i < meshPoints.size(); i++) {
+		for (int j = 0; j < DIMENSIONALITY; j++) {
+			meshPoints[i](j) = mesh.point(i)[j] / scale;
+		}
+	}
+	
+	std::vector<std::array<typename Base::Index, (size_t)CELL_POINTS_NUMBER>> cells(
+			mesh.numberOfCells());
+	std::vector<std::array<typename Base::Index, (size_t)CELL_POINTS_NUMBER>> neighbors(
+			mesh.hasNeighbors() ? mesh.numberOfCells() : 0);
+	std::vector<CellInfo> infos(mesh.numberOfCells());
+	for (size_t c = 0; c < cells.size(); c++) {
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			cells[c][(size_t)i] = (typename Base::Index)mesh.cellVertex(c, i);
+			if (mesh.hasNeighbors()) {
+				neighbors[c][(size_t)i] = (typename Base::Index)mesh.neighbor(c, i);
+			}
+		}
+		infos[c].setGridId(mesh.hasMaterials() ? (GridId)mesh.material(c) : 0);
+	}
+	CellInfo infiniteCellInfo;
+	infiniteCellInfo.setGridId(CellInfo::EmptySpaceFlag);
+	
+	this->buildFromCells(meshPoints, cells, infos, infiniteCellInfo,
+			mesh.hasNeighbors() ? &neighbors : nullptr);
+	LOG_INFO("Binary mesh is imported: " << cells.size() << " cells");
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+void FlatTriangulation<Dimensionality, VertexInfo, CellInfo>::
+sanitizeMaterials() {
+	std::vector<GridId> gridIds(this->cellInfos.size());
+	for (size_t c = 0; c < gridIds.size(); c++) {
+		gridIds[c] = this->cellInfos[c].getGridId();
+	}
+	TriangulationSanitizer<CELL_POINTS_NUMBER>(this->cellVertices, this->cellNeighbors,
+			this->incidentCellsOffsets, this->incidentCells, this->infiniteVertex)
+			.sanitize(gridIds);
+	for (size_t c = 0; c < gridIds.size(); c++) {
+		this->cellInfos[c].setGridId(gridIds[c]);
+	}
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+uint64_t
+FlatTriangulation<Dimensionality, VertexInfo, CellInfo>::
+cacheKey(const Task& task) {
+	const Task::SimplexGrid& settings = task.simplexGrid;
+	const int dimensionality = DIMENSIONALITY;
+	uint64_t key = Utils::hash(&dimensionality, sizeof(dimensionality));
+	auto add = [&key](const void* data, const size_t size) {
+		key = Utils::hash(data, size, key);
+	};
+	add(&settings.mesher, sizeof(settings.mesher));
+	add(&settings.spatialStep, sizeof(settings.spatialStep));
+	add(&settings.detectSharpEdges, sizeof(settings.detectSharpEdges));
+	add(&settings.scale, sizeof(settings.scale));
+	const MeshSizing sizing(task);
+	if (sizing.isWaveSpeedAware()) {
+		/// sizing by areas is not cached, so materials identify the sizing
+		const std::vector<real> materialSteps = sizing.materialSteps();
+		add(materialSteps.data(), materialSteps.size() * sizeof(real));
+	}
+	
+	if (!settings.fileName.empty()) {
+		const MappedFile input(settings.fileName);
+		if (!input.isOpen()) {
+			THROW_INVALID_INPUT("Cannot read mesher input file " + settings.fileName);
+		}
+		add(input.data(), input.size());
+	}
+	for (const Task::SimplexGrid::Body& body : settings.bodies) {
+		add(&body.id, sizeof(body.id));
+		add(body.outer.data(), body.outer.size() * sizeof(body.outer[0]));
+		for (const auto& inner : body.inner) {
+			add(inner.data(), inner.size() * sizeof(inner[0]));
+		}
+	}
+	return key;
+}
+
+
+
+template class FlatTriangulation<2, VertexInfo, CellInfoT<3>>;
+template class FlatTriangulation<3, VertexInfo, CellInfoT<4>>;
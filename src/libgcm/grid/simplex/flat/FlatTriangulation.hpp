@@ -0,0 +1,182 @@
+#ifndef LIBGCM_FLATTRIANGULATION_HPP
+#define LIBGCM_FLATTRIANGULATION_HPP
+
+#include <set>
+
+#include <libgcm/grid/simplex/flat/Flat2DTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/Flat3DTriangulation.hpp>
+#include <libgcm/util/task/Task.hpp>
+
+
+namespace gcm {
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+struct FlatTriangulationBase;
+
+template<typename VertexInfo, typename CellInfo>
+struct FlatTriangulationBase<2, VertexInfo, CellInfo> {
+	typedef Flat2DTriangulation<VertexInfo, CellInfo> type;
+};
+
+template<typename VertexInfo, typename CellInfo>
+struct FlatTriangulationBase<3, VertexInfo, CellInfo> {
+	typedef Flat3DTriangulation<VertexInfo, CellInfo> type;
+};
+
+
+/**
+ * Triangulation in Dimensionality space stored in contiguous arrays.
+ * It is built once from CgalTriangulation (thus, by any mesher supported
+ * by CgalTriangulation) and then CGAL structures are released,
+ * so calculations never touch CGAL. INM and binary meshes are imported
+ * directly. All queries are lock-free.
+ * Prepared triangulation can be cached in binary file
+ * (@see Task::SimplexGrid::triangulationCacheDirectory).
+ * Replacement of CgalTriangulation for static (not remeshed) triangulations.
+ * @tparam Dimensionality space dimensionality
+ * @tparam VertexInfo type of auxiliary information stored in vertices
+ * @tparam CellInfo   type of auxiliary information stored in cells
+ */
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+class FlatTriangulation :
+		public FlatTriangulationBase<Dimensionality, VertexInfo, CellInfo>::type {
+public:
+	
+	typedef typename FlatTriangulationBase<
+			Dimensionality, VertexInfo, CellInfo>::type Base;
+	
+	/// Some sort of pointer to triangulation vertex
+	typedef typename Base::VertexHandle                 VertexHandle;
+	/// Some sort of pointer to triangulation cell
+	typedef typename Base::CellHandle                   CellHandle;
+	
+	/// Point (Vector) in Dimensionality space
+	typedef typename Base::RealD                        RealD;
+	
+	
+	/// Space dimensionality
+	static const int DIMENSIONALITY = Dimensionality;
+	
+	/// Number of vertices in cell
+	static const int CELL_POINTS_NUMBER = DIMENSIONALITY + 1;
+	/// Number of vertices in face
+	static const int FACE_POINTS_NUMBER = DIMENSIONALITY;
+	
+	
+	/// An *estimation* of maximal possible number of vertices connected 
+	/// with some inner vertex in the grid (it can be more in a very rare cases)
+	static const int MAX_NUMBER_OF_NEIGHBOR_VERTICES =
+			Base::MAX_NUMBER_OF_NEIGHBOR_VERTICES;
+	
+	
+	/// @name iteration over all finite vertices @{
+	typedef VertexHandle VerticesIterator;
+	VerticesIterator verticesBegin() const {
+		return this->vertexHandle(0);
+	}
+	VerticesIterator verticesEnd() const {
+		return this->vertexHandle(this->infiniteVertex);
+	}
+	/// @}
+	
+	
+	FlatTriangulation(const Task& task);
+	virtual ~FlatTriangulation() { }
+	
+	
+	/** Read-only access to points coordinates */
+	static RealD coordsD(const VertexHandle vh) {
+		return Base::realD(vh);
+	}
+	
+	
+	/**
+	 * Returns common vertices of two given cells.
+	 * Optionally, fill in aHasOnly with vertices only the first one has.
+	 */
+	static std::vector<VertexHandle>
+	commonVertices(const CellHandle& a, const CellHandle& b, 
+			std::vector<VertexHandle>* aHasOnly = nullptr) {
+		
+		std::vector<VertexHandle> common;
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			VertexHandle v = a->vertex(i);
+			if (b->has_vertex(v)) {
+				common.push_back(v);
+			} else {
+				if (aHasOnly != nullptr) {
+					aHasOnly->push_back(v);
+				}
+			}
+		}
+		
+		return common;
+	}
+	
+	
+	/** 
+	 * Move specified point on specified distance
+	 * without any triangulation reconstruction
+	 */
+	void move(const VertexHandle vh, const RealD distance) {
+		this->points[(size_t)vh.getIndex()] += distance;
+	}
+	
+	
+	/** 
+	 * "Infinite" -- fixture cells on the triangulation borders. They needed
+	 * in order to keep the same topology inside triangulation and on borders.
+	 * In such cell, one vertex is "infinite" -- has no coordinates.
+	 */
+	bool isInfinite(const CellHandle c) const {
+		return c->has_vertex(this->vertexHandle(this->infiniteVertex));
+	}
+	
+	
+	std::set<GridId> incidentGridsIds(const VertexHandle vh) const {
+		std::set<GridId> ans;
+		this->findIncidentCell(vh, [&](const CellHandle ch) {
+			ans.insert(ch->info().getGridId());
+			return false;
+		});
+		return ans;
+	}
+	
+	
+	/** Whether the triangulation was read from the cache file at construction */
+	bool isReadFromCache() const { return readFromCache; }
+
+
+private:
+	bool readFromCache = false;
+	
+	/**
+	 * Import tetrahedra of INM mesh directly, without CGAL retriangulation,
+	 * so the mesh is kept exactly
+	 */
+	void loadInmMesh(const std::string& fileName, const real scale);
+	
+	/** Import cells and neighbors of the mesh in binary format directly */
+	void loadBinaryMesh(const std::string& fileName, const real scale);
+	
+	/**
+	 * Clean imported mesh from bad material cases
+	 * as CgalTriangulation does after meshing
+	 * @see TriangulationSanitizer
+	 */
+	void sanitizeMaterials();
+	
+	/**
+	 * Identifier of the mesher input: hash of the input file,
+	 * 2D bodies borders and meshing parameters
+	 */
+	static uint64_t cacheKey(const Task& task);
+	
+	USE_AND_INIT_LOGGER("gcm.FlatTriangulation")
+};
+
+
+}
+
+
+#endif // LIBGCM_FLATTRIANGULATION_HPP
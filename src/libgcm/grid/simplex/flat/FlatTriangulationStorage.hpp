@@ -0,0 +1,636 @@
+#ifndef LIBGCM_FLATTRIANGULATIONSTORAGE_HPP
+#define LIBGCM_FLATTRIANGULATIONSTORAGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <libgcm/linal/linal.hpp>
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+#include <libgcm/util/FileUtils.hpp>
+#include <libgcm/util/MappedFile.hpp>
+
+
+namespace gcm {
+
+/**
+ * Topology and geometry of a triangulation stored in contiguous arrays.
+ * Vertices and cells are addressed by integer indices, wrapped into
+ * light-weight handles with the subset of CGAL handles interface used
+ * by SimplexGrid and LineWalker. Like in CGAL, the triangulation is closed
+ * by "infinite" cells, which share the only "infinite" vertex.
+ * The i'th neighbor of a cell is opposite to its i'th vertex.
+ * @tparam Dimensionality space dimensionality
+ * @tparam VertexInfo type of auxiliary information stored in vertices
+ * @tparam CellInfo   type of auxiliary information stored in cells
+ */
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+class FlatTriangulationStorage {
+public:
+	/// Index of vertex or cell in the storage arrays
+	typedef int Index;
+	static const Index NoIndex = -1;
+	
+	/// Space dimensionality
+	static const int DIMENSIONALITY = Dimensionality;
+	static const int CELL_SIZE = DIMENSIONALITY + 1;
+	/// Point (Vector) in DIMENSIONALITY space
+	typedef linal::Vector<DIMENSIONALITY> RealD;
+	
+	
+	/**
+	 * Handle of vertex. Also serves as iterator over vertices.
+	 * Like CGAL handles, it gives write access to the vertex info
+	 * regardless of its own constness.
+	 */
+	class VertexHandle {
+	public:
+		VertexHandle(std::nullptr_t = nullptr) : owner(nullptr), id(NoIndex) { }
+		VertexHandle(FlatTriangulationStorage* owner_, const Index index_) :
+				owner(owner_), id(index_) { }
+		
+		const VertexHandle* operator->() const { return this; }
+		
+		VertexInfo& info() const {
+			return owner->vertexInfos[(size_t)id];
+		}
+		
+		const RealD& point() const {
+			return owner->points[(size_t)id];
+		}
+		
+		Index getIndex() const { return id; }
+		
+		VertexHandle& operator++() { ++id; return *this; }
+		
+		bool operator==(const VertexHandle& other) const { return id == other.id; }
+		bool operator!=(const VertexHandle& other) const { return id != other.id; }
+		bool operator< (const VertexHandle& other) const { return id <  other.id; }
+	
+	private:
+		FlatTriangulationStorage* owner;
+		Index id;
+		friend class FlatTriangulationStorage;
+	};
+	
+	
+	/**
+	 * Handle of cell. Also serves as iterator over cells.
+	 * Like CGAL handles, it gives write access to the cell info
+	 * regardless of its own constness.
+	 */
+	class CellHandle {
+	public:
+		CellHandle(std::nullptr_t = nullptr) : owner(nullptr), id(NoIndex) { }
+		CellHandle(FlatTriangulationStorage* owner_, const Index index_) :
+				owner(owner_), id(index_) { }
+		
+		const CellHandle* operator->() const { return this; }
+		
+		CellInfo& info() const {
+			return owner->cellInfos[(size_t)id];
+		}
+		
+		VertexHandle vertex(const int i) const {
+			return VertexHandle(owner, owner->cellVertices[(size_t)id][(size_t)i]);
+		}
+		
+		CellHandle neighbor(const int i) const {
+			return CellHandle(owner, owner->cellNeighbors[(size_t)id][(size_t)i]);
+		}
+		
+		/** Index in the cell of the given vertex (must be in the cell) */
+		int index(const VertexHandle& vh) const {
+			const auto& vertices = owner->cellVertices[(size_t)id];
+			for (int i = 0; i < CELL_SIZE; i++) {
+				if (vertices[(size_t)i] == vh.id) { return i; }
+			}
+			THROW_BAD_MESH("The cell has no such vertex");
+		}
+		
+		/** Index in the cell of the given neighbor (must be a neighbor) */
+		int index(const CellHandle& neighborCell) const {
+			const auto& neighbors = owner->cellNeighbors[(size_t)id];
+			for (int i = 0; i < CELL_SIZE; i++) {
+				if (neighbors[(size_t)i] == neighborCell.id) { return i; }
+			}
+			THROW_BAD_MESH("The cell has no such neighbor");
+		}
+		
+		bool has_vertex(const VertexHandle& vh) const {
+			const auto& vertices = owner->cellVertices[(size_t)id];
+			for (int i = 0; i < CELL_SIZE; i++) {
+				if (vertices[(size_t)i] == vh.id) { return true; }
+			}
+			return false;
+		}
+		
+		Index getIndex() const { return id; }
+		
+		CellHandle& operator++() { ++id; return *this; }
+		
+		bool operator==(const CellHandle& other) const { return id == other.id; }
+		bool operator!=(const CellHandle& other) const { return id != other.id; }
+		bool operator< (const CellHandle& other) const { return id <  other.id; }
+	
+	private:
+		FlatTriangulationStorage* owner;
+		Index id;
+		friend class FlatTriangulationStorage;
+	};
+	
+	typedef CellHandle AllCellsIterator;
+	
+	
+	/** All cells (including infinite ones) iteration begin */
+	AllCellsIterator allCellsBegin() const { return cellHandle(0); }
+	/** All cells (including infinite ones) iteration end */
+	AllCellsIterator allCellsEnd() const {
+		return cellHandle((Index)cellVertices.size());
+	}
+	
+	
+	/**
+	 * Returns all incident to vh cells (including infinite ones).
+	 * The order is the same as it was in the source triangulation.
+	 * @threadsafe
+	 */
+	std::vector<CellHandle> allIncidentCells(const VertexHandle vh) const {
+		std::vector<CellHandle> ans;
+		ans.reserve(numberOfIncidentCells(vh));
+		for (Index i = incidentCellsBegin(vh); i < incidentCellsEnd(vh); i++) {
+			ans.push_back(cellHandle(incidentCells[(size_t)i]));
+		}
+		return ans;
+	}
+	
+	
+	static CellHandle someCellOfVertex(const VertexHandle vh) {
+		const FlatTriangulationStorage* s = vh.owner;
+		return s->cellHandle(s->incidentCells[(size_t)s->incidentCellsBegin(vh)]);
+	}
+	
+	
+	/// @name convertion to gcm data types
+	/// @{
+	static RealD realD(const VertexHandle vh) {
+		return vh->point();
+	}
+	
+	static RealD realD(const RealD& r) {
+		return r;
+	}
+	/// @}
+	
+	
+	/**
+	 * Read the whole topology and geometry of CGAL triangulation
+	 * (or any other triangulation with the same interface)
+	 */
+	template<typename SourceTriangulation>
+	void copyFrom(const SourceTriangulation& source);
+	
+	
+	/**
+	 * Build the storage from the given finite cells as is, without any
+	 * retriangulation. Neighbors are found by matching equal faces.
+	 * Faces which belong to the only cell are closed by infinite cells.
+	 * Points not used by any cell are dropped.
+	 * @param sourcePoints coordinates of vertices
+	 * @param sourceCells indices of cells vertices in sourcePoints
+	 * @param sourceInfos infos of cells
+	 * @param infiniteCellInfo info of all infinite cells
+	 * @param sourceNeighbors optional precomputed neighbors of cells
+	 * (NoIndex on the border), then only border faces are matched
+	 */
+	void buildFromCells(const std::vector<RealD>& sourcePoints,
+			const std::vector<std::array<Index, (size_t)CELL_SIZE>>& sourceCells,
+			const std::vector<CellInfo>& sourceInfos, const CellInfo& infiniteCellInfo,
+			const std::vector<std::array<Index, (size_t)CELL_SIZE>>* sourceNeighbors = nullptr);
+	
+	
+	/**
+	 * Write the whole storage to the binary file
+	 * in order to read it later instead of copying from the source again
+	 * @param key identifier of the source (e.g, hash of the mesher input)
+	 */
+	void writeToBinaryFile(const std::string& fileName, const uint64_t key) const;
+	
+	/**
+	 * Read the storage written by writeToBinaryFile with the same key.
+	 * The file is memory mapped, so it is not parsed, but just copied.
+	 * @return false if there isn't such file or it has other key,
+	 * version or data types
+	 */
+	bool readFromBinaryFile(const std::string& fileName, const uint64_t key);
+
+
+protected:
+	/// Data storage @{
+	/// coordinates of finite vertices, the last one is the infinite vertex
+	std::vector<RealD> points;
+	std::vector<VertexInfo> vertexInfos;
+	/// index of the only infinite vertex
+	Index infiniteVertex = NoIndex;
+	
+	std::vector<std::array<Index, (size_t)CELL_SIZE>> cellVertices;
+	std::vector<std::array<Index, (size_t)CELL_SIZE>> cellNeighbors;
+	std::vector<CellInfo> cellInfos;
+	
+	/// incident cells of the vertex v are stored in incidentCells
+	/// between incidentCellsOffsets[v] and incidentCellsOffsets[v + 1]
+	std::vector<Index> incidentCellsOffsets;
+	std::vector<Index> incidentCells;
+	/// @}
+	
+	
+	/// Header of the binary file @{
+	static const uint32_t BINARY_FILE_VERSION = 1;
+	struct BinaryFileHeader {
+		char signature[8];
+		uint32_t version;
+		uint32_t dimensionality;
+		uint32_t sizeOfReal;
+		uint32_t sizeOfVertexInfo;
+		uint32_t sizeOfCellInfo;
+		Index infiniteVertex;
+		uint64_t key;
+		uint64_t numberOfPoints;
+		uint64_t numberOfCells;
+		uint64_t numberOfIncidentCells;
+	};
+	BinaryFileHeader binaryFileHeader(const uint64_t key) const;
+	/// @}
+	
+	
+	VertexHandle vertexHandle(const Index index) const {
+		return VertexHandle(const_cast<FlatTriangulationStorage*>(this), index);
+	}
+	
+	CellHandle cellHandle(const Index index) const {
+		return CellHandle(const_cast<FlatTriangulationStorage*>(this), index);
+	}
+	
+	Index incidentCellsBegin(const VertexHandle vh) const {
+		return incidentCellsOffsets[(size_t)vh.id];
+	}
+	
+	Index incidentCellsEnd(const VertexHandle vh) const {
+		return incidentCellsOffsets[(size_t)vh.id + 1];
+	}
+	
+	size_t numberOfIncidentCells(const VertexHandle vh) const {
+		return (size_t)(incidentCellsEnd(vh) - incidentCellsBegin(vh));
+	}
+	
+	/**
+	 * Find neighbors through all faces of cells from begin to end
+	 * which have no neighbors yet. Faces are bucketed by their minimal vertex,
+	 * so the search is linear in the number of cells.
+	 * @param manifold if true, a face of more than two cells is an error,
+	 * else such faces are matched in pairs
+	 * @return faces which are not matched as (cell, index of opposite vertex)
+	 */
+	std::vector<std::pair<Index, int>> matchFaces(
+			const Index begin, const Index end, const bool manifold);
+	
+	/**
+	 * Iterate over incident to vh cells without allocations
+	 * @param visitor functor returns true to stop the iteration
+	 * @return the cell the iteration stopped at, or NULL
+	 */
+	template<typename Visitor>
+	CellHandle findIncidentCell(const VertexHandle vh, const Visitor visitor) const {
+		for (Index i = incidentCellsBegin(vh); i < incidentCellsEnd(vh); i++) {
+			const CellHandle candidate = cellHandle(incidentCells[(size_t)i]);
+			if (visitor(candidate)) { return candidate; }
+		}
+		return NULL;
+	}
+};
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+template<typename SourceTriangulation>
+void FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+copyFrom(const SourceTriangulation& source) {
+	typedef typename SourceTriangulation::VertexHandle SourceVertexHandle;
+	typedef typename SourceTriangulation::CellHandle   SourceCellHandle;
+	
+	/// finite vertices are numbered in the order of source iteration
+	std::map<SourceVertexHandle, Index> vertexIndices;
+	points.clear();
+	for (auto v = source.verticesBegin(); v != source.verticesEnd(); ++v) {
+		const SourceVertexHandle vh = v;
+		vertexIndices.insert({vh, (Index)points.size()});
+		points.push_back(source.coordsD(vh));
+	}
+	infiniteVertex = (Index)points.size();
+	points.push_back(RealD::Zeros());
+	vertexInfos.assign(points.size(), VertexInfo());
+	
+	std::map<SourceCellHandle, Index> cellIndices;
+	for (auto c = source.allCellsBegin(); c != source.allCellsEnd(); ++c) {
+		const SourceCellHandle ch = c;
+		cellIndices.insert({ch, (Index)cellIndices.size()});
+	}
+	
+	cellVertices.resize(cellIndices.size());
+	cellNeighbors.resize(cellIndices.size());
+	cellInfos.resize(cellIndices.size());
+	for (const auto& cell : cellIndices) {
+		const size_t index = (size_t)cell.second;
+		for (int i = 0; i < CELL_SIZE; i++) {
+			const auto vertex = vertexIndices.find(cell.first->vertex(i));
+			cellVertices[index][(size_t)i] = (vertex == vertexIndices.end()) ?
+					infiniteVertex : vertex->second;
+			cellNeighbors[index][(size_t)i] = cellIndices.at(cell.first->neighbor(i));
+		}
+		cellInfos[index] = cell.first->info();
+	}
+	
+	incidentCellsOffsets.assign(points.size() + 1, 0);
+	incidentCells.clear();
+	for (auto v = source.verticesBegin(); v != source.verticesEnd(); ++v) {
+		const SourceVertexHandle vh = v;
+		const size_t index = (size_t)vertexIndices.at(vh);
+		for (const SourceCellHandle ch : source.allIncidentCells(vh)) {
+			incidentCells.push_back(cellIndices.at(ch));
+		}
+		incidentCellsOffsets[index + 1] = (Index)incidentCells.size();
+	}
+	/// the infinite vertex has no list of incident cells
+	incidentCellsOffsets.back() = (Index)incidentCells.size();
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+void FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+buildFromCells(const std::vector<RealD>& sourcePoints,
+		const std::vector<std::array<Index, (size_t)CELL_SIZE>>& sourceCells,
+		const std::vector<CellInfo>& sourceInfos, const CellInfo& infiniteCellInfo,
+		const std::vector<std::array<Index, (size_t)CELL_SIZE>>* sourceNeighbors) {
+	assert_eq(sourceCells.size(), sourceInfos.size());
+	
+	/// used points are numbered in the order of source points
+	std::vector<Index> vertexIndices(sourcePoints.size(), NoIndex);
+	for (const auto& cell : sourceCells) {
+		for (const Index v : cell) {
+			if (v < 0 || (size_t)v >= sourcePoints.size()) {
+				THROW_BAD_MESH("Cell vertex index is out of range");
+			}
+			vertexIndices[(size_t)v] = 0;
+		}
+	}
+	points.clear();
+	for (size_t v = 0; v < sourcePoints.size(); v++) {
+		if (vertexIndices[v] == NoIndex) { continue; }
+		vertexIndices[v] = (Index)points.size();
+		points.push_back(sourcePoints[v]);
+	}
+	infiniteVertex = (Index)points.size();
+	points.push_back(RealD::Zeros());
+	vertexInfos.assign(points.size(), VertexInfo());
+	
+	const Index numberOfFiniteCells = (Index)sourceCells.size();
+	cellVertices.resize(sourceCells.size());
+	std::array<Index, (size_t)CELL_SIZE> noNeighbors;
+	noNeighbors.fill(NoIndex);
+	if (sourceNeighbors != nullptr) {
+		assert_eq(sourceNeighbors->size(), sourceCells.size());
+		cellNeighbors = *sourceNeighbors;
+		for (size_t c = 0; c < cellNeighbors.size(); c++) {
+			for (const Index n : cellNeighbors[c]) {
+				if (n == NoIndex) { continue; }
+				if (n < 0 || n >= numberOfFiniteCells || std::count(
+						cellNeighbors[(size_t)n].begin(), cellNeighbors[(size_t)n].end(),
+						(Index)c) != 1) {
+					THROW_BAD_MESH("Wrong neighbors of cells are given");
+				}
+			}
+		}
+	} else {
+		cellNeighbors.assign(sourceCells.size(), noNeighbors);
+	}
+	cellInfos = sourceInfos;
+	for (size_t c = 0; c < sourceCells.size(); c++) {
+		for (size_t i = 0; i < (size_t)CELL_SIZE; i++) {
+			cellVertices[c][i] = vertexIndices[(size_t)sourceCells[c][i]];
+			for (size_t j = 0; j < i; j++) {
+				if (cellVertices[c][i] == cellVertices[c][j]) {
+					THROW_BAD_MESH("Cell contains equal vertices");
+				}
+			}
+		}
+	}
+	
+	/// close the border by infinite cells: the infinite vertex
+	/// is the 0'th one, so the 0'th neighbor is the finite cell
+	const auto borderFaces = matchFaces(0, numberOfFiniteCells, true);
+	for (const auto& face : borderFaces) {
+		const Index cell = (Index)cellVertices.size();
+		std::array<Index, (size_t)CELL_SIZE> vertices;
+		vertices[0] = infiniteVertex;
+		for (int i = 1; i < CELL_SIZE; i++) {
+			vertices[(size_t)i] = cellVertices[(size_t)face.first]
+					[(size_t)((face.second + i) % CELL_SIZE)];
+		}
+		cellVertices.push_back(vertices);
+		cellNeighbors.push_back(noNeighbors);
+		cellNeighbors.back()[0] = face.first;
+		cellNeighbors[(size_t)face.first][(size_t)face.second] = cell;
+		cellInfos.push_back(infiniteCellInfo);
+	}
+	/// bodies touching by edges share some faces of infinite cells
+	if (!matchFaces(numberOfFiniteCells, (Index)cellVertices.size(), false).empty()) {
+		THROW_BAD_MESH("The border of the mesh is not closed");
+	}
+	
+	/// CSR storage of incident cells, the infinite vertex has no list
+	incidentCellsOffsets.assign(points.size() + 1, 0);
+	for (const auto& vertices : cellVertices) {
+		for (const Index v : vertices) {
+			if (v != infiniteVertex) { incidentCellsOffsets[(size_t)v + 1]++; }
+		}
+	}
+	for (size_t v = 0; v + 1 < points.size(); v++) {
+		incidentCellsOffsets[v + 1] += incidentCellsOffsets[v];
+	}
+	incidentCellsOffsets.back() = incidentCellsOffsets[points.size() - 1];
+	incidentCells.resize((size_t)incidentCellsOffsets.back());
+	std::vector<Index> filled(incidentCellsOffsets.begin(), incidentCellsOffsets.end() - 1);
+	for (size_t c = 0; c < cellVertices.size(); c++) {
+		for (const Index v : cellVertices[c]) {
+			if (v != infiniteVertex) { incidentCells[(size_t)filled[(size_t)v]++] = (Index)c; }
+		}
+	}
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+std::vector<std::pair<typename FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::Index, int>>
+FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+matchFaces(const Index begin, const Index end, const bool manifold) {
+	const size_t cellSize = CELL_SIZE;
+	typedef std::array<Index, (size_t)CELL_SIZE - 1> Face;
+	/// face is encoded as cell * cellSize + index of the opposite vertex
+	auto faceVertices = [&](const size_t code) {
+		const auto& cell = cellVertices[code / cellSize];
+		Face ans;
+		for (size_t i = 1; i < cellSize; i++) {
+			ans[i - 1] = cell[(code + i) % cellSize];
+		}
+		std::sort(ans.begin(), ans.end());
+		return ans;
+	};
+	
+	/// CSR storage of faces without neighbors by minimal vertex
+	std::vector<size_t> bucketsOffsets(points.size() + 1, 0);
+	for (size_t code = (size_t)begin * cellSize; code < (size_t)end * cellSize; code++) {
+		if (cellNeighbors[code / cellSize][code % cellSize] != NoIndex) { continue; }
+		bucketsOffsets[(size_t)faceVertices(code)[0] + 1]++;
+	}
+	for (size_t b = 0; b < points.size(); b++) {
+		bucketsOffsets[b + 1] += bucketsOffsets[b];
+	}
+	std::vector<size_t> faces(bucketsOffsets.back());
+	std::vector<size_t> filled(bucketsOffsets.begin(), bucketsOffsets.end() - 1);
+	for (size_t code = (size_t)begin * cellSize; code < (size_t)end * cellSize; code++) {
+		if (cellNeighbors[code / cellSize][code % cellSize] != NoIndex) { continue; }
+		faces[filled[(size_t)faceVertices(code)[0]]++] = code;
+	}
+	
+	/// buckets are independent, so they are processed in parallel;
+	/// equal faces become adjacent after sorting of the bucket
+	std::vector<char> isMatched(faces.size(), false);
+	bool isManifold = true;
+	#pragma omp parallel for schedule(dynamic, 1024) reduction(&&:isManifold)
+	for (size_t b = 0; b < points.size(); b++) {
+		std::vector<std::pair<Face, size_t>> bucket;
+		for (size_t f = bucketsOffsets[b]; f < bucketsOffsets[b + 1]; f++) {
+			bucket.push_back({faceVertices(faces[f]), f});
+		}
+		std::sort(bucket.begin(), bucket.end());
+		for (size_t i = 0; i + 1 < bucket.size(); i++) {
+			if (bucket[i].first != bucket[i + 1].first) { continue; }
+			if (manifold && i + 2 < bucket.size() &&
+					bucket[i].first == bucket[i + 2].first) {
+				isManifold = false;
+			}
+			const size_t a = faces[bucket[i].second], c = faces[bucket[i + 1].second];
+			cellNeighbors[a / cellSize][a % cellSize] = (Index)(c / cellSize);
+			cellNeighbors[c / cellSize][c % cellSize] = (Index)(a / cellSize);
+			isMatched[bucket[i].second] = isMatched[bucket[i + 1].second] = true;
+			++i;
+		}
+	}
+	if (!isManifold) {
+		THROW_BAD_MESH("There is a face shared by more than two cells");
+	}
+	
+	std::vector<std::pair<Index, int>> unmatched;
+	for (size_t f = 0; f < faces.size(); f++) {
+		if (!isMatched[f]) {
+			unmatched.push_back({(Index)(faces[f] / cellSize), (int)(faces[f] % cellSize)});
+		}
+	}
+	return unmatched;
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+typename FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::BinaryFileHeader
+FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+binaryFileHeader(const uint64_t key) const {
+	BinaryFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.signature, "GCMFLAT", 8);
+	header.version = BINARY_FILE_VERSION;
+	header.dimensionality = (uint32_t)DIMENSIONALITY;
+	header.sizeOfReal = (uint32_t)sizeof(real);
+	header.sizeOfVertexInfo = (uint32_t)sizeof(VertexInfo);
+	header.sizeOfCellInfo = (uint32_t)sizeof(CellInfo);
+	header.infiniteVertex = infiniteVertex;
+	header.key = key;
+	header.numberOfPoints = points.size();
+	header.numberOfCells = cellVertices.size();
+	header.numberOfIncidentCells = incidentCells.size();
+	return header;
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+void FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+writeToBinaryFile(const std::string& fileName, const uint64_t key) const {
+	/// the file appears under its name only when completely written,
+	/// so simultaneous runs never read a partial file
+	const std::string temporaryFileName = fileName + ".tmp";
+	std::ofstream file;
+	FileUtils::openBinaryFileStream(file, temporaryFileName);
+	const BinaryFileHeader header = binaryFileHeader(key);
+	FileUtils::writeArrayToBinaryFileStream(file, &header, 1);
+	FileUtils::writeStdVectorToBinaryFileStream(file, points);
+	FileUtils::writeStdVectorToBinaryFileStream(file, vertexInfos);
+	FileUtils::writeStdVectorToBinaryFileStream(file, cellVertices);
+	FileUtils::writeStdVectorToBinaryFileStream(file, cellNeighbors);
+	FileUtils::writeStdVectorToBinaryFileStream(file, cellInfos);
+	FileUtils::writeStdVectorToBinaryFileStream(file, incidentCellsOffsets);
+	FileUtils::writeStdVectorToBinaryFileStream(file, incidentCells);
+	FileUtils::closeFileStream(file);
+	const int renamed = std::rename(temporaryFileName.c_str(), fileName.c_str());
+	if (renamed != 0) {
+		THROW_INVALID_INPUT("Failed to rename " + temporaryFileName + " to " + fileName);
+	}
+}
+
+
+template<int Dimensionality, typename VertexInfo, typename CellInfo>
+bool FlatTriangulationStorage<Dimensionality, VertexInfo, CellInfo>::
+readFromBinaryFile(const std::string& fileName, const uint64_t key) {
+	const MappedFile file(fileName);
+	if (!file.isOpen()) { return false; }
+	MappedFile::Reader reader(file);
+	
+	BinaryFileHeader header;
+	if (!reader.read(&header)) { return false; }
+	/// all fields except sizes must be the same as for empty storage
+	BinaryFileHeader expected = FlatTriangulationStorage().binaryFileHeader(key);
+	expected.infiniteVertex = header.infiniteVertex;
+	expected.numberOfPoints = header.numberOfPoints;
+	expected.numberOfCells = header.numberOfCells;
+	expected.numberOfIncidentCells = header.numberOfIncidentCells;
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0) { return false; }
+	
+	const size_t numberOfPoints = (size_t)header.numberOfPoints;
+	const size_t numberOfCells = (size_t)header.numberOfCells;
+	points.resize(numberOfPoints);
+	vertexInfos.resize(numberOfPoints);
+	cellVertices.resize(numberOfCells);
+	cellNeighbors.resize(numberOfCells);
+	cellInfos.resize(numberOfCells);
+	incidentCellsOffsets.resize(numberOfPoints + 1);
+	incidentCells.resize((size_t)header.numberOfIncidentCells);
+	const bool ok =
+			reader.read(points.data(), points.size()) &&
+			reader.read(vertexInfos.data(), vertexInfos.size()) &&
+			reader.read(cellVertices.data(), cellVertices.size()) &&
+			reader.read(cellNeighbors.data(), cellNeighbors.size()) &&
+			reader.read(cellInfos.data(), cellInfos.size()) &&
+			reader.read(incidentCellsOffsets.data(), incidentCellsOffsets.size()) &&
+			reader.read(incidentCells.data(), incidentCells.size()) &&
+			reader.finished();
+	if (!ok) {
+		THROW_INVALID_INPUT("Corrupted triangulation binary file " + fileName);
+	}
+	infiniteVertex = header.infiniteVertex;
+	return true;
+}
+
+
+}
+
+#endif // LIBGCM_FLATTRIANGULATIONSTORAGE_HPP
@@ -0,0 +1,247 @@
+#ifndef LIBGCM_BINARYMESHLOADER_HPP
+#define LIBGCM_BINARYMESHLOADER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <libgcm/util/FileUtils.hpp>
+#include <libgcm/util/MappedFile.hpp>
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+
+
+namespace gcm {
+
+/**
+ * Compact binary format of unstructured simplex meshes (2D or 3D).
+ * The file consists of sections, each one is aligned by 8 bytes:
+ *  - header;
+ *  - coordinates of points, float64[numberOfPoints][dimensionality];
+ *  - vertices of cells, int32 or int64[numberOfCells][dimensionality + 1];
+ *  - optional materials of cells, int32[numberOfCells];
+ *  - optional neighbors of cells, the same type as vertices
+ *    [numberOfCells][dimensionality + 1], i'th neighbor is opposite
+ *    to i'th vertex, NoNeighbor on the border.
+ * Indices are zero-based. The file is memory mapped and read in place.
+ */
+class BinaryMeshLoader {
+public:
+	typedef int64_t Index;
+	static const Index NoNeighbor = -1;
+	
+	static const uint32_t VERSION = 1;
+	static const uint32_t HAS_MATERIALS = 1;
+	static const uint32_t HAS_NEIGHBORS = 2;
+	
+	struct Header {
+		char signature[8];
+		uint32_t version;
+		uint32_t dimensionality;
+		uint32_t sizeOfIndex;
+		uint32_t flags;
+		uint64_t numberOfPoints;
+		uint64_t numberOfCells;
+	};
+	
+	
+	/** Map the file and check its header and size */
+	explicit BinaryMeshLoader(const std::string& fileName) : file(fileName) {
+		if (!file.isOpen() || file.size() < sizeof(Header)) {
+			THROW_INVALID_INPUT("Cannot read binary mesh file " + fileName);
+		}
+		std::memcpy(&header, file.data(), sizeof(Header));
+		if (std::memcmp(header.signature, "GCMMESH", 8) != 0 ||
+				header.version != VERSION ||
+				(header.dimensionality != 2 && header.dimensionality != 3) ||
+				(header.sizeOfIndex != 4 && header.sizeOfIndex != 8)) {
+			THROW_INVALID_INPUT("Wrong header of binary mesh file " + fileName);
+		}
+		
+		size_t offset = aligned(sizeof(Header));
+		pointsOffset = offset;
+		offset += aligned(numberOfPoints() * (size_t)dimensionality() * sizeof(double));
+		cellsOffset = offset;
+		offset += aligned(numberOfCells() * (size_t)cellSize() * header.sizeOfIndex);
+		materialsOffset = offset;
+		if (hasMaterials()) {
+			offset += aligned(numberOfCells() * sizeof(int32_t));
+		}
+		neighborsOffset = offset;
+		if (hasNeighbors()) {
+			offset += aligned(numberOfCells() * (size_t)cellSize() * header.sizeOfIndex);
+		}
+		if (offset != file.size()) {
+			THROW_INVALID_INPUT("Wrong size of binary mesh file " + fileName);
+		}
+	}
+	
+	
+	int dimensionality() const { return (int)header.dimensionality; }
+	int cellSize() const { return dimensionality() + 1; }
+	size_t numberOfPoints() const { return (size_t)header.numberOfPoints; }
+	size_t numberOfCells() const { return (size_t)header.numberOfCells; }
+	bool hasMaterials() const { return (header.flags & HAS_MATERIALS) != 0; }
+	bool hasNeighbors() const { return (header.flags & HAS_NEIGHBORS) != 0; }
+	
+	/** Coordinates of the point (dimensionality() numbers) */
+	const double* point(const size_t p) const {
+		return reinterpret_cast<const double*>(file.data() + pointsOffset) +
+				p * (size_t)dimensionality();
+	}
+	
+	Index cellVertex(const size_t c, const int i) const {
+		return index(cellsOffset, c * (size_t)cellSize() + (size_t)i);
+	}
+	
+	int material(const size_t c) const {
+		assert_true(hasMaterials());
+		return reinterpret_cast<const int32_t*>(file.data() + materialsOffset)[c];
+	}
+	
+	Index neighbor(const size_t c, const int i) const {
+		assert_true(hasNeighbors());
+		return index(neighborsOffset, c * (size_t)cellSize() + (size_t)i);
+	}
+	
+	
+	/**
+	 * Write the mesh to the binary file.
+	 * Indices are written as int32 if possible.
+	 * @param points coordinates of points one by one
+	 * @param cells vertices of cells one by one
+	 * @param materials materials of cells or empty
+	 * @param neighbors neighbors of cells one by one or empty
+	 */
+	static void write(const std::string& fileName, const int dimensionality,
+			const std::vector<double>& points, const std::vector<Index>& cells,
+			const std::vector<int>& materials, const std::vector<Index>& neighbors) {
+		const size_t cellSize = (size_t)dimensionality + 1;
+		assert_eq(points.size() % (size_t)dimensionality, 0);
+		assert_eq(cells.size() % cellSize, 0);
+		
+		Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.signature, "GCMMESH", 8);
+		header.version = VERSION;
+		header.dimensionality = (uint32_t)dimensionality;
+		header.numberOfPoints = points.size() / (size_t)dimensionality;
+		header.numberOfCells = cells.size() / cellSize;
+		const bool isSmall =
+				header.numberOfPoints < (uint64_t)std::numeric_limits<int32_t>::max() &&
+				header.numberOfCells < (uint64_t)std::numeric_limits<int32_t>::max();
+		header.sizeOfIndex = isSmall ? 4 : 8;
+		if (!materials.empty()) {
+			assert_eq(materials.size(), header.numberOfCells);
+			header.flags |= HAS_MATERIALS;
+		}
+		if (!neighbors.empty()) {
+			assert_eq(neighbors.size(), cells.size());
+			header.flags |= HAS_NEIGHBORS;
+		}
+		
+		std::ofstream stream;
+		FileUtils::openBinaryFileStream(stream, fileName);
+		writeSection(stream, &header, 1);
+		writeSection(stream, points.data(), points.size());
+		writeIndices(stream, cells, isSmall);
+		if (!materials.empty()) {
+			const std::vector<int32_t> materials32(materials.begin(), materials.end());
+			writeSection(stream, materials32.data(), materials32.size());
+		}
+		if (!neighbors.empty()) {
+			writeIndices(stream, neighbors, isSmall);
+		}
+		FileUtils::closeFileStream(stream);
+	}
+	
+	
+	/**
+	 * Write finite cells of the triangulation with FlatTriangulation
+	 * interface to the binary file. Grid ids of cells are written
+	 * as materials, neighbors are precomputed.
+	 */
+	template<typename Triangulation>
+	static void write(const std::string& fileName, const Triangulation& triangulation) {
+		const int dimensionality = Triangulation::DIMENSIONALITY;
+		const int cellSize = Triangulation::CELL_POINTS_NUMBER;
+		
+		std::vector<double> points;
+		for (auto v = triangulation.verticesBegin(); v != triangulation.verticesEnd(); ++v) {
+			assert_eq((size_t)v.getIndex(), points.size() / (size_t)dimensionality);
+			const auto coords = triangulation.coordsD(v);
+			for (int i = 0; i < dimensionality; i++) {
+				points.push_back(coords(i));
+			}
+		}
+		
+		/// infinite cells are dropped, so finite ones are renumbered
+		const size_t numberOfAllCells = (size_t)triangulation.allCellsEnd().getIndex();
+		std::vector<Index> finiteIndices(numberOfAllCells, NoNeighbor);
+		Index numberOfCells = 0;
+		for (auto c = triangulation.allCellsBegin(); c != triangulation.allCellsEnd(); ++c) {
+			if (!triangulation.isInfinite(c)) {
+				finiteIndices[(size_t)c.getIndex()] = numberOfCells++;
+			}
+		}
+		
+		std::vector<Index> cells, neighbors;
+		std::vector<int> materials;
+		for (auto c = triangulation.allCellsBegin(); c != triangulation.allCellsEnd(); ++c) {
+			if (triangulation.isInfinite(c)) { continue; }
+			for (int i = 0; i < cellSize; i++) {
+				cells.push_back(c->vertex(i).getIndex());
+				neighbors.push_back(finiteIndices[(size_t)c->neighbor(i).getIndex()]);
+			}
+			materials.push_back((int)c->info().getGridId());
+		}
+		
+		write(fileName, dimensionality, points, cells, materials, neighbors);
+	}
+
+
+private:
+	MappedFile file;
+	Header header;
+	size_t pointsOffset, cellsOffset, materialsOffset, neighborsOffset;
+	
+	
+	static size_t aligned(const size_t size) {
+		return (size + 7) / 8 * 8;
+	}
+	
+	Index index(const size_t offset, const size_t k) const {
+		const char* const data = file.data() + offset;
+		if (header.sizeOfIndex == 4) {
+			return reinterpret_cast<const int32_t*>(data)[k];
+		}
+		return reinterpret_cast<const int64_t*>(data)[k];
+	}
+	
+	/** Write the array and pad it by zeros up to the alignment */
+	template<typename T>
+	static void writeSection(std::ofstream& stream, const T* array, const size_t size) {
+		if (size == 0) { return; }
+		FileUtils::writeArrayToBinaryFileStream(stream, array, size);
+		const size_t bytes = size * sizeof(T);
+		const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		if (aligned(bytes) != bytes) {
+			FileUtils::writeArrayToBinaryFileStream(stream, zeros, aligned(bytes) - bytes);
+		}
+	}
+	
+	static void writeIndices(std::ofstream& stream,
+			const std::vector<Index>& indices, const bool isSmall) {
+		if (isSmall) {
+			const std::vector<int32_t> indices32(indices.begin(), indices.end());
+			writeSection(stream, indices32.data(), indices32.size());
+		} else {
+			writeSection(stream, indices.data(), indices.size());
+		}
+	}
+};
+
+
+}
+
+#endif // LIBGCM_BINARYMESHLOADER_HPP
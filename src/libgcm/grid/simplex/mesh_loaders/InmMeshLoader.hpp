@@ -3,7 +3,9 @@
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 
-#include <libgcm/util/FileUtils.hpp>
+#include <chrono>
+
+#include <libgcm/util/MappedFile.hpp>
 #include <libgcm/util/StringUtils.hpp>
 #include <libgcm/linal/linal.hpp>
 #include <libgcm/util/infrastructure/infrastructure.hpp>
@@ -23,8 +25,9 @@ public:
 	typedef linal::Vector<Dimensionality>            Point;
 	typedef std::array<size_t, NumberOfCellVertices> Cell;
 	typedef int                                      Material;
+	/// Cells (with sorted vertices) and their materials sorted by cells
+	typedef std::vector<std::pair<Cell, Material>>  Materials;
 	
-	static const char delimiter = ' ';
 	static const size_t EmptyMaterialFlag = (size_t)(-1);
 	
 	
@@ -35,17 +38,27 @@ public:
 	 */
 	template<typename Triangulation>
 	static void load(const std::string fileName, Triangulation& triangulation) {
-		typedef typename Triangulation::Vertex_handle  VertexHandle;
-		typedef typename Triangulation::Cell_handle    CellHandle;
-		
 		std::vector<Real3> points;
-		std::map<Cell, Material> materials;
+		Materials materials;
 		
 		USE_AND_INIT_LOGGER("InmMeshLoader")
 		LOG_INFO("Start reading from file \"" << fileName << "\" ...");
 		readFromFile(fileName, points, materials);
+		load(points, materials, triangulation);
+	}
+	
+	
+	/**
+	 * Load given points and cells into CGAL 3D triangulation.
+	 * @param materials are sorted, vertices are numbered from one
+	 */
+	template<typename Triangulation>
+	static void load(const std::vector<Real3>& points, const Materials& materials,
+			Triangulation& triangulation) {
+		typedef typename Triangulation::Vertex_handle  VertexHandle;
+		typedef typename Triangulation::Cell_handle    CellHandle;
 		
-		
+		USE_AND_INIT_LOGGER("InmMeshLoader")
 		LOG_INFO("Start adding points ...");
 		CellHandle insertHint = CellHandle();
 		for (size_t i = 0; i < points.size(); i++) {
@@ -73,10 +86,10 @@ public:
 			};
 			std::sort(inmCell.begin(), inmCell.end());
 			
-			const auto material = materials.find(inmCell);
-			if (material != materials.end()) {
+			const Material* material = findMaterial(materials, inmCell);
+			if (material != nullptr) {
 				++matchCounter;
-				size_t materialId = (size_t)(*material).second;
+				size_t materialId = (size_t)(*material);
 				cell->info().setGridId(materialId);
 			}
 			
@@ -93,78 +106,182 @@ public:
 	}
 	
 	
+	/**
+	 * Read points and cells with materials from the file.
+	 * The file is memory mapped and parsed by chunks of lines in parallel.
+	 */
 	static void readFromFile(const std::string fileName,
-			std::vector<Real3>& points,
-			std::map<Cell, Material>& materials) {
-		points.clear();
-		materials.clear();
+			std::vector<Real3>& points, Materials& materials) {
+		USE_AND_INIT_LOGGER("InmMeshLoader")
+		const auto t1 = std::chrono::high_resolution_clock::now();
 		
-		std::ifstream input;
-		FileUtils::openTextFileStream(input, fileName);
+		const MappedFile file(fileName);
+		if (!file.isOpen()) {
+			THROW_INVALID_INPUT("Cannot read INM mesh file " + fileName);
+		}
+		const Lines lines(file.data(), file.data() + file.size());
 		
-		readPoints(input, points);
-		readCells(input, materials);
-		checkEndOfFile(input);
+		/// file format: number of points, points, number of cells,
+		/// cells with materials, zero
+		const size_t numberOfPoints = readNumber(lines, 0);
+		assert_ge(numberOfPoints, NumberOfCellVertices);
+		const size_t numberOfCells = readNumber(lines, numberOfPoints + 1);
+		assert_ge(numberOfCells, 1);
+		const size_t lastLine = numberOfPoints + numberOfCells + 2;
+		if (readNumber(lines, lastLine) != 0) {
+			THROW_INVALID_INPUT("INM mesh file must be ended by zero line");
+		}
+		
+		points.resize(numberOfPoints);
+		materials.resize(numberOfCells);
+		const size_t badLine = lines.parse([&](const size_t line,
+				const char* begin, const char* end) -> bool {
+			if (line >= 1 && line <= numberOfPoints) {
+				double coords[Dimensionality];
+				for (int i = 0; i < Dimensionality; i++) {
+					if (!StringUtils::parse(begin, end, coords[i])) { return false; }
+				}
+				points[line - 1] = {(real)coords[0], (real)coords[1], (real)coords[2]};
+			} else if (line >= numberOfPoints + 2 && line < lastLine) {
+				auto& cell = materials[line - numberOfPoints - 2];
+				for (size_t j = 0; j < NumberOfCellVertices; j++) {
+					if (!StringUtils::parse(begin, end, cell.first[j])) { return false; }
+				}
+				if (!StringUtils::parse(begin, end, cell.second)) { return false; }
+				std::sort(cell.first.begin(), cell.first.end()); // sort to simplify search later
+			} else if (line > lastLine) {
+				return StringUtils::isEndOfLine(begin, end); // only empty lines
+			} else {
+				return true; // header lines are already read
+			}
+			return StringUtils::isEndOfLine(begin, end);
+		});
+		if (badLine != Lines::NoLine) {
+			THROW_INVALID_INPUT("Wrong format of INM mesh file at line " +
+					std::to_string(badLine + 1));
+		}
+		
+		std::stable_sort(materials.begin(), materials.end(),
+				[](const std::pair<Cell, Material>& a, const std::pair<Cell, Material>& b) {
+						return a.first < b.first; });
+		/// like insertion into std::map, the first material of repeated cell wins
+		materials.erase(std::unique(materials.begin(), materials.end(),
+				[](const std::pair<Cell, Material>& a, const std::pair<Cell, Material>& b) {
+						return a.first == b.first; }), materials.end());
 		
-		FileUtils::closeFileStream(input);
+		const auto t2 = std::chrono::high_resolution_clock::now();
+		const real seconds = (real)std::chrono::duration_cast<
+				std::chrono::microseconds>(t2 - t1).count() / 1e6;
+		const real megabytes = (real)file.size() / (1 << 20);
+		SUPPRESS_WUNUSED(seconds); SUPPRESS_WUNUSED(megabytes);
+		LOG_INFO("Parsed " << megabytes << " MB in " << seconds << " s, throughput "
+				<< megabytes / std::max(seconds, (real)1e-6) << " MB/s");
 	}
 	
 	
-private:
-	static void readPoints(std::ifstream& input, std::vector<Real3>& points) {
-		std::string numberOfPointsStr;
-		std::getline(input, numberOfPointsStr);
-		assert_eq(StringUtils::split(numberOfPointsStr, delimiter).size(), 1);
-		size_t numberOfPoints = std::stoul(numberOfPointsStr);
-		assert_ge(numberOfPoints, NumberOfCellVertices);
-		
-		points.reserve(numberOfPoints);
-		for (size_t i = 0; i < numberOfPoints; i++) {
-			std::string pointStr;
-			std::getline(input, pointStr);
-			
-			const auto coords = StringUtils::split(pointStr, delimiter);
-			assert_eq(coords.size(), Dimensionality);
-			
-			real x = std::stod(coords[0]);
-			real y = std::stod(coords[1]);
-			real z = std::stod(coords[2]);
-			points.push_back(Real3({x, y, z}));
-		}
+	/**
+	 * Material of the cell (with sorted vertices) or nullptr if not found
+	 */
+	static const Material* findMaterial(const Materials& materials, const Cell& cell) {
+		const auto found = std::lower_bound(materials.begin(), materials.end(), cell,
+				[](const std::pair<Cell, Material>& a, const Cell& b) {
+						return a.first < b; });
+		if (found == materials.end() || found->first != cell) { return nullptr; }
+		return &found->second;
 	}
 	
 	
-	static void readCells(std::ifstream& input, std::map<Cell, Material>& materials) {
-		std::string numberOfCellsStr;
-		std::getline(input, numberOfCellsStr);
-		assert_eq(StringUtils::split(numberOfCellsStr, delimiter).size(), 1);
-		size_t numberOfCells = std::stoul(numberOfCellsStr);
-		assert_ge(numberOfCells, 1);
+private:
+	/**
+	 * Text split into chunks of whole lines for parallel processing.
+	 * Lines are numbered from zero.
+	 */
+	class Lines {
+	public:
+		static const size_t NoLine = (size_t)(-1);
 		
-		for (size_t i = 0; i < numberOfCells; i++) {
-			std::string cellStr;
-			std::getline(input, cellStr);
-			
-			const auto cellStrs = StringUtils::split(cellStr, delimiter);
-			assert_eq(cellStrs.size(), NumberOfCellVertices + 1);
-			
-			Cell cell;
-			for (size_t j = 0; j < NumberOfCellVertices; j++) {
-				cell[j] = std::stoul(cellStrs[j]);
+		Lines(const char* begin, const char* end_) : textEnd(end_) {
+			/// chunks are small enough to balance the load among threads
+			const size_t chunkSize = 1 << 20;
+			const size_t numberOfChunks = (size_t)(textEnd - begin) / chunkSize + 1;
+			chunksBegins.push_back(begin);
+			for (size_t i = 1; i < numberOfChunks; i++) {
+				const char* const previous = chunksBegins.back();
+				const char* approximate = begin + std::min(i * chunkSize, (size_t)(textEnd - begin));
+				approximate = std::max(approximate, previous);
+				const char* const chunkBegin = (approximate == begin) ?
+						begin : StringUtils::nextLine(approximate - 1, textEnd);
+				if (chunkBegin != previous) { chunksBegins.push_back(chunkBegin); }
 			}
-			std::sort(cell.begin(), cell.end()); // sort to simplify search later
-			Material material = std::stoi(cellStrs[NumberOfCellVertices]);
+			chunksBegins.push_back(textEnd);
 			
-			materials.insert({cell, material});
+			/// number of the first line of each chunk
+			const size_t size = chunksBegins.size() - 1;
+			firstLines.assign(size + 1, 0);
+			#pragma omp parallel for schedule(dynamic)
+			for (size_t i = 0; i < size; i++) {
+				firstLines[i + 1] = (size_t)std::count(
+						chunksBegins[i], chunksBegins[i + 1], '\n');
+			}
+			for (size_t i = 0; i < size; i++) {
+				firstLines[i + 1] += firstLines[i];
+			}
 		}
-	}
+		
+		const char* end() const { return textEnd; }
+		
+		/** Beginning of the line or nullptr if there isn't such line */
+		const char* line(const size_t number) const {
+			const size_t chunk = std::min(chunksBegins.size() - 2, (size_t)(std::upper_bound(
+					firstLines.begin(), firstLines.end(), number) - firstLines.begin()) - 1);
+			const char* ans = chunksBegins[chunk];
+			for (size_t i = firstLines[chunk]; i < number && ans != textEnd; i++) {
+				ans = StringUtils::nextLine(ans, textEnd);
+			}
+			return (ans == textEnd) ? nullptr : ans;
+		}
+		
+		/**
+		 * Call parser(lineNumber, lineBegin, fileEnd) for all lines in parallel
+		 * @return number of the first line parser returned false for, or NoLine
+		 */
+		template<typename Parser>
+		size_t parse(const Parser parser) const {
+			const size_t size = chunksBegins.size() - 1;
+			std::vector<size_t> badLines(size, NoLine);
+			#pragma omp parallel for schedule(dynamic)
+			for (size_t i = 0; i < size; i++) {
+				size_t number = firstLines[i];
+				for (const char* p = chunksBegins[i]; p != chunksBegins[i + 1];
+						p = StringUtils::nextLine(p, textEnd), ++number) {
+					if (!parser(number, p, textEnd)) {
+						badLines[i] = number;
+						break;
+					}
+				}
+			}
+			return *std::min_element(badLines.begin(), badLines.end());
+		}
+	
+	private:
+		const char* const textEnd;
+		std::vector<const char*> chunksBegins;
+		std::vector<size_t> firstLines;
+	};
 	
 	
-	static void checkEndOfFile(std::ifstream& input) {
-		std::string zeroLine; // end of file
-		std::getline(input, zeroLine);
-		assert_eq(StringUtils::split(zeroLine, delimiter).size(), 1);
-		assert_eq(std::stoi(zeroLine), 0);
+	/** Read the line consisting of the only non-negative integer */
+	static size_t readNumber(const Lines& lines, const size_t number) {
+		const char* begin = lines.line(number);
+		const char* const end = (begin == nullptr) ? nullptr :
+				StringUtils::nextLine(begin, lines.end());
+		size_t ans = 0;
+		if (begin == nullptr || !StringUtils::parse(begin, end, ans) ||
+				!StringUtils::isEndOfLine(begin, end)) {
+			THROW_INVALID_INPUT("Wrong format of INM mesh file at line " +
+					std::to_string(number + 1));
+		}
+		return ans;
 	}
 	
 	
@@ -5,6 +5,7 @@
 #include <vector>
 #include <iostream>
 #include <cmath>
+#include <cstddef>
 
 #include <libgcm/util/infrastructure/infrastructure.hpp>
 #include <libgcm/linal/Symmetry.hpp>
@@ -92,6 +93,78 @@ private:
 };
 
 
+/**
+ * Matrix values container aligned and padded to whole aligned blocks.
+ * The alignment is the fundamental one (alignof(std::max_align_t)),
+ * because in C++11 operator new doesn't guarantee any stronger alignment,
+ * so matrices with it would be misaligned in std::vector.
+ * Padding elements are not used by the generic matrix operations,
+ * the explicit kernels for the 5x5 and 9x9 matrix * vector products
+ * are in operators.hpp.
+ * @tparam TSize size of storage
+ * @tparam TElement type of stored elements
+ */
+template<int TSize, typename TElement>
+struct AlignedContainer {
+	
+	typedef TElement ElementType;
+	
+	static const int ALIGNMENT = (int)alignof(std::max_align_t);
+	/// number of elements in one aligned block
+	static const int BLOCK_SIZE = ((int)sizeof(TElement) < ALIGNMENT) ?
+			ALIGNMENT / (int)sizeof(TElement) : 1;
+	/// size of storage including padding
+	static const int PADDED_SIZE = (TSize + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+	
+	/// @name Construction and assignment @{
+	
+	AlignedContainer() = default;
+	
+	AlignedContainer(const AlignedContainer& orig) = default;
+	
+	AlignedContainer(const std::initializer_list<TElement>& list) {
+		assert_eq(TSize, list.size());
+		std::copy(list.begin(), list.end(), values);
+	}
+	
+	/** Conversion from any container of the same size */
+	template<template<int, typename> class TContainer2, typename TElement2>
+	AlignedContainer(const TContainer2<TSize, TElement2>& orig) {
+		for (int i = 0; i < TSize; i++) {
+			(*this)(i) = static_cast<TElement>(orig(i));
+		}
+	}
+	
+	AlignedContainer& operator=(const AlignedContainer& m2) = default;
+	
+	template<template<int, typename> class TContainer2, typename TElement2>
+	AlignedContainer& operator=(const TContainer2<TSize, TElement2>& orig) {
+		return (*this) = AlignedContainer(orig);
+	}
+	
+	/// @}
+	
+	/// @name Access to array elements @{
+	/** Read-only access */
+	TElement operator()(const int i) const {
+		return values[i];
+	}
+	
+	/** Read/write access */
+	TElement& operator()(const int i) {
+		return values[i];
+	}
+	
+	/** Aligned storage for kernels */
+	const TElement* data() const { return values; }
+	TElement* data() { return values; }
+	///@}
+
+private:
+	alignas(ALIGNMENT) TElement values[PADDED_SIZE]; ///< the storage
+};
+
+
 /**
  * Base class for matrices.
  * @tparam TM number of rows
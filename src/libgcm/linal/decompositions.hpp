@@ -0,0 +1,333 @@
+#ifndef LIBGCM_LINAL_DECOMPOSITIONS_HPP
+#define LIBGCM_LINAL_DECOMPOSITIONS_HPP
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <libgcm/linal/Matrix.hpp>
+
+namespace gcm {
+namespace linal {
+
+/*
+ * Matrix decompositions of fixed size. Sizes are known at compile time,
+ * so the heap is never used, and one decomposition can be applied
+ * to any number of right parts. Right parts can have non-scalar elements
+ * (e.g, VECTOR of PdeVectors) to solve for all of their components at once.
+ */
+
+
+/**
+ * LU decomposition with partial pivoting \f$ P A = L U \f$ of NxN matrix
+ * for linear systems, inversion and determinant
+ */
+template<int N>
+class LuDecomposition {
+public:
+	template<typename TSymmetry, template<int, typename> class TContainer>
+	LuDecomposition(const MatrixBase<N, N, real, TSymmetry, TContainer>& A) {
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j < N; j++) {
+				lu(i, j) = A(i, j);
+			}
+		}
+		
+		for (int k = 0; k < N; k++) {
+			int pivot = k;
+			for (int i = k + 1; i < N; i++) {
+				if (std::fabs(lu(i, k)) > std::fabs(lu(pivot, k))) { pivot = i; }
+			}
+			permutation[k] = pivot;
+			if (pivot != k) {
+				for (int j = 0; j < N; j++) { std::swap(lu(k, j), lu(pivot, j)); }
+				signum = -signum;
+			}
+			if (lu(k, k) == 0) {
+				singular = true;
+				continue;
+			}
+			for (int i = k + 1; i < N; i++) {
+				lu(i, k) /= lu(k, k);
+				for (int j = k + 1; j < N; j++) {
+					lu(i, j) -= lu(i, k) * lu(k, j);
+				}
+			}
+		}
+	}
+	
+	bool isSingular() const { return singular; }
+	
+	real determinant() const {
+		real ans = signum;
+		for (int i = 0; i < N; i++) { ans *= lu(i, i); }
+		return ans;
+	}
+	
+	/** Solve SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$ */
+	template<typename TElement, template<int, typename> class TContainer>
+	MatrixBase<N, 1, TElement, NonSymmetric, TContainer>
+	solve(const MatrixBase<N, 1, TElement, NonSymmetric, TContainer>& b) const {
+		if (singular) {
+			THROW_INVALID_ARG("SLE matrix is singular");
+		}
+		MatrixBase<N, 1, TElement, NonSymmetric, TContainer> x = b;
+		for (int k = 0; k < N; k++) {
+			if (permutation[k] != k) { std::swap(x(k), x(permutation[k])); }
+		}
+		for (int i = 1; i < N; i++) {
+			for (int j = 0; j < i; j++) {
+				x(i) -= lu(i, j) * x(j);
+			}
+		}
+		for (int i = N - 1; i >= 0; i--) {
+			for (int j = i + 1; j < N; j++) {
+				x(i) -= lu(i, j) * x(j);
+			}
+			x(i) /= lu(i, i);
+		}
+		return x;
+	}
+	
+	/** @return \f$ \matrix{A}^{-1} \f$ */
+	template<template<int, typename> class TContainer = DefaultContainer>
+	MatrixBase<N, N, real, NonSymmetric, TContainer> inverse() const {
+		MatrixBase<N, N, real, NonSymmetric, TContainer> ans;
+		for (int j = 0; j < N; j++) {
+			Matrix<N, 1> e = Matrix<N, 1>::Zeros();
+			e(j) = 1;
+			ans.setColumn(j, solve(e));
+		}
+		return ans;
+	}
+
+
+private:
+	/// L (with unit diagonal) below the diagonal and U above and on it
+	Matrix<N, N> lu;
+	/// at k-th step rows k and permutation[k] were swapped
+	int permutation[(size_t)N];
+	int signum = 1;
+	bool singular = false;
+};
+
+
+/**
+ * Cholesky decomposition \f$ A = L L^T \f$ of NxN symmetric
+ * positive-definite matrix for linear systems.
+ * Only the lower triangle of the matrix is read.
+ */
+template<int N>
+class CholeskyDecomposition {
+public:
+	template<typename TSymmetry, template<int, typename> class TContainer>
+	CholeskyDecomposition(const MatrixBase<N, N, real, TSymmetry, TContainer>& A) {
+		for (int j = 0; j < N; j++) {
+			real d = A(j, j);
+			for (int k = 0; k < j; k++) { d -= L(j, k) * L(j, k); }
+			if (!(d > 0)) {
+				positiveDefinite = false;
+				return;
+			}
+			L(j, j) = std::sqrt(d);
+			for (int i = j + 1; i < N; i++) {
+				real s = A(i, j);
+				for (int k = 0; k < j; k++) { s -= L(i, k) * L(j, k); }
+				L(i, j) = s / L(j, j);
+			}
+		}
+	}
+	
+	bool isPositiveDefinite() const { return positiveDefinite; }
+	
+	/** Solve SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$ */
+	template<typename TElement, template<int, typename> class TContainer>
+	MatrixBase<N, 1, TElement, NonSymmetric, TContainer>
+	solve(const MatrixBase<N, 1, TElement, NonSymmetric, TContainer>& b) const {
+		if (!positiveDefinite) {
+			THROW_INVALID_ARG("SLE matrix is not positive-definite");
+		}
+		MatrixBase<N, 1, TElement, NonSymmetric, TContainer> x = b;
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j < i; j++) {
+				x(i) -= L(i, j) * x(j);
+			}
+			x(i) /= L(i, i);
+		}
+		for (int i = N - 1; i >= 0; i--) {
+			for (int j = i + 1; j < N; j++) {
+				x(i) -= L(j, i) * x(j);
+			}
+			x(i) /= L(i, i);
+		}
+		return x;
+	}
+
+
+private:
+	/// lower triangle is used only
+	Matrix<N, N> L;
+	bool positiveDefinite = true;
+};
+
+
+/**
+ * QR decomposition \f$ A = Q R \f$ of MxN matrix, M >= N, by Householder
+ * reflections for linear least squares. Unlike normal equations,
+ * it doesn't square the condition number of the matrix.
+ */
+template<int M, int N>
+class QrDecomposition {
+public:
+	static_assert(M >= N, "The system has to be at least determined");
+	
+	template<typename TSymmetry, template<int, typename> class TContainer>
+	QrDecomposition(const MatrixBase<M, N, real, TSymmetry, TContainer>& A) {
+		for (int i = 0; i < M; i++) {
+			for (int j = 0; j < N; j++) {
+				qr(i, j) = A(i, j);
+			}
+		}
+		
+		for (int k = 0; k < N; k++) {
+			real norm = 0;
+			for (int i = k; i < M; i++) { norm += qr(i, k) * qr(i, k); }
+			norm = std::sqrt(norm);
+			if (norm == 0) {
+				fullRank = false;
+				return;
+			}
+			/// reflection of the column to alpha * e_k,
+			/// v = column - alpha * e_k, where v_i = qr(i, k) for i > k
+			const real alpha = (qr(k, k) > 0) ? -norm : norm;
+			v0[k] = qr(k, k) - alpha;
+			tau[k] = -1 / (alpha * v0[k]); // 2 / (v, v)
+			qr(k, k) = alpha;
+			for (int j = k + 1; j < N; j++) {
+				real s = v0[k] * qr(k, j);
+				for (int i = k + 1; i < M; i++) { s += qr(i, k) * qr(i, j); }
+				s *= tau[k];
+				qr(k, j) -= s * v0[k];
+				for (int i = k + 1; i < M; i++) { qr(i, j) -= s * qr(i, k); }
+			}
+		}
+	}
+	
+	bool isFullRank() const { return fullRank; }
+	
+	/**
+	 * Solve overdetermined SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$
+	 * in terms of least square deviation
+	 */
+	template<typename TElement, template<int, typename> class TContainer>
+	MatrixBase<N, 1, TElement, NonSymmetric, TContainer>
+	solve(const MatrixBase<M, 1, TElement, NonSymmetric, TContainer>& b) const {
+		if (!fullRank) {
+			THROW_INVALID_ARG("SLE matrix is rank-deficient");
+		}
+		/// apply Q^T to b
+		MatrixBase<M, 1, TElement, NonSymmetric, TContainer> y = b;
+		for (int k = 0; k < N; k++) {
+			TElement s = y(k);
+			s *= v0[k];
+			for (int i = k + 1; i < M; i++) { s += qr(i, k) * y(i); }
+			s *= tau[k];
+			y(k) -= v0[k] * s;
+			for (int i = k + 1; i < M; i++) { y(i) -= qr(i, k) * s; }
+		}
+		/// solve R x = (Q^T b)[0:N]
+		MatrixBase<N, 1, TElement, NonSymmetric, TContainer> x;
+		for (int i = N - 1; i >= 0; i--) {
+			x(i) = y(i);
+			for (int j = i + 1; j < N; j++) {
+				x(i) -= qr(i, j) * x(j);
+			}
+			x(i) /= qr(i, i);
+		}
+		return x;
+	}
+
+
+private:
+	/// R above and on the diagonal, reflection vectors below
+	Matrix<M, N> qr;
+	/// diagonal elements of reflection vectors and their 2 / (v, v)
+	real v0[(size_t)N], tau[(size_t)N];
+	bool fullRank = true;
+};
+
+
+/**
+ * Eigen decomposition \f$ A = V \Lambda V^T \f$ of NxN symmetric matrix
+ * by cyclic Jacobi rotations. Eigenvectors are orthonormal even
+ * for close or multiple eigenvalues.
+ * Only the lower triangle of the matrix is read.
+ */
+template<int N>
+class SymmetricEigenDecomposition {
+public:
+	template<typename TSymmetry, template<int, typename> class TContainer>
+	SymmetricEigenDecomposition(const MatrixBase<N, N, real, TSymmetry, TContainer>& A) {
+		Matrix<N, N> a;
+		real norm = 0;
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j <= i; j++) {
+				a(i, j) = a(j, i) = A(i, j);
+				norm += a(i, j) * a(i, j);
+			}
+		}
+		V = Matrix<N, N>::Identity();
+		const real eps = std::numeric_limits<real>::epsilon();
+		
+		for (int sweep = 0; sweep < MAX_SWEEPS; sweep++) {
+			real offDiagonal = 0;
+			for (int p = 0; p < N; p++) {
+				for (int q = p + 1; q < N; q++) { offDiagonal += a(p, q) * a(p, q); }
+			}
+			if (offDiagonal <= eps * eps * norm) { break; }
+			
+			for (int p = 0; p < N; p++) {
+				for (int q = p + 1; q < N; q++) {
+					if (a(p, q) == 0) { continue; }
+					/// rotation in (p, q) plane which zeroes a(p, q)
+					const real theta = (a(q, q) - a(p, p)) / (2 * a(p, q));
+					const real t = ((theta < 0) ? -1 : 1) /
+							(std::fabs(theta) + std::sqrt(theta * theta + 1));
+					const real c = 1 / std::sqrt(t * t + 1), s = t * c;
+					for (int k = 0; k < N; k++) {
+						rotate(a(k, p), a(k, q), c, s);
+						rotate(V(k, p), V(k, q), c, s);
+					}
+					for (int k = 0; k < N; k++) { rotate(a(p, k), a(q, k), c, s); }
+				}
+			}
+		}
+		
+		for (int i = 0; i < N; i++) { lambda(i) = a(i, i); }
+	}
+	
+	/** @return eigenvalues in the order of eigenvectors */
+	const Matrix<N, 1>& eigenvalues() const { return lambda; }
+	
+	/** @return orthonormal eigenvectors in columns */
+	const Matrix<N, N>& eigenvectors() const { return V; }
+
+
+private:
+	static const int MAX_SWEEPS = 50;
+	
+	Matrix<N, 1> lambda;
+	Matrix<N, N> V;
+	
+	static void rotate(real& x, real& y, const real c, const real s) {
+		const real x0 = x;
+		x = c * x0 - s * y;
+		y = s * x0 + c * y;
+	}
+};
+
+
+}
+}
+
+#endif // LIBGCM_LINAL_DECOMPOSITIONS_HPP
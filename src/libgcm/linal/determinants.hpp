@@ -2,7 +2,7 @@
 #define LIBGCM_LINAL_DETERMINANT_HPP
 
 #include <libgcm/linal/Matrix.hpp>
-#include <libgcm/util/math/GslUtils.hpp>
+#include <libgcm/linal/decompositions.hpp>
 
 namespace gcm {
 namespace linal {
@@ -60,14 +60,14 @@ inline real determinant(const Matrix33& m) {
 
 
 /**
- * NxN (only for N > 3) determinant for real numbers by GSL library
+ * NxN (only for N > 3) determinant for real numbers by LU decomposition
  */
 template<int N,
          typename TSymmetry,
          template<int, typename> class TContainer>
 typename std::enable_if<(N > 3), real>::type
 determinant(const MatrixBase<N, N, real, TSymmetry, TContainer>& m) {
-	return gsl_utils::determinant(m);
+	return LuDecomposition<N>(m).determinant();
 }
 
 
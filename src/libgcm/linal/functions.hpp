@@ -5,6 +5,7 @@
 
 #include <libgcm/util/Utils.hpp>
 #include <libgcm/linal/Matrix.hpp>
+#include <libgcm/linal/decompositions.hpp>
 #include <libgcm/linal/determinants.hpp>
 
 namespace gcm {
@@ -135,7 +136,7 @@ invert(const MatrixBase<3, 3, TElement, NonSymmetric, TContainer>& m) {
 
 
 /**
- * Invert NxN matrix (only for N > 3) by GSL library
+ * Invert NxN matrix (only for N > 3) by LU decomposition
  */
 template<int N,
          typename TSymmetry,
@@ -143,7 +144,7 @@ template<int N,
 typename std::enable_if<(N > 3),
 		MatrixBase<N, N, real, TSymmetry, TContainer>>::type
 invert(const MatrixBase<N, N, real, TSymmetry, TContainer>& m) {
-	return gsl_utils::invert(m);
+	return LuDecomposition<N>(m).template inverse<TContainer>();
 }
 
 
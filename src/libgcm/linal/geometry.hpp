@@ -2,6 +2,7 @@
 #define LIBGCM_LINAL_GEOMETRY_HPP
 
 #include <libgcm/linal/linearSystems.hpp>
+#include <libgcm/linal/predicates.hpp>
 
 namespace gcm {
 namespace linal {
@@ -379,6 +380,7 @@ inline bool tetrahedronContains(
 /**
  * Does angle b-a-c (a is in the middle) contain point q inside 
  * (i.e in its minimal sector) with tolerance eps.
+ * For zero tolerance the answer is exact (@see orientation).
  *           b/
  *  outside  /
  *          /
@@ -388,6 +390,12 @@ inline bool tetrahedronContains(
  */
 inline bool angleContains(const Real2& a, const Real2& b, const Real2& c,
 		const Real2& q, const real eps) {
+	if (eps == 0) {
+		const int angle = orientation(a, b, c);
+		return angle != 0 &&
+				orientation(a, b, q) * angle >= 0 &&
+				orientation(a, c, q) * angle <= 0;
+	}
 	Real3 lambda = barycentricCoordinates(a, b, c, q);
 	return lambda(0) <= 1 + eps && 
 			lambda(1) >= -eps && lambda(2) >= -eps;
@@ -397,6 +405,7 @@ inline bool angleContains(const Real2& a, const Real2& b, const Real2& c,
 /**
  * Does solid angle a-{b-c-d} (a is in the center) contain point q inside
  * (i.e in its minimal sector) with tolerance eps.
+ * For zero tolerance the answer is exact (@see orientation).
  *           b/
  *  outside  /
  *          /
@@ -410,6 +419,14 @@ inline bool angleContains(const Real2& a, const Real2& b, const Real2& c,
 inline bool solidAngleContains(
 		const Real3& a, const Real3& b, const Real3& c, const Real3& d,
 		const Real3& q, const real eps) {
+	if (eps == 0) {
+		/// orientations of {a, c, d, b} and {a, d, b, c} are the same
+		const int angle = orientation(a, b, c, d);
+		return angle != 0 &&
+				orientation(a, b, c, q) * angle >= 0 &&
+				orientation(a, c, d, q) * angle >= 0 &&
+				orientation(a, d, b, q) * angle >= 0;
+	}
 	Real4 lambda = barycentricCoordinates(a, b, c, d, q);
 	return lambda(0) <= 1 + eps && 
 			lambda(1) >= -eps && lambda(2) >= -eps && lambda(3) >= -eps;
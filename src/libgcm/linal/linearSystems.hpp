@@ -2,6 +2,7 @@
 #define LIBGCM_LINAL_LINEARSYSTEMS_HPP
 
 #include <libgcm/linal/Matrix.hpp>
+#include <libgcm/linal/decompositions.hpp>
 #include <libgcm/linal/determinants.hpp>
 #include <libgcm/linal/functions.hpp>
 
@@ -10,7 +11,7 @@ namespace linal {
 
 /** 
  * Solve SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$
- * with NxN non-symmetric matrix (only for N > 3)
+ * with NxN non-symmetric matrix (only for N > 3) by LU decomposition
  */
 template<int N,
          typename TVectorElement,
@@ -28,7 +29,7 @@ solveLinearSystem(const MatrixBase<N, N,
                   const MatrixBase<N, 1,
                                    TVectorElement,
                                    NonSymmetric, TVectorContainer>& b) {
-	return gsl_utils::solveLinearSystem(A, b);
+	return LuDecomposition<N>(A).solve(b);
 }
 
 
@@ -129,15 +130,53 @@ solveLinearSystem(const MatrixBase<3, 3,
 }
 
 
+/** 
+ * Solve SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$ with NxN symmetric
+ * positive-definite matrix by Cholesky decomposition (only for N > 3)
+ */
+template<int N,
+         typename TVectorElement,
+         template<int, typename> class TVectorContainer,
+         template<int, typename> class TMatrixContainer>
+typename std::enable_if<(N > 3),
+		MatrixBase<N, 1, TVectorElement, NonSymmetric, TVectorContainer>>::type
+solvePositiveDefiniteLinearSystem(
+		const MatrixBase<N, N, real, NonSymmetric, TMatrixContainer>& A,
+		const MatrixBase<N, 1, TVectorElement, NonSymmetric, TVectorContainer>& b) {
+	return CholeskyDecomposition<N>(A).solve(b);
+}
+
+
+/** 
+ * Solve SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$ with NxN symmetric
+ * positive-definite matrix (for N <= 3 Cramer's rule is faster)
+ */
+template<int N,
+         typename TVectorElement,
+         template<int, typename> class TVectorContainer,
+         template<int, typename> class TMatrixContainer>
+typename std::enable_if<(N <= 3),
+		MatrixBase<N, 1, TVectorElement, NonSymmetric, TVectorContainer>>::type
+solvePositiveDefiniteLinearSystem(
+		const MatrixBase<N, N, real, NonSymmetric, TMatrixContainer>& A,
+		const MatrixBase<N, 1, TVectorElement, NonSymmetric, TVectorContainer>& b) {
+	return solveLinearSystem(A, b);
+}
+
+
 /** 
  * Solve overdetermined SLE \f$ \matrix{A} * \vec{x} = \vec{b} \f$
  * with TMxTN-matrix A, TM-vector b and TN-vector x, where TM >= TN,
  * by the Linear Least Squares Method with weight matrix W.
+ * Normal equations \f$ A^T W A x = A^T W b \f$ are assembled
+ * without temporary matrices and solved as positive-definite SLE.
+ * Rows with zero weight are skipped.
  * @param A matrix of SLE
  * @param b right part of SLE
  * @param W diagonal matrix of weights in linear least squares method,
  * W(i) determines the importance of the i-th row of the SLE
  * @return solution of the SLE in terms of least square deviation
+ * @see QrDecomposition for ill-conditioned systems
  */
 template<int TM, int TN,
          typename TVectorElement,
@@ -154,7 +193,29 @@ linearLeastSquares(
 				MatrixBase<TM, TM, TMatrixElement, Diagonal, TMatrixContainer>::Identity()) {
 	
 	static_assert(TM >= TN, "The system has to be at least determined");
-	return solveLinearSystem(transposeMultiply(A, W * A), transposeMultiply(A, W * b));
+	typedef MatrixBase<TN, 1,
+			typename std::remove_cv<decltype(TVectorElement() / TMatrixElement())>::type,
+			NonSymmetric, TVectorContainer> Answer;
+	
+	Matrix<TN, TN> normalMatrix = Matrix<TN, TN>::Zeros();
+	Answer normalRightPart = Answer::Zeros();
+	for (int k = 0; k < TM; k++) {
+		if (W(k) == 0) { continue; }
+		for (int i = 0; i < TN; i++) {
+			const real weightedA = W(k) * A(k, i);
+			for (int j = 0; j <= i; j++) {
+				normalMatrix(i, j) += weightedA * A(k, j);
+			}
+			normalRightPart(i) += weightedA * b(k);
+		}
+	}
+	for (int i = 0; i < TN; i++) {
+		for (int j = i + 1; j < TN; j++) {
+			normalMatrix(i, j) = normalMatrix(j, i);
+		}
+	}
+	
+	return solvePositiveDefiniteLinearSystem(normalMatrix, normalRightPart);
 }
 
 
@@ -123,6 +123,44 @@ operator*(const MatrixBase<TM, TN, TElement1, TSymmetry1, TContainer1>& m1,
 }
 
 
+/// @name Explicit kernels of matrix * vector products with aligned storage,
+/// the sizes of PdeVectors of 2D and 3D elastic models @{
+template<int TM>
+using AlignedSquareMatrix = MatrixBase<TM, TM, real, NonSymmetric, AlignedContainer>;
+template<int TM>
+using AlignedVector = MatrixBase<TM, 1, real, NonSymmetric, AlignedContainer>;
+
+inline AlignedVector<5>
+operator*(const AlignedSquareMatrix<5>& m, const AlignedVector<5>& v) {
+	AlignedVector<5> result;
+	const real* __restrict a = static_cast<const real*>(
+			__builtin_assume_aligned(m.data(), AlignedVector<5>::ALIGNMENT));
+	const real* __restrict x = static_cast<const real*>(
+			__builtin_assume_aligned(v.data(), AlignedVector<5>::ALIGNMENT));
+	real* __restrict r = result.data();
+	for (int i = 0; i < 5; i++, a += 5) {
+		r[i] = a[0] * x[0] + a[1] * x[1] + a[2] * x[2] + a[3] * x[3] + a[4] * x[4];
+	}
+	return result;
+}
+
+inline AlignedVector<9>
+operator*(const AlignedSquareMatrix<9>& m, const AlignedVector<9>& v) {
+	AlignedVector<9> result;
+	const real* __restrict a = static_cast<const real*>(
+			__builtin_assume_aligned(m.data(), AlignedVector<9>::ALIGNMENT));
+	const real* __restrict x = static_cast<const real*>(
+			__builtin_assume_aligned(v.data(), AlignedVector<9>::ALIGNMENT));
+	real* __restrict r = result.data();
+	for (int i = 0; i < 9; i++, a += 9) {
+		r[i] = a[0] * x[0] + a[1] * x[1] + a[2] * x[2] + a[3] * x[3] +
+		       a[4] * x[4] + a[5] * x[5] + a[6] * x[6] + a[7] * x[7] + a[8] * x[8];
+	}
+	return result;
+}
+/// @}
+
+
 /**
  * Computes product of two matrices C = m1 * m2, where m2 is diagonal (faster)
  * m1: TMxTN.
@@ -257,9 +295,12 @@ typename std::enable_if<std::is_arithmetic<Number>::value,
 operator/(const MatrixBase<TM, TN, TElement, TSymmetry, TContainer>& m,
           const Number& x) {
 	typedef MatrixBase<TM, TN, TElement, TSymmetry, TContainer> ResultMatrixT;
+	/// non-scalar elements (e.g, VECTOR of PdeVectors) are divided by the number as is
+	typedef typename std::conditional<std::is_arithmetic<TElement>::value,
+			TElement, Number>::type Divisor;
 	ResultMatrixT result;
 	for (int i = 0; i < ResultMatrixT::SIZE; i++) {
-        result(i) = m(i) / static_cast<TElement>(x);
+        result(i) = m(i) / static_cast<Divisor>(x);
 	}
 	return result;
 }
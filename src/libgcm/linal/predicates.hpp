@@ -0,0 +1,236 @@
+#ifndef LIBGCM_LINAL_PREDICATES_HPP
+#define LIBGCM_LINAL_PREDICATES_HPP
+
+#include <cmath>
+#include <limits>
+
+#include <libgcm/linal/Matrix.hpp>
+
+namespace gcm {
+namespace linal {
+
+/// The error-free transformations of predicates need every operation rounded
+/// as written: -ffast-math (ADDITIONAL_UNSAFE_OPTIMIZE) reassociates
+/// them away, and contraction into fused multiply-add breaks twoProduct
+#if defined(__clang__)
+#pragma float_control(precise, on, push)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math", "fp-contract=off")
+#elif defined(__FAST_MATH__)
+#error "Exact geometric predicates are incorrect with fast math"
+#endif
+
+/**
+ * Geometric predicates which return the exact sign of the determinant.
+ * The determinant is computed in floating point first and its sign is
+ * accepted if the absolute value exceeds the bound of rounding errors
+ * (the filter from J.R. Shewchuk, "Adaptive Precision Floating-Point
+ * Arithmetic and Fast Robust Geometric Predicates", 1997).
+ * Otherwise, the determinant is evaluated exactly by expansion arithmetic.
+ * Coordinates are converted to double, so float coordinates are exact too.
+ */
+namespace predicates {
+
+/// Sum a + b exactly as x + y, where x is the rounded sum
+inline void twoSum(const double a, const double b, double& x, double& y) {
+	x = a + b;
+	const double bVirtual = x - a;
+	const double aVirtual = x - bVirtual;
+	y = (a - aVirtual) + (b - bVirtual);
+}
+
+/// Split a into two halves of 26 bits each: a == high + low
+inline void split(const double a, double& high, double& low) {
+	const double c = 134217729.0 * a; // 2^27 + 1
+	const double aBig = c - a;
+	high = c - aBig;
+	low = a - high;
+}
+
+/// Product a * b exactly as x + y, where x is the rounded product
+/// (Dekker's algorithm, correct only without contraction into fused multiply-add)
+inline void twoProduct(const double a, const double b, double& x, double& y) {
+	x = a * b;
+	double aHigh, aLow, bHigh, bLow;
+	split(a, aHigh, aLow);
+	split(b, bHigh, bLow);
+	const double error1 = x - aHigh * bHigh;
+	const double error2 = error1 - aLow * bHigh;
+	const double error3 = error2 - aHigh * bLow;
+	y = aLow * bLow - error3;
+}
+
+
+/**
+ * Exact value as the sum of nonoverlapping components
+ * sorted by increasing magnitude, zero components are eliminated.
+ * @tparam N maximal number of components
+ */
+template<int N>
+struct Expansion {
+	double c[(size_t)N];
+	int n = 0;
+	
+	/** Add the number exactly (Grow-Expansion in terms of Shewchuk) */
+	void add(const double b) {
+		double q = b;
+		int m = 0;
+		for (int i = 0; i < n; i++) {
+			double sum, error;
+			twoSum(q, c[i], sum, error);
+			q = sum;
+			if (error != 0) { c[m++] = error; }
+		}
+		if (q != 0) {
+			assert_lt(m, N);
+			c[m++] = q;
+		}
+		n = m;
+	}
+	
+	/** Add the product of the expansion and the number exactly */
+	template<int M>
+	void addProduct(const Expansion<M>& e, const double b) {
+		for (int i = 0; i < e.n; i++) {
+			double x, y;
+			twoProduct(e.c[i], b, x, y);
+			add(y);
+			add(x);
+		}
+	}
+	
+	/** Add the product of two expansions exactly */
+	template<int M, int K>
+	void addProduct(const Expansion<M>& e, const Expansion<K>& f) {
+		for (int j = 0; j < f.n; j++) {
+			addProduct(e, f.c[j]);
+		}
+	}
+	
+	/** Sign of the exact value: the sign of the largest component */
+	int sign() const {
+		if (n == 0) { return 0; }
+		return (c[n - 1] > 0) ? 1 : -1;
+	}
+};
+
+
+/// Exact difference a - b
+inline Expansion<2> difference(const double a, const double b) {
+	Expansion<2> ans;
+	ans.add(a);
+	ans.add(-b);
+	return ans;
+}
+
+
+/// Exact a * d - b * c
+inline Expansion<16> determinant(
+		const Expansion<2>& a, const Expansion<2>& b,
+		const Expansion<2>& c, const Expansion<2>& d) {
+	Expansion<2> minusB;
+	for (int i = 0; i < b.n; i++) { minusB.add(-b.c[i]); }
+	Expansion<16> ans;
+	ans.addProduct(a, d);
+	ans.addProduct(minusB, c);
+	return ans;
+}
+
+
+/// Relative bounds of rounding errors for the filters
+constexpr double EPSILON = std::numeric_limits<double>::epsilon() / 2;
+constexpr double ORIENTATION_2D_ERROR_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+constexpr double ORIENTATION_3D_ERROR_BOUND = (7.0 + 56.0 * EPSILON) * EPSILON;
+
+
+inline int sign(const double x) {
+	return (x > 0) - (x < 0);
+}
+
+
+/// Exact orientation by expansions, rarely called, so kept out of filters
+inline int exactOrientation(const Real2& a, const Real2& b, const Real2& c) {
+	return determinant(
+			difference(a(0), c(0)), difference(a(1), c(1)),
+			difference(b(0), c(0)), difference(b(1), c(1))).sign();
+}
+
+inline int exactOrientation(const Real3& a, const Real3& b, const Real3& c, const Real3& d) {
+	Expansion<2> u[3], v[3], w[3];
+	for (int i = 0; i < 3; i++) {
+		u[i] = difference(b(i), a(i));
+		v[i] = difference(c(i), a(i));
+		w[i] = difference(d(i), a(i));
+	}
+	Expansion<192> ans;
+	for (int i = 0; i < 3; i++) {
+		const int j = (i + 1) % 3, k = (i + 2) % 3;
+		ans.addProduct(u[i], determinant(v[j], v[k], w[j], w[k]));
+	}
+	return ans.sign();
+}
+
+}
+
+
+/**
+ * Exact sign of orientedArea(a, b, c):
+ * 1 if {a, b, c} is counterclockwise sequence, -1 if clockwise,
+ * 0 if points are collinear
+ */
+inline int orientation(const Real2& a, const Real2& b, const Real2& c) {
+	const double acx = (double)a(0) - (double)c(0);
+	const double acy = (double)a(1) - (double)c(1);
+	const double bcx = (double)b(0) - (double)c(0);
+	const double bcy = (double)b(1) - (double)c(1);
+	const double left = acx * bcy;
+	const double right = acy * bcx;
+	const double det = left - right;
+	const double errorBound =
+			predicates::ORIENTATION_2D_ERROR_BOUND * (fabs(left) + fabs(right));
+	if (fabs(det) >= errorBound) { return predicates::sign(det); }
+	
+	return predicates::exactOrientation(a, b, c);
+}
+
+
+/**
+ * Exact sign of orientedVolume(a, b, c, d):
+ * 1 if {a, b, c} is counterclockwise sequence looking from d,
+ * -1 if clockwise, 0 if points are coplanar
+ */
+inline int orientation(const Real3& a, const Real3& b, const Real3& c, const Real3& d) {
+	double u[3], v[3], w[3];
+	for (int i = 0; i < 3; i++) {
+		u[i] = (double)b(i) - (double)a(i);
+		v[i] = (double)c(i) - (double)a(i);
+		w[i] = (double)d(i) - (double)a(i);
+	}
+	const double vw[3][2] = {
+		{v[1] * w[2], v[2] * w[1]},
+		{v[2] * w[0], v[0] * w[2]},
+		{v[0] * w[1], v[1] * w[0]},
+	};
+	double det = 0, permanent = 0;
+	for (int i = 0; i < 3; i++) {
+		det += u[i] * (vw[i][0] - vw[i][1]);
+		permanent += fabs(u[i]) * (fabs(vw[i][0]) + fabs(vw[i][1]));
+	}
+	const double errorBound = predicates::ORIENTATION_3D_ERROR_BOUND * permanent;
+	if (fabs(det) >= errorBound) { return predicates::sign(det); }
+	
+	return predicates::exactOrientation(a, b, c, d);
+}
+
+
+#if defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+}
+}
+
+#endif // LIBGCM_LINAL_PREDICATES_HPP
@@ -98,12 +98,19 @@ struct AbstractMaterial {
 	 * thirdly, by phi(2) radians around z-axis clockwise
 	 */
 	static ElasticTensor rotate(const ElasticTensor& t, const Real3& phi) {
+		return rotate(t, linal::getZRotationMatrix(phi(2)) *
+		                 linal::getYRotationMatrix(phi(1)) * 
+		                 linal::getXRotationMatrix(phi(0)));
+	}
+	
+	
+	/**
+	 * Return given tensor in system of axes given by rows
+	 * of the orthogonal matrix G
+	 */
+	static ElasticTensor rotate(const ElasticTensor& t, const linal::Matrix33& G) {
 		auto ans = ElasticTensor::Zeros();
 		
-		linal::Matrix33 G = linal::getZRotationMatrix(phi(2)) *
-		                    linal::getYRotationMatrix(phi(1)) * 
-		                    linal::getXRotationMatrix(phi(0));
-		
 		for (int m = 0; m < 3; m++)
 		for (int n = m; n < 3; n++) 
 		for (int p = 0; p < 3; p++) 
@@ -133,6 +140,15 @@ struct AbstractMaterial {
 	}
 	
 	
+	/**
+	 * Return given elastic matrix in system of axes given by rows
+	 * of the orthogonal matrix G
+	 */
+	static ElasticMatrix rotate(const ElasticMatrix& c, const linal::Matrix33& G) {
+		return convert(rotate(convert(c), G));
+	}
+	
+	
 };
 
 
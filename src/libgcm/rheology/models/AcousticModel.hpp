@@ -26,9 +26,10 @@ public:
 	static const int PDE_SIZE = PdeVector::M;
 	
 	typedef GcmMatrices<PDE_SIZE, DIMENSIONALITY> GCM_MATRICES;
+	/// The same without matrices A, stored in meshes
+	typedef GcmMatrices<PDE_SIZE, DIMENSIONALITY, false> LEAN_GCM_MATRICES;
 	typedef typename GCM_MATRICES::GcmMatrix      GcmMatrix;
 	typedef typename GCM_MATRICES::Matrix         Matrix;
-	typedef void                                  OdeVariables;
 	typedef std::shared_ptr<GCM_MATRICES>         GcmMatricesPtr;
 	typedef std::shared_ptr<const GCM_MATRICES>   ConstGcmMatricesPtr;
 	
@@ -45,7 +46,7 @@ public:
 	/// Matrix of outer eigenvectors
 	typedef linal::Matrix<PDE_SIZE, OUTER_NUMBER> OuterMatrix;
 	
-	typedef std::vector<int> WaveIndices;
+	typedef gcm::WaveIndices WaveIndices;
 	/// Indices of invariants with positive eigenvalues (sorted ascending)
 	static const WaveIndices  LEFT_INVARIANTS;
 	/// Indices of invariants with negative eigenvalues (sorted ascending)
@@ -65,6 +66,18 @@ public:
 	}
 	
 	
+	/**
+	 * Construct gcm matrices without matrices A for calculation in given basis
+	 */
+	template<typename TMaterialPtr>
+	static void constructGcmMatrices(std::shared_ptr<LEAN_GCM_MATRICES> m,
+			const TMaterialPtr& material, const MatrixDD& basis = MatrixDD::Identity()) {
+		auto full = std::make_shared<GCM_MATRICES>();
+		constructGcmMatrices(full, material, basis);
+		*m = LEAN_GCM_MATRICES(*full);
+	}
+	
+	
 	/**
 	 * Construct gcm matrix along the given direction.
 	 * @see ElasticModel::constructGcmMatrix for details
@@ -87,6 +100,20 @@ public:
 			std::shared_ptr<const IsotropicMaterial> material, const MatrixDD& basis);
 	
 	
+	/**
+	 * The same as gcm::localGcmStep specialized for eigenvectors of the model.
+	 * Eigenvectors of waves 0 and 1 have equal velocities and opposite
+	 * pressures, pressures in eigenvectors and eigenstrings of waves with zero
+	 * eigenvalues are zeros. So zero entries of U and U1 are skipped and
+	 * the pair of waves is summed up first.
+	 * @param m gcm matrix of the stage
+	 * @param values old values for each wave in columns
+	 * @return values on next time layer
+	 */
+	template<typename TGcmMatrix>
+	static PdeVector localGcmStep(const TGcmMatrix& m, const Matrix& values);
+	
+	
 	/**
 	 * Matrix of linear border condition in local (connected with border) 
 	 * basis for the case of fixed pressure on border.
@@ -333,6 +360,43 @@ constructOuterEigenvectors(std::shared_ptr<const IsotropicMaterial> material,
 }
 
 
+template<int Dimensionality>
+template<typename TGcmMatrix>
+inline typename AcousticModel<Dimensionality>::PdeVector
+AcousticModel<Dimensionality>::
+localGcmStep(const TGcmMatrix& m, const Matrix& values) {
+	const int D = DIMENSIONALITY;
+	
+	/// Riemann invariants
+	real omega[(size_t)PDE_SIZE];
+	for (int k = 0; k < 2; k++) {
+		omega[k] = 0;
+		for (int j = 0; j <= D; j++) {
+			omega[k] += m.U(k, j) * values(j, k);
+		}
+	}
+	for (int k = 2; k <= D; k++) {
+		omega[k] = 0;
+		for (int j = 0; j < D; j++) {
+			omega[k] += m.U(k, j) * values(j, k);
+		}
+	}
+	
+	PdeVector ans;
+	const real sum = omega[0] + omega[1];
+	for (int j = 0; j < D; j++) {
+		ans(j) = m.U1(j, 0) * sum;
+	}
+	ans(D) = m.U1(D, 0) * (omega[0] - omega[1]);
+	for (int k = 2; k <= D; k++) {
+		for (int j = 0; j < D; j++) {
+			ans(j) += m.U1(j, k) * omega[k];
+		}
+	}
+	return ans;
+}
+
+
 }
 
 #endif // LIBGCM_ACOUSTICMODEL_HPP
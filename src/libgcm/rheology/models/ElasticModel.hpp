@@ -1,6 +1,8 @@
 #ifndef LIBGCM_ELASTICMODEL_HPP
 #define LIBGCM_ELASTICMODEL_HPP
 
+#include <algorithm>
+
 #include <libgcm/rheology/models/Model.hpp>
 
 
@@ -25,9 +27,10 @@ public:
 	static const int PDE_SIZE = PdeVector::M;
 	
 	typedef GcmMatrices<PDE_SIZE, DIMENSIONALITY> GCM_MATRICES;
+	/// The same without matrices A, stored in meshes
+	typedef GcmMatrices<PDE_SIZE, DIMENSIONALITY, false> LEAN_GCM_MATRICES;
 	typedef typename GCM_MATRICES::GcmMatrix      GcmMatrix;
 	typedef typename GCM_MATRICES::Matrix         Matrix;
-	typedef void                                  OdeVariables;
 	typedef std::shared_ptr<GCM_MATRICES>         GcmMatricesPtr;
 	typedef std::shared_ptr<const GCM_MATRICES>   ConstGcmMatricesPtr;
 
@@ -45,7 +48,7 @@ public:
 	/// Matrix of outer eigenvectors
 	typedef linal::Matrix<PDE_SIZE, OUTER_NUMBER> OuterMatrix;
 	
-	typedef std::vector<int> WaveIndices;
+	typedef gcm::WaveIndices WaveIndices;
 	/// Indices of invariants with positive eigenvalues (sorted ascending)
 	static const WaveIndices  LEFT_INVARIANTS;
 	/// Indices of invariants with negative eigenvalues (sorted ascending)
@@ -65,6 +68,18 @@ public:
 	}
 	
 	
+	/**
+	 * Construct gcm matrices without matrices A for calculation in given basis
+	 */
+	template<typename TMaterialPtr>
+	static void constructGcmMatrices(std::shared_ptr<LEAN_GCM_MATRICES> m,
+			const TMaterialPtr& material, const MatrixDD& basis = MatrixDD::Identity()) {
+		auto full = std::make_shared<GCM_MATRICES>();
+		constructGcmMatrices(full, material, basis);
+		*m = LEAN_GCM_MATRICES(*full);
+	}
+	
+	
 	/**
 	 * Construct gcm matrices for calculation in global orthonormal basis
 	 */
@@ -102,6 +117,20 @@ public:
 			std::shared_ptr<const IsotropicMaterial> material, const MatrixDD& basis);
 	
 	
+	/**
+	 * The same as gcm::localGcmStep specialized for eigenvectors of the model.
+	 * Eigenvectors of waves 2i and 2i+1 have equal velocities and opposite
+	 * sigma, velocities in eigenvectors and eigenstrings of waves with zero
+	 * eigenvalues are zeros (for any material and basis). So zero entries
+	 * of U and U1 are skipped and the pairs of waves are summed up first.
+	 * @param m gcm matrix of the stage
+	 * @param values old values for each wave in columns
+	 * @return values on next time layer
+	 */
+	template<typename TGcmMatrix>
+	static PdeVector localGcmStep(const TGcmMatrix& m, const Matrix& values);
+	
+	
 	/**
 	 * Matrix of linear border condition in local (connected with border) 
 	 * basis for the case of fixed force on border.
@@ -326,8 +355,67 @@ private:
 		return (2 * s - linal::Diag(s));
 	}
 	
+	/**
+	 * Construct gcm matrices along the axes for a general anisotropic
+	 * material given by its elastic matrix in these axes.
+	 * Waves are sorted by velocity, p-waves are the last ones
+	 */
 	static void constructRotated(GcmMatricesPtr m,
-			std::shared_ptr<const OrthotropicMaterial> material);
+			const real rho, const AbstractMaterial::ElasticMatrix& c);
+	
+	/**
+	 * Matrix of the change of PDE variables to the orthonormal basis:
+	 * velocity to B^T * v and sigma to B^T * sigma * B
+	 */
+	static Matrix variablesToBasis(const MatrixDD& basis) {
+		const MatrixDD basisT = linal::transpose(basis);
+		Matrix ans;
+		PdeVariables u, v;
+		for (int j = 0; j < PDE_SIZE; j++) {
+			linal::clear(u);
+			u(j) = 1;
+			v.setVelocity(basisT * u.getVelocity());
+			setSigmaTo(v, basisT * getSigmaFrom(u) * basis);
+			ans.setColumn(j, v);
+		}
+		return ans;
+	}
+	
+	/**
+	 * Rewrite gcm matrices constructed in the axes of the basis
+	 * for PDE variables in global axes
+	 */
+	static void rotateVariables(GcmMatricesPtr m, const MatrixDD& basis) {
+		const Matrix toBasis = variablesToBasis(basis);
+		const Matrix fromBasis = variablesToBasis(linal::transpose(basis));
+		for (int s = 0; s < DIMENSIONALITY; s++) {
+			GcmMatrix& matrix = (*m)(s);
+			matrix.A = fromBasis * matrix.A * toBasis;
+			matrix.U = matrix.U * toBasis;
+			matrix.U1 = fromBasis * matrix.U1;
+		}
+	}
+	
+	/**
+	 * Hand-written matrices of orthotropic materials list the wave with
+	 * negative eigenvalue first in each pair. The waves of pairs are
+	 * swapped, so that LEFT_INVARIANTS have positive eigenvalues
+	 * for all materials
+	 */
+	static void swapWavesInPairs(GcmMatricesPtr m) {
+		for (int s = 0; s < DIMENSIONALITY; s++) {
+			GcmMatrix& matrix = (*m)(s);
+			for (int i = 0; i < DIMENSIONALITY; i++) {
+				std::swap(matrix.L(2 * i), matrix.L(2 * i + 1));
+				const auto column = matrix.U1.getColumn(2 * i);
+				matrix.U1.setColumn(2 * i, matrix.U1.getColumn(2 * i + 1));
+				matrix.U1.setColumn(2 * i + 1, column);
+				const auto row = matrix.U.getRow(2 * i);
+				matrix.U.setRow(2 * i, matrix.U.getRow(2 * i + 1));
+				matrix.U.setRow(2 * i + 1, row);
+			}
+		}
+	}
 	
 	static void constructNotRotated(GcmMatricesPtr m, const real rho,
 			const real c11, const real c12, const real c13,
@@ -338,23 +426,6 @@ private:
 			GcmMatricesPtr m, const real rho,
 			const real c11, const real c12, const real c22, const real c66);
 	
-	static linal::VECTOR<3, long double> constructEigenvaluesPolynomial(
-			ConstGcmMatricesPtr m, const int s);
-	
-	static std::vector<linal::VECTOR<9, long double>> findEigenvectors(
-			const long double l, const linal::Matrix<9, 9>& A,
-			const int stage, const int numberOfVectorsToSearch);
-	
-	static std::vector<linal::VECTOR<9, long double>> findEigenstrings(
-			const long double l, const linal::Matrix<9, 9>& A,
-			const int stage, const int numberOfStringsToSearch);
-
-	
-	/// indices of columns which contains (- 1 / rho) in increasing order
-	static void getColumnsWithRho(const int stage, int& i, int& j, int& k);
-
-	/// indices of columns with all zeros in increasing order
-	static void getZeroColumns(const int stage, int& i, int& j, int& k);
 
 };
 
@@ -572,6 +643,136 @@ constructOuterEigenvectors(std::shared_ptr<const IsotropicMaterial> material,
 }
 
 
+template<int Dimensionality>
+inline void ElasticModel<Dimensionality>::
+constructRotated(
+		GcmMatricesPtr m, const real rho, const AbstractMaterial::ElasticMatrix& c) {
+/// Along axis s: rho dv_i/dt = dsigma_is/dx_s, dsigma_ij/dt = c_ijks dv_k/dx_s
+	
+	const int D = DIMENSIONALITY;
+	const auto q = AbstractMaterial::convert(c);
+	m->clear();
+	
+	PdeVariables vec;
+	for (int s = 0; s < D; s++) {
+		GcmMatrix& mat = (*m)(s);
+		for (int i = 0; i < D; i++) {
+			linal::clear(vec);
+			vec.sigma(i, s) = -1.0 / rho;
+			mat.A.setRow(i, vec);
+		}
+		for (int k = 0; k < D; k++) {
+			linal::clear(vec);
+			for (int i = 0; i < D; i++) {
+				for (int j = 0; j <= i; j++) {
+					vec.sigma(i, j) = -q(i, j)(k, s);
+				}
+			}
+			mat.A.setColumn(k, vec);
+		}
+		
+		/// squared velocities of waves multiplied by rho and their
+		/// polarizations are eigenvalues and eigenvectors of the acoustic
+		/// tensor q(i, s)(k, s); polarizations of s-waves with close
+		/// velocities stay orthonormal
+		MatrixDD acoustic;
+		for (int i = 0; i < D; i++) {
+			for (int k = 0; k < D; k++) {
+				acoustic(i, k) = q(i, s)(k, s);
+			}
+		}
+		const linal::SymmetricEigenDecomposition<D> eigen(acoustic);
+		int order[(size_t)D];
+		for (int w = 0; w < D; w++) { order[w] = w; }
+		std::sort(order, order + D, [&eigen](const int a, const int b) {
+			return eigen.eigenvalues()(a) < eigen.eigenvalues()(b);
+		});
+		
+		/// the wave with velocity l: v = p, sigma_ij = -c_ijks p_k / l
+		for (int w = 0; w < 2 * D; w++) {
+			const RealD p = eigen.eigenvectors().getColumn(order[w / 2]);
+			const real velocity = sqrt(eigen.eigenvalues()(order[w / 2]) / rho);
+			mat.L(w) = (w % 2 == 0) ? velocity : -velocity;
+			linal::clear(vec);
+			vec.setVelocity(p);
+			for (int i = 0; i < D; i++) {
+				for (int j = 0; j <= i; j++) {
+					for (int k = 0; k < D; k++) {
+						vec.sigma(i, j) -= q(i, j)(k, s) * p(k) / mat.L(w);
+					}
+				}
+			}
+			mat.U1.setColumn(w, vec);
+		}
+		/// waves with zero velocity are sigma components without index s
+		int w = 2 * D;
+		for (int i = 0; i < D; i++) {
+			for (int j = 0; j <= i; j++) {
+				if (i != s && j != s) {
+					linal::clear(vec);
+					vec.sigma(i, j) = 1;
+					mat.U1.setColumn(w++, vec);
+				}
+			}
+		}
+		
+		mat.U = linal::invert(mat.U1);
+	}
+	
+	m->checkDecomposition(1e-2);
+}
+
+
+template<int Dimensionality>
+template<typename TGcmMatrix>
+inline typename ElasticModel<Dimensionality>::PdeVector
+ElasticModel<Dimensionality>::
+localGcmStep(const TGcmMatrix& m, const Matrix& values) {
+	const int D = DIMENSIONALITY;
+	const int M = PDE_SIZE;
+	
+	/// Riemann invariants
+	real omega[(size_t)M];
+	for (int k = 0; k < 2 * D; k++) {
+		omega[k] = 0;
+		for (int j = 0; j < M; j++) {
+			omega[k] += m.U(k, j) * values(j, k);
+		}
+	}
+	for (int k = 2 * D; k < M; k++) {
+		omega[k] = 0;
+		for (int j = D; j < M; j++) {
+			omega[k] += m.U(k, j) * values(j, k);
+		}
+	}
+	
+	/// the pairs of waves are summed up
+	real sum[(size_t)D], difference[(size_t)D];
+	for (int i = 0; i < D; i++) {
+		sum[i] = omega[2 * i] + omega[2 * i + 1];
+		difference[i] = omega[2 * i] - omega[2 * i + 1];
+	}
+	
+	PdeVector ans;
+	for (int j = 0; j < D; j++) {
+		ans(j) = 0;
+		for (int i = 0; i < D; i++) {
+			ans(j) += m.U1(j, 2 * i) * sum[i];
+		}
+	}
+	for (int j = D; j < M; j++) {
+		ans(j) = 0;
+		for (int i = 0; i < D; i++) {
+			ans(j) += m.U1(j, 2 * i) * difference[i];
+		}
+		for (int k = 2 * D; k < M; k++) {
+			ans(j) += m.U1(j, k) * omega[k];
+		}
+	}
+	return ans;
+}
+
+
 }
 
 #endif // LIBGCM_ELASTICMODEL_HPP
@@ -72,6 +72,7 @@ void ElasticModel<2>::constructNotRotated(
 			0,           0,            0.5*rho*cp2,  -0.5*rho*cp2,  0,
 	};
 	
+	swapWavesInPairs(m);
 	m->checkDecomposition();
 }
 
@@ -80,10 +81,24 @@ template<>
 void ElasticModel<2>::constructGcmMatrices(GcmMatricesPtr m,
 		std::shared_ptr<const OrthotropicMaterial> material,
 		const MatrixDD& basis) {
-	assert_true(basis == linal::identity(basis)); // TODO
 	m->basis = basis;
-	constructNotRotated(m, material->rho,
-			material->c11, material->c12, material->c22, material->c66);
+	if (basis == linal::identity(basis)) {
+		constructNotRotated(m, material->rho,
+				material->c11, material->c12, material->c22, material->c66);
+		return;
+	}
+	
+	/// main axes of the material are the global ones,
+	/// the elastic matrix in the axes of the basis, variables are rotated back
+	linal::Matrix33 G = linal::Matrix33::Identity();
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			G(i, j) = basis(j, i);
+		}
+	}
+	constructRotated(m, material->rho,
+			AbstractMaterial::rotate(material->getElasticMatrix(), G));
+	rotateVariables(m, basis);
 }
 
 
@@ -6,6 +6,7 @@
 #include <libgcm/rheology/materials/materials.hpp>
 #include <libgcm/rheology/variables/variables.hpp>
 #include <libgcm/util/math/GridCharacteristicMethod.hpp>
+#include <libgcm/util/WaveIndices.hpp>
 
 
 namespace gcm {
@@ -1,7 +1,10 @@
 #ifndef LIBGCM_ODE_HPP
 #define LIBGCM_ODE_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
+#include <vector>
 
 #include <libgcm/grid/AbstractGrid.hpp>
 #include <libgcm/util/task/Task.hpp>
@@ -22,64 +25,153 @@ public:
 
 
 /**
- * The simplest Maxwell viscosity model
+ * The simplest Maxwell viscosity model.
+ * Decay factors exp(-timeStep / tau0) are computed once per material
+ * and refreshed only when the time step changes, nodes refer to them
+ * by the index of their material. The index is rebuilt when the mesh,
+ * its size or its materials version changes.
  */
 template<typename TMesh>
 class MaxwellViscosityOde : public AbstractOde {
 public:
+	typedef typename TMesh::Iterator         Iterator;
+	typedef typename TMesh::Material         Material;
+	
 	virtual void apply(AbstractGrid& mesh_, const real timeStep) override {
 		TMesh& mesh = dynamic_cast<TMesh&>(mesh_);
-		for (auto& iter : mesh) {
-			mesh._pdeVars(iter).setSigma(mesh.pdeVars(iter).getSigma() *
-					exp(-timeStep / mesh.material(iter)->tau0));
+		if (&mesh != indexedMesh ||
+				materialIndices.size() != mesh.sizeOfRealNodes() ||
+				mesh.getMaterialsVersion() != indexedMaterialsVersion) {
+			indexMaterials(mesh);
+		}
+		if (timeStep != decayTimeStep) {
+			decayTimeStep = timeStep;
+			for (size_t i = 0; i < materials.size(); i++) {
+				decayFactors[i] = exp(-timeStep / materials[i]->tau0);
+			}
+		}
+		
+		forEachNode(mesh, [&](const Iterator& it, const size_t k) {
+			mesh._pdeVars(it).setSigma(mesh.pdeVars(it).getSigma() *
+					decayFactors[(size_t)materialIndices[k]]);
+		}, IsIndexIterator());
+	}
+
+
+private:
+	/// Different materials of the mesh and their current decay factors.
+	/// The mesh owns the materials, so they are not shared here
+	std::vector<const Material*> materials;
+	std::vector<real> decayFactors;
+	/// Index in materials for each node in order of mesh iteration
+	std::vector<int> materialIndices;
+	/// The mesh and its materials version the index is built for
+	const TMesh* indexedMesh = nullptr;
+	size_t indexedMaterialsVersion = 0;
+	/// The time step decay factors are computed for
+	real decayTimeStep = 0;
+	
+	/// Nodes of unstructured grids are numbered in a row
+	typedef std::is_convertible<Iterator, size_t> IsIndexIterator;
+	
+	void indexMaterials(const TMesh& mesh) {
+		materials.clear();
+		materialIndices.clear();
+		materialIndices.reserve(mesh.sizeOfRealNodes());
+		for (const auto& it : mesh) {
+			const Material* const material = mesh.material(it).get();
+			auto found = std::find(materials.begin(), materials.end(), material);
+			if (found == materials.end()) {
+				found = materials.insert(materials.end(), material);
+			}
+			materialIndices.push_back((int)(found - materials.begin()));
+		}
+		decayFactors.resize(materials.size());
+		decayTimeStep = 0;
+		indexedMesh = &mesh;
+		indexedMaterialsVersion = mesh.getMaterialsVersion();
+	}
+	
+	/** Parallel loop over nodes of unstructured grids */
+	template<typename TFunction>
+	static void forEachNode(const TMesh& mesh, TFunction function, std::true_type) {
+		const size_t size = mesh.sizeOfRealNodes();
+		#pragma omp parallel for
+		for (size_t k = 0; k < size; k++) {
+			function(Iterator(k), k);
+		}
+	}
+	
+	/** Serial loop over nodes of structured grids */
+	template<typename TFunction>
+	static void forEachNode(const TMesh& mesh, TFunction function, std::false_type) {
+		size_t k = 0;
+		for (const auto& it : mesh) {
+			function(it, k++);
 		}
 	}
 };
 
 
 /**
- * The simplest continual damage model
+ * The simplest continual damage model: the damage measure grows
+ * with the rate continualDamageParameter * |pressure|.
+ * Only nodes with slots in OdeVariables are processed.
  */
 template<typename TMesh>
 class ContinualDamageOde : public AbstractOde {
 public:
+	typedef typename TMesh::PdeVariables PdeVariables;
+	
 	virtual void apply(AbstractGrid& mesh_, const real timeStep) override {
 		TMesh& mesh = dynamic_cast<TMesh&>(mesh_);
-		for (auto& iter : mesh) {
-			const real dHiDt = fabs(mesh.pdeVars(iter).getPressure());
-			mesh._ode(iter) += timeStep * dHiDt;
+		typename TMesh::OdeVariables& odeVars = mesh._odeVars();
+		/// empty if no material of the mesh is damageable
+		const size_t size = odeVars.damage.size();
+		real* const damage = odeVars.damage.data();
+		const real* const parameter = odeVars.continualDamageParameter.data();
+		#pragma omp parallel for simd
+		for (size_t k = 0; k < size; k++) {
+			const real pressure = PdeVariables::GetPressure(mesh.pde(odeVars.nodes[k]));
+			damage[k] += timeStep * parameter[k] * fabs(pressure);
 		}
 	}
 };
 
 
 /**
- * The simplest plasticity flow model corrector
+ * The simplest plasticity flow model corrector (von Mises criterion).
+ * If J2 exceeds the yield strength, the stress deviator is scaled back
+ * to the yield surface and the excess divided by the shear modulus
+ * is added to the accumulated plastic strain.
+ * Only nodes with slots in OdeVariables are processed.
  */
 template<typename TMesh>
 class IdealPlasticFlowCorrector : public AbstractOde {
-	static const int D = TMesh::DIMENSIONALITY;
-	typedef linal::DiagonalMatrix<D> DiagD;
 public:
+	typedef typename TMesh::PdeVariables PdeVariables;
+	
 	virtual void apply(AbstractGrid& mesh_, const real) override {
 		TMesh& mesh = dynamic_cast<TMesh&>(mesh_);
-		for (auto& iter : mesh) {
-			real pressure = mesh.pdeVars(iter).getPressure();
-			real J2 = mesh.pdeVars(iter).getJ2();
-			
-			/// Correction parameter
-			real x = J2 / mesh.material(iter)->yieldStrength;
-			
-			if (x > 1) {
-				DiagD spherical = DiagD::Identity() * pressure;
-				mesh._pdeVars.setSigma(
-						mesh.pdeVars.getSigma() + (1.0 / x - 1) * spherical);
+		typename TMesh::OdeVariables& odeVars = mesh._odeVars();
+		/// empty if no material of the mesh is plastic
+		const size_t size = odeVars.plasticStrain.size();
+		real* const plasticStrain = odeVars.plasticStrain.data();
+		const real* const yieldStrength = odeVars.yieldStrength.data();
+		const real* const shearModulus = odeVars.shearModulus.data();
+		#pragma omp parallel for
+		for (size_t k = 0; k < size; k++) {
+			PdeVariables& pdeVars = mesh._pdeVars(odeVars.nodes[k]);
+			const real J2 = pdeVars.getJ2();
+			/// nodes can have slots for the damage model only
+			if (yieldStrength[k] > 0 && J2 > yieldStrength[k]) {
+				pdeVars.scaleStressDeviator(yieldStrength[k] / J2);
+				plasticStrain[k] += (J2 - yieldStrength[k]) / shearModulus[k];
 			}
 		}
 	}
 };
 
-
 }
 
 #endif // LIBGCM_ODE_HPP
@@ -66,6 +66,9 @@ struct AcousticVariables : public linal::Vector<Dimensionality + 1> {
 	///@{
 	real getSigma() const { return pressure(); }
 	void setSigma(const real& orig) { pressure() = orig; }
+	/// there are no shear stresses in acoustic media
+	real getJ2() const { return 0; }
+	void scaleStressDeviator(const real) { }
 	///@}
 	
 	
@@ -0,0 +1,135 @@
+#ifndef LIBGCM_ODEVARIABLES_HPP
+#define LIBGCM_ODEVARIABLES_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <libgcm/rheology/materials/materials.hpp>
+#include <libgcm/util/task/Task.hpp>
+
+
+namespace gcm {
+
+/**
+ * Internal variables of ODEs (damage measure, accumulated plastic strain)
+ * and material parameters they need. Only nodes whose materials have
+ * nonzero parameters of the applied ODEs get a slot, so purely elastic
+ * regions don't take memory. Each variable is a separate array over slots
+ * (structure of arrays), so update loops go through contiguous memory.
+ * @tparam TIterator type of mesh iterator
+ */
+template<typename TIterator>
+struct OdeVariables {
+	typedef TIterator Iterator;
+	
+	/// Nodes with slots and their indices in mesh storage, sorted ascending
+	/// by indices @{
+	std::vector<Iterator> nodes;
+	std::vector<size_t> indices;
+	/// @}
+	
+	/// Variables and parameters of continual damage model @{
+	std::vector<real> damage;
+	std::vector<real> continualDamageParameter;
+	/// @}
+	
+	/// Variables and parameters of ideal plasticity model @{
+	std::vector<real> plasticStrain;
+	std::vector<real> yieldStrength;
+	std::vector<real> shearModulus;
+	/// @}
+	
+	/** Number of slots */
+	size_t size() const { return nodes.size(); }
+	
+	/** Whether the node has a slot */
+	bool hasSlot(const size_t index) const {
+		return std::binary_search(indices.begin(), indices.end(), index);
+	}
+	
+	/**
+	 * Slot of the node
+	 * @param index index of the node in mesh storage, it must have a slot
+	 */
+	size_t slot(const size_t index) const {
+		const auto found = std::lower_bound(indices.begin(), indices.end(), index);
+		assert_true(found != indices.end() && *found == index);
+		return (size_t)(found - indices.begin());
+	}
+	
+	
+	/**
+	 * Give slots to the nodes whose materials need them for ODEs
+	 * of the mesh body in the task.
+	 * Values of internal variables are zero initially.
+	 */
+	template<typename TMesh>
+	void allocate(const TMesh& mesh, const Task& task) {
+		const auto body = task.bodies.find(mesh.id);
+		const std::vector<Odes::T> odes = (body != task.bodies.end()) ?
+				body->second.odes : std::vector<Odes::T>();
+		const bool damageOde = std::find(odes.begin(), odes.end(),
+				Odes::T::CONTINUAL_DAMAGE) != odes.end();
+		const bool plasticityOde = std::find(odes.begin(), odes.end(),
+				Odes::T::IDEAL_PLASTIC_FLOW) != odes.end();
+		
+		/// the storage of the model is allocated only if some material enables it
+		bool hasDamage = false, hasPlasticity = false;
+		std::vector<std::pair<size_t, Iterator>> sorted;
+		for (const auto& it : mesh) {
+			const auto material = mesh.material(it);
+			const bool damageable = damageOde && material->continualDamageParameter > 0;
+			const bool plastic = plasticityOde && material->yieldStrength > 0;
+			if (damageable || plastic) {
+				sorted.push_back({mesh.getIndex(it), it});
+			}
+			hasDamage = hasDamage || damageable;
+			hasPlasticity = hasPlasticity || plastic;
+		}
+		std::sort(sorted.begin(), sorted.end(),
+				[](const std::pair<size_t, Iterator>& a,
+				   const std::pair<size_t, Iterator>& b) {
+			return a.first < b.first;
+		});
+		
+		nodes.clear();
+		indices.clear();
+		for (const auto& node : sorted) {
+			indices.push_back(node.first);
+			nodes.push_back(node.second);
+		}
+		
+		damage.assign(hasDamage ? size() : 0, 0);
+		continualDamageParameter.resize(damage.size());
+		plasticStrain.assign(hasPlasticity ? size() : 0, 0);
+		yieldStrength.resize(plasticStrain.size());
+		shearModulus.resize(plasticStrain.size());
+		for (size_t k = 0; k < size(); k++) {
+			const auto material = mesh.material(nodes[k]);
+			if (hasDamage) {
+				continualDamageParameter[k] = material->continualDamageParameter;
+			}
+			if (hasPlasticity) {
+				yieldStrength[k] = material->yieldStrength;
+				shearModulus[k] = getShearModulus(*material);
+			}
+		}
+	}
+
+
+private:
+	template<typename TMaterial>
+	static real getShearModulus(const TMaterial& material) {
+		return material.mu;
+	}
+	
+	/// Mean of shear moduli along the main axes of the material
+	static real getShearModulus(const OrthotropicMaterial& material) {
+		return (material.c44 + material.c55 + material.c66) / 3;
+	}
+};
+
+
+}
+
+#endif // LIBGCM_ODEVARIABLES_HPP
@@ -127,6 +127,17 @@ struct VelocitySigmaVariables : public linal::Vector<Size> {
 		return sqrt(J22);
 	}
 
+	/** Multiply the deviator of sigma by the factor keeping the pressure */
+	void scaleStressDeviator(const real factor) {
+		const real pressure = getPressure();
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			for (int j = 0; j <= i; j++) {
+				sigma(i, j) = (sigma(i, j) + (i == j) * pressure) * factor -
+						(i == j) * pressure;
+			}
+		}
+	}
+
 	/** 
 	 * @name Getters and Setters
 	 * @see GetSetter.hpp for explanations
@@ -0,0 +1,87 @@
+#ifndef LIBGCM_MAPPEDFILE_HPP
+#define LIBGCM_MAPPEDFILE_HPP
+
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+
+
+namespace gcm {
+
+/**
+ * Read-only memory mapping of the whole file.
+ * Pages are loaded by OS on demand, so reading large binary files
+ * costs no more than copying the data from the page cache.
+ */
+class MappedFile {
+public:
+	/** Map the file. If it does not exist or is empty, isOpen() == false */
+	explicit MappedFile(const std::string& fileName) {
+		const int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd == -1) { return; }
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+			void* mapped = mmap(nullptr, (size_t)fileStat.st_size,
+					PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED) {
+				begin = static_cast<const char*>(mapped);
+				length = (size_t)fileStat.st_size;
+			}
+		}
+		close(fd);
+	}
+	
+	~MappedFile() {
+		if (isOpen()) { munmap(const_cast<char*>(begin), length); }
+	}
+	
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	
+	bool isOpen() const { return begin != nullptr; }
+	const char* data() const { return begin; }
+	size_t size() const { return length; }
+	
+	
+	/**
+	 * Sequential reading of the mapped data
+	 */
+	class Reader {
+	public:
+		Reader(const MappedFile& file) :
+				current(file.data()), end(file.data() + file.size()) { }
+		
+		/** Copy the next n objects of type T to the destination */
+		template<typename T>
+		bool read(T* destination, const size_t n = 1) {
+			const size_t bytes = n * sizeof(T);
+			if ((size_t)(end - current) < bytes) { return false; }
+			std::memcpy(destination, current, bytes);
+			current += bytes;
+			return true;
+		}
+		
+		/** Whether all the data is read */
+		bool finished() const { return current == end; }
+	
+	private:
+		const char* current;
+		const char* const end;
+	};
+
+
+private:
+	const char* begin = nullptr;
+	size_t length = 0;
+};
+
+
+}
+
+#endif // LIBGCM_MAPPEDFILE_HPP
@@ -1,6 +1,10 @@
 #ifndef LIBGCM_STRINGUTILS_HPP
 #define LIBGCM_STRINGUTILS_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
 #include <sstream>
 #include <vector>
@@ -36,7 +40,131 @@ public:
 		
 		return ans;
 	}
+	
+	
+	/** @name Allocation-free parsing of numbers from [begin, end).
+	 * Leading spaces and tabs are skipped, begin is moved past the number.
+	 * Return false (and do not move begin) if there is no number.
+	 */
+	///@{
+	static bool parse(const char*& begin, const char* end, size_t& value) {
+		const char* p = skipSpaces(begin, end);
+		if (p == end || !isDigit(*p)) { return false; }
+		size_t ans = 0;
+		for (; p != end && isDigit(*p); ++p) {
+			ans = ans * 10 + (size_t)(*p - '0');
+		}
+		value = ans;
+		begin = p;
+		return true;
+	}
+	
+	static bool parse(const char*& begin, const char* end, int& value) {
+		const char* p = skipSpaces(begin, end);
+		const bool negative = (p != end && *p == '-');
+		if (p != end && (*p == '-' || *p == '+')) { ++p; }
+		size_t absolute = 0;
+		if (p == end || !isDigit(*p) || !parse(p, end, absolute)) { return false; }
+		value = negative ? -(int)absolute : (int)absolute;
+		begin = p;
+		return true;
+	}
+	
+	/**
+	 * Decimal with optional fraction and exponent (like "-1.5e+03").
+	 * Numbers with up to 15 significant digits and small exponents are
+	 * converted exactly by one multiplication, others -- by std::strtod
+	 */
+	static bool parse(const char*& begin, const char* end, double& value) {
+		const char* const start = skipSpaces(begin, end);
+		const char* p = start;
+		const bool negative = (p != end && *p == '-');
+		if (p != end && (*p == '-' || *p == '+')) { ++p; }
+		
+		uint64_t mantissa = 0;
+		int significantDigits = 0, exponent = 0;
+		bool hasDigits = false, isExact = true;
+		for (; p != end && isDigit(*p); ++p) {
+			hasDigits = true;
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				if (mantissa != 0) { ++significantDigits; }
+			} else {
+				++exponent;
+				isExact = false;
+			}
+		}
+		if (p != end && *p == '.') {
+			for (++p; p != end && isDigit(*p); ++p) {
+				hasDigits = true;
+				if (significantDigits < 19) {
+					mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+					if (mantissa != 0) { ++significantDigits; }
+					--exponent;
+				} else if (*p != '0') {
+					isExact = false;
+				}
+			}
+		}
+		if (!hasDigits) { return false; }
+		
+		if (p != end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			int e = 0;
+			if (q != end && !isSpace(*q) && parse(q, end, e)) {
+				exponent += std::max(-10000, std::min(e, 10000));
+				p = q;
+			}
+		}
+		
+		/// 10^22 is the largest power of ten exactly representable in double
+		static const double powersOf10[] = {
+				1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+				1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+		if (isExact && mantissa <= (uint64_t(1) << 53) &&
+				exponent >= -22 && exponent <= 22) {
+			const double m = (double)mantissa;
+			value = (exponent < 0) ? m / powersOf10[-exponent] : m * powersOf10[exponent];
+		} else {
+			char buffer[64];
+			const size_t length = (size_t)(p - start);
+			if (length < sizeof(buffer)) {
+				std::copy(start, p, buffer);
+				buffer[length] = '\0';
+				value = std::abs(std::strtod(buffer, nullptr));
+			} else {
+				value = std::abs(std::strtod(std::string(start, p).c_str(), nullptr));
+			}
+		}
+		if (negative) { value = -value; }
+		begin = p;
+		return true;
+	}
+	///@}
+	
+	
+	/** Skip spaces and tabs */
+	static const char* skipSpaces(const char* begin, const char* end) {
+		while (begin != end && isSpace(*begin)) { ++begin; }
+		return begin;
+	}
+	
+	/** Move to the beginning of the next line (or end) */
+	static const char* nextLine(const char* begin, const char* end) {
+		const char* newLine = std::find(begin, end, '\n');
+		return (newLine == end) ? end : newLine + 1;
+	}
+	
+	/** Whether there is nothing but spaces till the end of the line */
+	static bool isEndOfLine(const char* begin, const char* end) {
+		begin = skipSpaces(begin, end);
+		return begin == end || *begin == '\n';
+	}
+
 
+private:
+	static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+	static bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
 
 };
 
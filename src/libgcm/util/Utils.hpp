@@ -2,10 +2,12 @@
 #define LIBGCM_UTILS_HPP
 
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 #include <set>
 
 #include <libgcm/util/infrastructure/infrastructure.hpp>
+#include <libgcm/util/WaveIndices.hpp>
 
 
 namespace gcm {
@@ -42,6 +44,22 @@ public:
 	}
 	
 	
+	/**
+	 * 64-bit FNV-1a hash of the bytes.
+	 * Hashes of several pieces of data are chained by seed.
+	 */
+	static uint64_t hash(const void* data, const size_t size,
+			const uint64_t seed = 14695981039346656037ULL) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		uint64_t ans = seed;
+		for (size_t i = 0; i < size; i++) {
+			ans ^= bytes[i];
+			ans *= 1099511628211ULL;
+		}
+		return ans;
+	}
+	
+	
 	/**
 	 * Seed random generator to produce different values
 	 */
@@ -153,6 +171,19 @@ public:
 				std::inserter(ans, ans.begin()));
 		return ans;
 	}
+	
+	/// WaveIndices are bitmasks, so logical operations are bitwise
+	static WaveIndices difference(const WaveIndices& a, const WaveIndices& b) {
+		return WaveIndices::fromMask(a.mask() & ~b.mask());
+	}
+	
+	static WaveIndices summ(const WaveIndices& a, const WaveIndices& b) {
+		return a | b;
+	}
+	
+	static WaveIndices intersection(const WaveIndices& a, const WaveIndices& b) {
+		return a & b;
+	}
 	/// @}
 	
 };
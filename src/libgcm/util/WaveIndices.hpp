@@ -0,0 +1,125 @@
+#ifndef LIBGCM_WAVEINDICES_HPP
+#define LIBGCM_WAVEINDICES_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+#include <libgcm/util/infrastructure/infrastructure.hpp>
+
+
+namespace gcm {
+
+/**
+ * Set of indices of waves (Riemann invariants) stored as a fixed-width bitmask.
+ * Indices are iterated in ascending order, so the set behaves like
+ * a sorted std::vector<int> of unique values, but without heap allocations.
+ */
+class WaveIndices {
+public:
+	typedef uint32_t Mask;
+	/// Maximal index of wave plus one
+	static const int MAX_SIZE = 8 * sizeof(Mask);
+	
+	/** Forward iterator over set bits in ascending order */
+	class ConstIterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef int                       value_type;
+		typedef std::ptrdiff_t            difference_type;
+		typedef const int*                pointer;
+		typedef int                       reference;
+		
+		ConstIterator(const Mask rest_) : rest(rest_) { }
+		
+		int operator*() const {
+			assert_ne(rest, 0);
+			return __builtin_ctz(rest);
+		}
+		
+		ConstIterator& operator++() {
+			rest &= rest - 1; ///< clear the lowest set bit
+			return *this;
+		}
+		
+		bool operator==(const ConstIterator& other) const {
+			return rest == other.rest;
+		}
+		
+		bool operator!=(const ConstIterator& other) const {
+			return !( (*this) == other );
+		}
+	
+	private:
+		Mask rest;
+	};
+	
+	
+	WaveIndices() = default;
+	
+	WaveIndices(std::initializer_list<int> list) {
+		for (const int i : list) {
+			insert(i);
+		}
+	}
+	
+	static WaveIndices fromMask(const Mask mask) {
+		WaveIndices ans;
+		ans.bits = mask;
+		return ans;
+	}
+	
+	Mask mask() const { return bits; }
+	
+	
+	void insert(const int i) {
+		assert_ge(i, 0);
+		assert_lt(i, MAX_SIZE);
+		bits |= (Mask(1) << i);
+	}
+	
+	bool has(const int i) const {
+		assert_ge(i, 0);
+		assert_lt(i, MAX_SIZE);
+		return (bits & (Mask(1) << i)) != 0;
+	}
+	
+	void clear() { bits = 0; }
+	
+	bool empty() const { return bits == 0; }
+	
+	/** Number of indices in the set */
+	int size() const { return __builtin_popcount(bits); }
+	
+	
+	ConstIterator begin() const { return ConstIterator(bits); }
+	ConstIterator end()   const { return ConstIterator(0); }
+	
+	
+	bool operator==(const WaveIndices& other) const {
+		return bits == other.bits;
+	}
+	
+	bool operator!=(const WaveIndices& other) const {
+		return !( (*this) == other );
+	}
+	
+	/** Union of sets */
+	WaveIndices operator|(const WaveIndices& other) const {
+		return fromMask(bits | other.bits);
+	}
+	
+	/** Intersection of sets */
+	WaveIndices operator&(const WaveIndices& other) const {
+		return fromMask(bits & other.bits);
+	}
+
+
+private:
+	Mask bits = 0;
+};
+	
+	
+}
+
+#endif // LIBGCM_WAVEINDICES_HPP
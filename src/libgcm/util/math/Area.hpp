@@ -2,6 +2,9 @@
 #define LIBGCM_AREA_HPP
 
 #include <libgcm/linal/linal.hpp>
+#include <libgcm/util/math/AABB.hpp>
+
+#include <limits>
 
 
 namespace gcm {
@@ -16,6 +19,11 @@ struct Area {
 	 * Move area on specified distances
 	 */
 	virtual void move(const Real3& shift) = 0;
+	
+	/**
+	 * AABB which contains the area (not necessarily the minimal one)
+	 */
+	virtual AxesAlignedBoundaryBox<Real3> boundingBox() const = 0;
 
 };
 
@@ -23,6 +31,10 @@ struct Area {
 struct InfiniteArea : public Area {
 	virtual bool contains(const Real3&) const override { return true; }
 	virtual void move(const Real3&) { }
+	virtual AxesAlignedBoundaryBox<Real3> boundingBox() const override {
+		const real inf = std::numeric_limits<real>::max();
+		return {{-inf, -inf, -inf}, {inf, inf, inf}};
+	}
 };
 
 
@@ -48,6 +60,10 @@ struct AxisAlignedBoxArea : public Area {
 	virtual void move(const Real3& shift) override {
 		min += shift; max += shift;
 	}
+	
+	virtual AxesAlignedBoundaryBox<Real3> boundingBox() const override {
+		return {min, max};
+	}
 
 	Real3 getMin() const { return min; }
 	Real3 getMax() const { return max; }
@@ -72,6 +88,10 @@ struct SphereArea : public Area {
 		center += shift;
 	}
 	
+	virtual AxesAlignedBoundaryBox<Real3> boundingBox() const override {
+		return {center - radius * Real3::Ones(), center + radius * Real3::Ones()};
+	}
+
 private:
 	real radius;
 	Real3 center;
@@ -111,6 +131,15 @@ public:
 	virtual void move(const Real3& shift) override {
 		begin += shift; end += shift;
 	}
+	
+	virtual AxesAlignedBoundaryBox<Real3> boundingBox() const override {
+		AxesAlignedBoundaryBox<Real3> ans;
+		for (int i = 0; i < 3; i++) {
+			ans.min(i) = std::min(begin(i), end(i)) - radius;
+			ans.max(i) = std::max(begin(i), end(i)) + radius;
+		}
+		return ans;
+	}
 
 private:
 	real radius;       ///< radius of cylinder
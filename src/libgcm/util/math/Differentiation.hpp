@@ -101,7 +101,15 @@ public:
 			
 			auto H = linal::linearLeastSquares(A, b, W); // gradient of gradient
 			
-			hessians[mesh.getIndex(v)] = {H(0)(0), (H(0)(1) + H(1)(0)) / 2.0, H(1)(1)};
+			/// symmetrize the estimation
+			PdeHessian& hessian = hessians[mesh.getIndex(v)];
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				for (int k = j; k < DIMENSIONALITY; k++) {
+					hessian(j, k) = H(j)(k);
+					hessian(j, k) += H(k)(j);
+					hessian(j, k) *= 0.5;
+				}
+			}
 		}
 	}
 	
@@ -18,6 +18,44 @@ localGcmStep(const TMatrix& U1, const TMatrix& U, const TMatrix& values)
 
 
 
+/**
+ * Matrix A of GcmMatrix. It is necessary to construct and check 
+ * the eigensystem only, so it can be not stored.
+ * @see GcmMatrices
+ */
+template<typename TMatrix, bool StoreA>
+struct GcmMatrixA {
+	/// matrix for some axis in PDE
+	/// A = U1 * L * U  and so right eigenvectors are columns of the U1.
+	TMatrix A;
+	
+	template<typename TDiagonalMatrix>
+	void checkA(const TMatrix& U, const TMatrix& U1, const TDiagonalMatrix& L,
+			const real eps) const {
+		// traces
+		assert_near(linal::trace(A), linal::trace(L), eps);
+		// eigenvectors
+		assert_true(linal::approximatelyEqual(A * U1, U1 * L, eps*1000));
+		// eigenraws
+		assert_true(linal::approximatelyEqual(U * A, L * U, eps*1000));
+		SUPPRESS_WUNUSED(U); SUPPRESS_WUNUSED(U1);
+		SUPPRESS_WUNUSED(L); SUPPRESS_WUNUSED(eps);
+	}
+	
+	void clearA() { linal::clear(A); }
+};
+
+template<typename TMatrix>
+struct GcmMatrixA<TMatrix, false> {
+	template<typename TDiagonalMatrix>
+	void checkA(const TMatrix&, const TMatrix&, const TDiagonalMatrix&,
+			const real) const { }
+	
+	void clearA() { }
+};
+
+
+
 /**
  * The PDE is like
  * \f[
@@ -28,19 +66,19 @@ localGcmStep(const TMatrix& U1, const TMatrix& U, const TMatrix& values)
  * The class represents \f$ A_i \f$ with their eigensystems.
  * @tparam M size of PDE
  * @tparam Dim number of GcmMatrixes
+ * @tparam StoreA whether to store matrices A. The lean variant without them
+ * is about one third smaller and is used to store matrices in meshes
  */
-template<int TM, int Dim>
+template<int TM, int Dim, bool StoreA = true>
 struct GcmMatrices {
 	static const int M = TM;
 	static const int D = Dim;
+	static const bool STORE_A = StoreA;
 	typedef linal::Matrix<D, D> MatrixDD;
 	typedef linal::Matrix<M, M> Matrix;
 
 	/** Matrix in PDE along some direction with its eigensystem */
-	struct GcmMatrix {
-		/// matrix for some axis in PDE // TODO - skip this in Release mode?
-		/// A = U1 * L * U  and so right eigenvectors are columns of the U1.
-		Matrix A;
+	struct GcmMatrix : public GcmMatrixA<Matrix, STORE_A> {
 		/// matrix of left eigenvectors (aka eigenstrings)
 		Matrix U;
 		/// matrix of right eigenvectors
@@ -58,18 +96,13 @@ struct GcmMatrices {
 		
 		/** @throw gcm::Exception */
 		void checkDecomposition(const real eps = EQUALITY_TOLERANCE) const {
-			// traces
-			assert_near(linal::trace(A), linal::trace(L), eps);
-			// eigenvectors
-			assert_true(linal::approximatelyEqual(A * U1, U1 * L, eps*1000));
-			// eigenraws
-			assert_true(linal::approximatelyEqual(U * A, L * U, eps*1000));
+			this->checkA(U, U1, L, eps);
 			// inverse matrices
 			assert_true(linal::approximatelyEqual(U * U1, Matrix::Identity(), eps*1000));
 		}
 		
 		void clear() {
-			linal::clear(A);
+			this->clearA();
 			linal::clear(L);
 			linal::clear(U1);
 			linal::clear(U);
@@ -77,6 +110,21 @@ struct GcmMatrices {
 	
 	};
 	
+	
+	GcmMatrices() = default;
+	
+	/** Copy of other gcm matrices without matrices A */
+	template<bool OtherStoreA>
+	explicit GcmMatrices(const GcmMatrices<M, D, OtherStoreA>& other) :
+			basis(other.basis) {
+		static_assert(!STORE_A, "Matrices A can not be restored");
+		for (int s = 0; s < D; s++) {
+			m[s].U = other.m[s].U;
+			m[s].U1 = other.m[s].U1;
+			m[s].L = other.m[s].L;
+		}
+	}
+	
 	/// Spatial basis gcm-matrices are written in
 	MatrixDD basis = MatrixDD::Zeros();
 	/// gcm-matrices which written in the basis above.
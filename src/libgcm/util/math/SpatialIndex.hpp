@@ -0,0 +1,275 @@
+#ifndef LIBGCM_SPATIALINDEX_HPP
+#define LIBGCM_SPATIALINDEX_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <libgcm/linal/linal.hpp>
+#include <libgcm/util/math/AABB.hpp>
+
+
+namespace gcm {
+
+/**
+ * Static spatial index of objects given by their AABBs.
+ * The space is divided into uniform grid of buckets, each object is
+ * stored in all buckets its AABB overlaps. Objects are addressed
+ * by their positions in the vector of AABBs the index is built from.
+ * All queries are read-only and thus thread-safe.
+ * @tparam Dimensionality space dimensionality
+ */
+template<int Dimensionality>
+class SpatialIndex {
+public:
+	static const int DIMENSIONALITY = Dimensionality;
+	typedef linal::Vector<DIMENSIONALITY>    RealD;
+	typedef linal::VectorInt<DIMENSIONALITY> IntD;
+	typedef AxesAlignedBoundaryBox<RealD>    Box;
+	
+	/// Index of object in the vector of AABBs the index is built from
+	typedef int Index;
+	static const Index NoIndex = -1;
+	
+	
+	/**
+	 * Build the index.
+	 * @param boxes AABBs of objects
+	 * @param objectsPerBucket desired average number of objects in bucket
+	 */
+	void build(const std::vector<Box>& boxes, const real objectsPerBucket = 2);
+	
+	
+	/**
+	 * Find any object which AABB contains the point with given tolerance
+	 * and which satisfies given predicate (e.g, a cell which really contains
+	 * the point with the same tolerance)
+	 * @return index of found object or NoIndex
+	 */
+	template<typename Predicate>
+	Index find(const RealD& point, const Predicate predicate,
+			const real tolerance = 0) const {
+		if (buckets.empty()) { return NoIndex; }
+		RealD shift;
+		for (int i = 0; i < DIMENSIONALITY; i++) { shift(i) = tolerance; }
+		Index ans = NoIndex;
+		/// with tolerance, the point can be out of the bucket of the object
+		forEachBucket(bucketOf(point - shift), bucketOf(point + shift),
+				[&](const size_t b) {
+			for (Index i = bucketsOffsets[b]; ans == NoIndex && i < bucketsOffsets[b + 1]; i++) {
+				const Index object = buckets[(size_t)i];
+				if (contains(boxes[(size_t)object], point, tolerance) && predicate(object)) {
+					ans = object;
+				}
+			}
+		});
+		return ans;
+	}
+	
+	
+	/**
+	 * Call visitor for all objects which AABBs intersect given box.
+	 * @note objects with non-point AABBs can be visited several times
+	 */
+	template<typename Visitor>
+	void forEachInBox(const Box& box, const Visitor visitor) const {
+		if (buckets.empty()) { return; }
+		const IntD minBucket = bucketOf(box.min), maxBucket = bucketOf(box.max);
+		forEachBucket(minBucket, maxBucket, [&](const size_t b) {
+			for (Index i = bucketsOffsets[b]; i < bucketsOffsets[b + 1]; i++) {
+				const Index object = buckets[(size_t)i];
+				if (intersects(boxes[(size_t)object], box)) { visitor(object); }
+			}
+		});
+	}
+	
+	
+	/**
+	 * Find the nearest object to the point in terms of given distance functor.
+	 * The distance must not be less than the distance from the point
+	 * to the object's AABB (e.g, point objects and euclidean distance).
+	 * @return index of found object or NoIndex if the index is empty
+	 */
+	template<typename Distance>
+	Index nearest(const RealD& point, const Distance distance) const {
+		if (buckets.empty()) { return NoIndex; }
+		const IntD center = bucketOf(point);
+		Index ans = NoIndex;
+		real minDistance = 0;
+		int maxRing = 0;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			maxRing = std::max(maxRing, std::max(center(i), dimensions(i) - 1 - center(i)));
+		}
+		
+		for (int ring = 0; ring <= maxRing; ring++) {
+			/// objects in buckets of this and next rings are not closer than that
+			if (ans != NoIndex && minDistance <= (ring - 1) * minimalBucketSize) {
+				break;
+			}
+			IntD min, max;
+			for (int i = 0; i < DIMENSIONALITY; i++) {
+				min(i) = center(i) - ring;
+				max(i) = center(i) + ring;
+			}
+			forEachBucket(min, max, [&](const size_t b) {
+				for (Index i = bucketsOffsets[b]; i < bucketsOffsets[b + 1]; i++) {
+					const Index object = buckets[(size_t)i];
+					const real d = distance(object);
+					if (ans == NoIndex || d < minDistance) {
+						ans = object;
+						minDistance = d;
+					}
+				}
+			}, ring);
+		}
+		return ans;
+	}
+
+
+private:
+	/// AABB of all objects
+	Box domain;
+	/// Number of buckets along each axis
+	IntD dimensions = IntD::Zeros();
+	/// Sizes of bucket along each axis
+	RealD bucketSizes = RealD::Zeros();
+	real minimalBucketSize = 0;
+	
+	/// objects of the bucket b are stored in buckets
+	/// between bucketsOffsets[b] and bucketsOffsets[b + 1]
+	std::vector<Index> bucketsOffsets;
+	std::vector<Index> buckets;
+	/// copy of objects AABBs
+	std::vector<Box> boxes;
+	
+	
+	static bool contains(const Box& box, const RealD& point, const real tolerance) {
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			if (point(i) < box.min(i) - tolerance ||
+			    point(i) > box.max(i) + tolerance) { return false; }
+		}
+		return true;
+	}
+	
+	static bool intersects(const Box& a, const Box& b) {
+		return Box::intersection(a, b).valid();
+	}
+	
+	/** Multiindex of the bucket containing the point (clamped to the domain) */
+	IntD bucketOf(const RealD& point) const {
+		IntD ans;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			const real x = (point(i) - domain.min(i)) / bucketSizes(i);
+			ans(i) = (x <= 0) ? 0 : (x >= dimensions(i) - 1) ?
+					dimensions(i) - 1 : (int) x;
+		}
+		return ans;
+	}
+	
+	size_t bucketIndex(const IntD& bucket) const {
+		size_t ans = 0;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			ans = ans * (size_t)dimensions(i) + (size_t)bucket(i);
+		}
+		return ans;
+	}
+	
+	/**
+	 * Call visitor for all buckets from min to max inclusive,
+	 * which are not closer than onlyRing to the center of the range
+	 * (in terms of maximal difference of multiindices)
+	 */
+	template<typename Visitor>
+	void forEachBucket(IntD min, IntD max, const Visitor visitor,
+			const int onlyRing = 0) const {
+		IntD center;
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			center(i) = (min(i) + max(i)) / 2;
+		}
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			min(i) = std::max(min(i), 0);
+			max(i) = std::min(max(i), dimensions(i) - 1);
+			if (min(i) > max(i)) { return; }
+		}
+		IntD b = min;
+		while (true) {
+			int ring = 0;
+			for (int i = 0; i < DIMENSIONALITY; i++) {
+				ring = std::max(ring, std::abs(b(i) - center(i)));
+			}
+			if (ring >= onlyRing) { visitor(bucketIndex(b)); }
+			
+			int i = DIMENSIONALITY - 1;
+			while (i >= 0 && b(i) == max(i)) {
+				b(i) = min(i);
+				i--;
+			}
+			if (i < 0) { break; }
+			b(i)++;
+		}
+	}
+};
+
+
+template<int Dimensionality>
+void SpatialIndex<Dimensionality>::
+build(const std::vector<Box>& boxes_, const real objectsPerBucket) {
+	boxes = boxes_;
+	buckets.clear();
+	bucketsOffsets.clear();
+	if (boxes.empty()) { return; }
+	
+	domain = boxes.front();
+	for (const Box& box : boxes) {
+		for (int i = 0; i < DIMENSIONALITY; i++) {
+			domain.min(i) = std::min(domain.min(i), box.min(i));
+			domain.max(i) = std::max(domain.max(i), box.max(i));
+		}
+	}
+	
+	/// choose cubic buckets to have objectsPerBucket objects in average
+	const RealD sizes = domain.sizes();
+	real maxSize = 0;
+	for (int i = 0; i < DIMENSIONALITY; i++) {
+		maxSize = std::max(maxSize, sizes(i));
+	}
+	real volume = 1;
+	for (int i = 0; i < DIMENSIONALITY; i++) {
+		volume *= std::max(sizes(i), maxSize * EQUALITY_TOLERANCE);
+	}
+	const real numberOfBuckets = std::max(1.0, (real)boxes.size() / objectsPerBucket);
+	const real h = std::pow(volume / numberOfBuckets, 1.0 / DIMENSIONALITY);
+	minimalBucketSize = std::numeric_limits<real>::max();
+	for (int i = 0; i < DIMENSIONALITY; i++) {
+		dimensions(i) = (h > 0) ? std::max(1, (int) std::ceil(sizes(i) / h)) : 1;
+		bucketSizes(i) = (sizes(i) > 0) ? sizes(i) / dimensions(i) : 1;
+		if (dimensions(i) > 1) {
+			minimalBucketSize = std::min(minimalBucketSize, bucketSizes(i));
+		}
+	}
+	
+	/// CSR-like storage: count objects in buckets, then fill in
+	const size_t totalBuckets = (size_t) linal::directProduct(dimensions);
+	bucketsOffsets.assign(totalBuckets + 1, 0);
+	for (const Box& box : boxes) {
+		forEachBucket(bucketOf(box.min), bucketOf(box.max), [&](const size_t b) {
+			bucketsOffsets[b + 1]++;
+		});
+	}
+	for (size_t b = 0; b < totalBuckets; b++) {
+		bucketsOffsets[b + 1] += bucketsOffsets[b];
+	}
+	buckets.resize((size_t)bucketsOffsets.back());
+	std::vector<Index> filled(bucketsOffsets.begin(), bucketsOffsets.end() - 1);
+	for (size_t object = 0; object < boxes.size(); object++) {
+		const Box& box = boxes[object];
+		forEachBucket(bucketOf(box.min), bucketOf(box.max), [&](const size_t b) {
+			buckets[(size_t)filled[b]++] = (Index)object;
+		});
+	}
+}
+
+
+}
+
+#endif // LIBGCM_SPATIALINDEX_HPP
@@ -0,0 +1,290 @@
+#ifndef LIBGCM_SIMPLEXBATCHINTERPOLATOR_HPP
+#define LIBGCM_SIMPLEXBATCHINTERPOLATOR_HPP
+
+#include <libgcm/linal/linal.hpp>
+
+#include <cmath>
+
+
+namespace gcm {
+
+/**
+ * Hybrid interpolation of vector values in triangles or tetrahedrons
+ * (the same as hybridInterpolate of TriangleInterpolator and
+ * TetrahedronInterpolator) for several query points at once.
+ * All components of the vector are processed by the same loops without
+ * branches: quadratic and linear interpolations are both evaluated and
+ * the limiter selects the answer, so the loops are vectorized.
+ * Third-order interpolation additionally uses Hessians in vertices.
+ * @tparam Dimensionality 2 for triangles, 3 for tetrahedrons
+ * @tparam TVector vector of values, linal::Vector<M>
+ */
+template<int Dimensionality, typename TVector>
+class SimplexBatchInterpolator {
+public:
+	static const int DIMENSIONALITY = Dimensionality;
+	static const int CELL_POINTS_NUMBER = DIMENSIONALITY + 1;
+	/// Number of components of values
+	static const int M = TVector::M;
+	
+	typedef linal::Vector<DIMENSIONALITY>               RealD;
+	typedef linal::Vector<CELL_POINTS_NUMBER>           Lambda;
+	typedef linal::VECTOR<DIMENSIONALITY, TVector>      Gradient;
+	typedef linal::SYMMETRIC_MATRIX<DIMENSIONALITY, TVector> Hessian;
+	
+	/** Query point in the cell and values in the cell vertices */
+	struct Query {
+		Lambda lambda;                                         ///< barycentric coordinates
+		RealD shift[(size_t)CELL_POINTS_NUMBER];               ///< query point minus vertices
+		const TVector* value[(size_t)CELL_POINTS_NUMBER];      ///< values in vertices
+		const Gradient* gradient[(size_t)CELL_POINTS_NUMBER];  ///< gradients in vertices
+		const Hessian* hessian[(size_t)CELL_POINTS_NUMBER];    ///< for third order only
+	};
+	
+	
+	/**
+	 * Interpolate in all query points
+	 * @param number number of queries
+	 * @param queries query points
+	 * @param results the answers, in the order of queries
+	 */
+	static void hybridInterpolate(
+			const int number, const Query queries[], TVector results[]) {
+		for (int k = 0; k < number; k++) {
+			hybridInterpolate(queries[k], results[k]);
+		}
+	}
+	
+	
+	/** Interpolate in one query point */
+	static void hybridInterpolate(const Query& query, TVector& result) {
+		assert_true(isInterpolation(query.lambda));
+		
+		/// the quadratic interpolation is
+		/// sum_i lambda_i * (v_i + (g_i, q - c_i) / 2)
+		real weight[(size_t)CELL_POINTS_NUMBER];
+		real gradientWeight[(size_t)CELL_POINTS_NUMBER][(size_t)DIMENSIONALITY];
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			weight[i] = query.lambda(i);
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				gradientWeight[i][j] = query.lambda(i) * query.shift[i](j) / 2;
+			}
+		}
+		
+		real linear[(size_t)M], quadratic[(size_t)M], minimum[(size_t)M], maximum[(size_t)M];
+		linearInterpolate(query, weight, linear, minimum, maximum);
+		
+		#pragma omp simd
+		for (int m = 0; m < M; m++) {
+			quadratic[m] = linear[m];
+		}
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			const Gradient& g = *query.gradient[i];
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				const TVector& gj = g(j);
+				#pragma omp simd
+				for (int m = 0; m < M; m++) {
+					quadratic[m] += gradientWeight[i][j] * gj(m);
+				}
+			}
+		}
+		
+		/// the limiter switches all components to the linear interpolation
+		/// if any of them is out of the range of values in vertices
+		const real* const selected =
+				isInRange(quadratic, minimum, maximum) ? quadratic : linear;
+		for (int m = 0; m < M; m++) {
+			result(m) = selected[m];
+		}
+	}
+	
+	
+	/**
+	 * Third-order interpolation in all query points
+	 * @param number number of queries
+	 * @param queries query points with Hessians
+	 * @param results the answers, in the order of queries
+	 */
+	static void hybridCubicInterpolate(
+			const int number, const Query queries[], TVector results[]) {
+		for (int k = 0; k < number; k++) {
+			hybridCubicInterpolate(queries[k], results[k]);
+		}
+	}
+	
+	
+	/** Third-order interpolation in one query point */
+	static void hybridCubicInterpolate(const Query& query, TVector& result) {
+		assert_true(isInterpolation(query.lambda));
+		
+		/// the cubic interpolation is
+		/// sum_i lambda_i * (v_i + 2 (g_i, q - c_i) / 3 + (q - c_i, H_i (q - c_i)) / 6),
+		/// it is exact for cubic polynomials, while the quadratic one
+		/// (with 1/2 instead of 2/3 and without Hessians) is for quadratic ones
+		real weight[(size_t)CELL_POINTS_NUMBER];
+		real gradientWeight[(size_t)CELL_POINTS_NUMBER][(size_t)DIMENSIONALITY];
+		/// weights of (q - c_i, H_i (q - c_i)) / 2
+		real hessianWeight[(size_t)CELL_POINTS_NUMBER][(size_t)Hessian::SIZE];
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			const RealD& d = query.shift[i];
+			weight[i] = query.lambda(i);
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				gradientWeight[i][j] = query.lambda(i) * d(j);
+				for (int l = j; l < DIMENSIONALITY; l++) {
+					/// non-diagonal elements are stored once but counted twice
+					hessianWeight[i][Hessian::Symmetry::getIndex(j, l)] =
+							d(j) * d(l) * ((j == l) ? 1 : 2) / 2;
+				}
+			}
+		}
+		
+		real linear[(size_t)M], minimum[(size_t)M], maximum[(size_t)M];
+		linearInterpolate(query, weight, linear, minimum, maximum);
+		
+		/// sum of lambda_i * (g_i, q - c_i) and sum of the Hessian terms
+		real gradientTerm[(size_t)M], hessianTerm[(size_t)M];
+		/// range of Laplacians in vertices
+		real minCurvature[(size_t)M], maxCurvature[(size_t)M];
+		/// maximal second-order term of the Taylor expansions from vertices
+		real secondOrderTerm[(size_t)M];
+		#pragma omp simd
+		for (int m = 0; m < M; m++) {
+			gradientTerm[m] = hessianTerm[m] = secondOrderTerm[m] = 0;
+		}
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			const Gradient& g = *query.gradient[i];
+			for (int j = 0; j < DIMENSIONALITY; j++) {
+				const TVector& gj = g(j);
+				#pragma omp simd
+				for (int m = 0; m < M; m++) {
+					gradientTerm[m] += gradientWeight[i][j] * gj(m);
+				}
+			}
+			const Hessian& h = *query.hessian[i];
+			real secondOrder[(size_t)M];
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				secondOrder[m] = 0;
+			}
+			for (int j = 0; j < Hessian::SIZE; j++) {
+				const TVector& hj = h(j);
+				#pragma omp simd
+				for (int m = 0; m < M; m++) {
+					secondOrder[m] += hessianWeight[i][j] * hj(m);
+				}
+			}
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				hessianTerm[m] += query.lambda(i) * secondOrder[m] / 3;
+				secondOrderTerm[m] = std::fmax(secondOrderTerm[m], std::fabs(secondOrder[m]));
+			}
+			real curvature[(size_t)M];
+			laplacian(h, curvature);
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				minCurvature[m] = (i == 0 || curvature[m] < minCurvature[m]) ?
+						curvature[m] : minCurvature[m];
+				maxCurvature[m] = (i == 0 || curvature[m] > maxCurvature[m]) ?
+						curvature[m] : maxCurvature[m];
+			}
+		}
+		
+		real cubic[(size_t)M], quadratic[(size_t)M];
+		#pragma omp simd
+		for (int m = 0; m < M; m++) {
+			cubic[m] = linear[m] + gradientTerm[m] * 2 / 3 + hessianTerm[m];
+			quadratic[m] = linear[m] + gradientTerm[m] / 2;
+		}
+		
+		/// a component may leave the range of values in vertices near its
+		/// smooth extremum: the Laplacians in all vertices are of the same sign
+		/// and differ less than twice (M2 detection of smooth extrema in MOOD
+		/// methods), that is not the case near discontinuities; but not farther
+		/// than by the second-order term of the Taylor expansion from a vertex
+		real cubicMinimum[(size_t)M], cubicMaximum[(size_t)M];
+		#pragma omp simd
+		for (int m = 0; m < M; m++) {
+			const bool smoothExtremum =
+					(minCurvature[m] > 0 && 2 * minCurvature[m] >= maxCurvature[m]) ||
+					(maxCurvature[m] < 0 && 2 * maxCurvature[m] <= minCurvature[m]);
+			const real relaxation = smoothExtremum ? secondOrderTerm[m] : 0;
+			cubicMinimum[m] = minimum[m] - relaxation;
+			cubicMaximum[m] = maximum[m] + relaxation;
+		}
+		
+		/// the limiter falls back to the quadratic interpolation and then
+		/// to the linear one if any component is out of the range
+		const real* selected = linear;
+		if (isInRange(cubic, cubicMinimum, cubicMaximum)) {
+			selected = cubic;
+		} else if (isInRange(quadratic, minimum, maximum)) {
+			selected = quadratic;
+		}
+		for (int m = 0; m < M; m++) {
+			result(m) = selected[m];
+		}
+	}
+	
+	
+	/** Interpolation or extrapolation */
+	static bool isInterpolation(const Lambda& lambda) {
+		for (int i = 0; i < CELL_POINTS_NUMBER; i++) {
+			if (lambda(i) <= -EQUALITY_TOLERANCE) { return false; }
+		}
+		return true;
+	}
+
+
+private:
+	/** Linear interpolation and the range of values in vertices */
+	static void linearInterpolate(const Query& query,
+			const real weight[], real linear[], real minimum[], real maximum[]) {
+		{
+			const TVector& v = *query.value[0];
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				linear[m] = weight[0] * v(m);
+				minimum[m] = maximum[m] = v(m);
+			}
+		}
+		for (int i = 1; i < CELL_POINTS_NUMBER; i++) {
+			const TVector& v = *query.value[i];
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				linear[m] += weight[i] * v(m);
+				minimum[m] = (v(m) < minimum[m]) ? v(m) : minimum[m];
+				maximum[m] = (v(m) > maximum[m]) ? v(m) : maximum[m];
+			}
+		}
+	}
+	
+	/** Trace of the Hessian for all components */
+	static void laplacian(const Hessian& hessian, real trace[]) {
+		#pragma omp simd
+		for (int m = 0; m < M; m++) {
+			trace[m] = 0;
+		}
+		for (int j = 0; j < DIMENSIONALITY; j++) {
+			const TVector& hjj = hessian(j, j);
+			#pragma omp simd
+			for (int m = 0; m < M; m++) {
+				trace[m] += hjj(m);
+			}
+		}
+	}
+	
+	/** Whether all components of the value are in the range */
+	static bool isInRange(const real value[], const real minimum[], const real maximum[]) {
+		int outOfRange = 0;
+		#pragma omp simd reduction(|:outOfRange)
+		for (int m = 0; m < M; m++) {
+			outOfRange |= (value[m] < minimum[m]) | (value[m] > maximum[m]);
+		}
+		return !outOfRange;
+	}
+};
+
+
+}
+
+#endif // LIBGCM_SIMPLEXBATCHINTERPOLATOR_HPP
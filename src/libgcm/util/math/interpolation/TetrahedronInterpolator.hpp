@@ -29,12 +29,8 @@ public:
 	                          const Real3& c2, const TValue v2,
 	                          const Real3& c3, const TValue v3,
 	                          const Real3& q) {
-		Real4 lambda = linal::barycentricCoordinates(c0, c1, c2, c3, q);
-		assert_true(isInterpolation(lambda));
-		return lambda(0) * v0 + 
-		       lambda(1) * v1 + 
-		       lambda(2) * v2 +
-		       lambda(3) * v3;
+		return interpolate(linal::barycentricCoordinates(c0, c1, c2, c3, q),
+				v0, v1, v2, v3);
 	}
 	
 	
@@ -51,12 +47,8 @@ public:
 			const Real3& c2, const TValue v2, const Gradient g2,
 			const Real3& c3, const TValue v3, const Gradient g3,
 			const Real3& q) {
-		Real4 lambda = linal::barycentricCoordinates(c0, c1, c2, c3, q);
-		assert_true(isInterpolation(lambda));
-		return lambda(0) * (v0 + linal::dotProduct(g0, q - c0) / 2.0) +
-		       lambda(1) * (v1 + linal::dotProduct(g1, q - c1) / 2.0) +
-		       lambda(2) * (v2 + linal::dotProduct(g2, q - c2) / 2.0) +
-		       lambda(3) * (v3 + linal::dotProduct(g3, q - c3) / 2.0);
+		return interpolate(linal::barycentricCoordinates(c0, c1, c2, c3, q),
+				c0, v0, g0, c1, v1, g1, c2, v2, g2, c3, v3, g3, q);
 	}
 	
 	
@@ -96,12 +88,51 @@ public:
 			const Real3& c2, const TValue v2, const Gradient g2,
 			const Real3& c3, const TValue v3, const Gradient g3,
 			const Real3& q) {
-		TValue quadratic = interpolate(
+		return hybridInterpolate(linal::barycentricCoordinates(c0, c1, c2, c3, q),
+				c0, v0, g0, c1, v1, g1, c2, v2, g2, c3, v3, g3, q);
+	}
+	
+	
+	/**
+	 * The same interpolations by known barycentric coordinates lambda
+	 * of the query point q, e.g. from the cache of the grid
+	 */
+	///@{
+	static TValue interpolate(const Real4& lambda,
+			const TValue v0, const TValue v1, const TValue v2, const TValue v3) {
+		assert_true(isInterpolation(lambda));
+		return lambda(0) * v0 +
+		       lambda(1) * v1 +
+		       lambda(2) * v2 +
+		       lambda(3) * v3;
+	}
+	
+	static TValue interpolate(const Real4& lambda,
+			const Real3& c0, const TValue v0, const Gradient g0,
+			const Real3& c1, const TValue v1, const Gradient g1,
+			const Real3& c2, const TValue v2, const Gradient g2,
+			const Real3& c3, const TValue v3, const Gradient g3,
+			const Real3& q) {
+		assert_true(isInterpolation(lambda));
+		return lambda(0) * (v0 + linal::dotProduct(g0, q - c0) / 2.0) +
+		       lambda(1) * (v1 + linal::dotProduct(g1, q - c1) / 2.0) +
+		       lambda(2) * (v2 + linal::dotProduct(g2, q - c2) / 2.0) +
+		       lambda(3) * (v3 + linal::dotProduct(g3, q - c3) / 2.0);
+	}
+	
+	static TValue hybridInterpolate(const Real4& lambda,
+			const Real3& c0, const TValue v0, const Gradient g0,
+			const Real3& c1, const TValue v1, const Gradient g1,
+			const Real3& c2, const TValue v2, const Gradient g2,
+			const Real3& c3, const TValue v3, const Gradient g3,
+			const Real3& q) {
+		TValue quadratic = interpolate(lambda,
 				c0, v0, g0, c1, v1, g1, c2, v2, g2, c3, v3, g3, q);
 		TValue minMaxLimited = linal::limiterMinMax(quadratic, v0, v1, v2, v3);
 		return (quadratic == minMaxLimited) ?
-				quadratic : interpolate(c0, v0, c1, v1, c2, v2, c3, v3, q);
+				quadratic : interpolate(lambda, v0, v1, v2, v3);
 	}
+	///@}
 	
 	
 	/**
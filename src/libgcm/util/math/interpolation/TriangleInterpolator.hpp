@@ -27,11 +27,8 @@ public:
 	                          const Real2& c1, const TValue v1,
 	                          const Real2& c2, const TValue v2,
 	                          const Real2& q) {
-		Real3 lambda = linal::barycentricCoordinates(c0, c1, c2, q);
-		assert_true(isInterpolation(lambda));
-		return lambda(0) * v0 + 
-		       lambda(1) * v1 + 
-		       lambda(2) * v2;
+		return interpolate(linal::barycentricCoordinates(c0, c1, c2, q),
+				v0, v1, v2);
 	}
 	
 	
@@ -47,11 +44,8 @@ public:
 			const Real2& c1, const TValue v1, const Gradient g1,
 			const Real2& c2, const TValue v2, const Gradient g2,
 			const Real2& q) {
-		Real3 lambda = linal::barycentricCoordinates(c0, c1, c2, q);
-		assert_true(isInterpolation(lambda));
-		return lambda(0) * (v0 + linal::dotProduct(g0, q - c0) / 2.0) +
-		       lambda(1) * (v1 + linal::dotProduct(g1, q - c1) / 2.0) +
-		       lambda(2) * (v2 + linal::dotProduct(g2, q - c2) / 2.0);
+		return interpolate(linal::barycentricCoordinates(c0, c1, c2, q),
+				c0, v0, g0, c1, v1, g1, c2, v2, g2, q);
 	}
 	
 	
@@ -89,12 +83,47 @@ public:
 			const Real2& c1, const TValue v1, const Gradient g1,
 			const Real2& c2, const TValue v2, const Gradient g2,
 			const Real2& q) {
-		TValue quadratic = interpolate(
+		return hybridInterpolate(linal::barycentricCoordinates(c0, c1, c2, q),
+				c0, v0, g0, c1, v1, g1, c2, v2, g2, q);
+	}
+	
+	
+	/**
+	 * The same interpolations by known barycentric coordinates lambda
+	 * of the query point q, e.g. from the cache of the grid
+	 */
+	///@{
+	static TValue interpolate(const Real3& lambda,
+			const TValue v0, const TValue v1, const TValue v2) {
+		assert_true(isInterpolation(lambda));
+		return lambda(0) * v0 +
+		       lambda(1) * v1 +
+		       lambda(2) * v2;
+	}
+	
+	static TValue interpolate(const Real3& lambda,
+			const Real2& c0, const TValue v0, const Gradient g0,
+			const Real2& c1, const TValue v1, const Gradient g1,
+			const Real2& c2, const TValue v2, const Gradient g2,
+			const Real2& q) {
+		assert_true(isInterpolation(lambda));
+		return lambda(0) * (v0 + linal::dotProduct(g0, q - c0) / 2.0) +
+		       lambda(1) * (v1 + linal::dotProduct(g1, q - c1) / 2.0) +
+		       lambda(2) * (v2 + linal::dotProduct(g2, q - c2) / 2.0);
+	}
+	
+	static TValue hybridInterpolate(const Real3& lambda,
+			const Real2& c0, const TValue v0, const Gradient g0,
+			const Real2& c1, const TValue v1, const Gradient g1,
+			const Real2& c2, const TValue v2, const Gradient g2,
+			const Real2& q) {
+		TValue quadratic = interpolate(lambda,
 				c0, v0, g0, c1, v1, g1, c2, v2, g2, q);
 		TValue minMaxLimited = linal::limiterMinMax(quadratic, v0, v1, v2);
 		return (quadratic == minMaxLimited) ?
-				quadratic : interpolate(c0, v0, c1, v1, c2, v2, q);
+				quadratic : interpolate(lambda, v0, v1, v2);
 	}
+	///@}
 	
 	
 	/**
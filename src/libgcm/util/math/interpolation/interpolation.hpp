@@ -4,5 +4,6 @@
 #include <libgcm/util/math/interpolation/EqualDistanceLineInterpolator.hpp>
 #include <libgcm/util/math/interpolation/TriangleInterpolator.hpp>
 #include <libgcm/util/math/interpolation/TetrahedronInterpolator.hpp>
+#include <libgcm/util/math/interpolation/SimplexBatchInterpolator.hpp>
 
 #endif // LIBGCM_INTERPOLATION_HPP
@@ -1,5 +1,6 @@
 #include <libgcm/util/snapshot/VtkUtils.hpp>
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
 #include <libgcm/grid/cubic/CubicGrid.hpp>
 #include <libgcm/grid/simplex/SimplexGrid.hpp>
 
@@ -37,7 +38,7 @@ void writeGeometry(const SimplexGrid<D, TriangulationT>& gcmGrid,
 		vtkSmartPointer<vtkUnstructuredGrid> vtkGrid) {
 	writeVertices(gcmGrid, vtkGrid);
 	writeCells(gcmGrid, vtkGrid);
-	typedef typename SimplexGrid<D, CgalTriangulation>::VtkIterator VtkIter;
+	typedef typename SimplexGrid<D, TriangulationT>::VtkIterator VtkIter;
 	vtk_utils::addFieldToVertices(
 			1, "index_of_node",
 			[&](vtkSmartPointer<vtkFloatArray> vtkArr, VtkIter it) {
@@ -180,6 +181,10 @@ template void writeGeometry(const SimplexGrid<2, CgalTriangulation>& gcmGrid,
 		vtkSmartPointer<vtkUnstructuredGrid> vtkGrid);
 template void writeGeometry(const SimplexGrid<3, CgalTriangulation>& gcmGrid,
 		vtkSmartPointer<vtkUnstructuredGrid> vtkGrid);
+template void writeGeometry(const SimplexGrid<2, FlatTriangulation>& gcmGrid,
+		vtkSmartPointer<vtkUnstructuredGrid> vtkGrid);
+template void writeGeometry(const SimplexGrid<3, FlatTriangulation>& gcmGrid,
+		vtkSmartPointer<vtkUnstructuredGrid> vtkGrid);
 
 } // namespace vtk_utils
 } // namespace gcm
@@ -26,10 +26,10 @@ public:
 		
 		for (const auto& it : *mesh) {
 			linal::clear(mesh->_pde(it));
-			for (const auto& condition : conditions) {
-				if (condition.area->contains(mesh->coords(it))) {
-					mesh->_pde(it) += condition.pdeVector;
-				}
+		}
+		for (const auto& condition : conditions) {
+			for (const auto& it : mesh->findVerticesInside(*condition.area)) {
+				mesh->_pde(it) += condition.pdeVector;
 			}
 		}
 		
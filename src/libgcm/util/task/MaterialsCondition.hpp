@@ -23,12 +23,10 @@ public:
 	static void apply(const Task& task, Mesh* mesh) {
 		Conditions conditions = convertToLocalFormat(task, mesh->id);
 		
-		for (const auto& it : *mesh) {
-			for (const auto& condition : conditions) {
-				if (condition.area->contains(mesh->coords(it))) {
-					mesh->_material(it) = condition.material;
-					mesh->_matrices(it) = condition.matrices;
-				}
+		for (const auto& condition : conditions) {
+			for (const auto& it : mesh->findVerticesInside(*condition.area)) {
+				mesh->_material(it) = condition.material;
+				mesh->_matrices(it) = condition.matrices;
 			}
 		}
 		
@@ -86,26 +86,63 @@ struct Task {
 		enum class Mesher {
 			CGAL_MESHER,
 			INM_MESHER,
+			BINARY_MESHER, ///< read prepared mesh (@see BinaryMeshLoader)
 		} mesher = Mesher::CGAL_MESHER;
 		
+		/// Triangulation data structure used in calculations
+		enum class Triangulation {
+			CGAL,  ///< CGAL triangulation created by mesher
+			FLAT,  ///< contiguous arrays copied from the CGAL one after meshing
+			       ///< (INM meshes are imported directly, without CGAL)
+		} triangulation = Triangulation::CGAL;
+		
 		/// effective spatial step for mesher
 		real spatialStep = 0;
 		
+		/// options for CGAL meshers only - wave-speed-aware sizing
+		/// (@see MeshSizing). If both are positive, the local spatial step is
+		/// the wavelength of the slowest wave of the local material at
+		/// sourceFrequency divided by nodesPerWavelength. Then spatialStep,
+		/// if positive, is the upper bound of the local spatial step
+		real nodesPerWavelength = 0;
+		real sourceFrequency = 0;
+		
 		/// option for Cgal3DMesher only - use true for figures with sharp edges
 		bool detectSharpEdges = false; 
 		
+		/// option for Cgal3DMesher only - mesh by all threads (CGAL must be
+		/// linked with TBB). The mesh is not reproducible from run to run then
+		bool parallelMeshing = false;
+		
 		/// file with some initial data for mesher
 		std::string fileName;
 		
 		/// denominator to scale the points after meshing
 		real scale = 1;
 		
+		/// Directory to store prepared FLAT triangulations in. Triangulation
+		/// built once for the same mesher input is read from there instead
+		/// of meshing it again. Empty string turns caching off. Triangulations
+		/// sized by materials given in areas are not cached.
+		std::string triangulationCacheDirectory;
+		
 		/// On/off deformations and bodies motion
 		bool movable = false;
 		
 		/// Method of border and contact nodes calculation
 		BorderCalcMode borderCalcMode = BorderCalcMode::GLOBAL_BASIS;
 		
+		/// Maximal level of local time stepping: inner nodes with large cells
+		/// are advanced with time steps up to 2^maxTimeLevel times larger
+		/// than the finest one. Zero turns local time stepping off.
+		int maxTimeLevel = 0;
+		
+		/// Order of interpolation in cells: 2 - quadratic by gradients,
+		/// 3 - cubic by gradients and Hessians (GcmType::ADVECT_PDE_VECTORS only).
+		/// Both fall back to lower orders near discontinuities. Third order
+		/// reaches the same accuracy on coarser meshes at higher cost per node
+		int interpolationOrder = 2;
+		
 		
 		/// for Cgal2DMesher only @{
 		struct Body {
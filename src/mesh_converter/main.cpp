@@ -0,0 +1,57 @@
+#include <getopt.h>
+#include <string>
+
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
+#include <libgcm/grid/simplex/mesh_loaders/BinaryMeshLoader.hpp>
+#include <libgcm/grid/simplex/VertexInfoAndCellInfo.hpp>
+
+
+using namespace gcm;
+
+/**
+ * Convert 3D mesh to the binary format (@see BinaryMeshLoader).
+ * Input is INM mesh or OFF surface to be meshed by CGAL.
+ */
+int main(int argc, char** argv) {
+	USE_AND_INIT_LOGGER("gcm.mesh_converter");
+	
+	std::string input, output;
+	Task task;
+	static struct option long_options[] = {
+		{"input",  required_argument, 0, 'i'},
+		{"output", required_argument, 0, 'o'},
+		{"step",   required_argument, 0, 's'},
+		{"sharp",  no_argument,       0, 'e'},
+		{0, 0, 0, 0}
+	};
+	int c, option_index = 0;
+	while ((c = getopt_long_only(argc, argv, "i:o:s:e", long_options, &option_index)) != -1) {
+		switch (c) {
+			case 'i': input = optarg; break;
+			case 'o': output = optarg; break;
+			case 's': task.simplexGrid.spatialStep = std::stod(optarg); break;
+			case 'e': task.simplexGrid.detectSharpEdges = true; break;
+			default: break;
+		}
+	}
+	if (input.empty() || output.empty()) {
+		LOG_FATAL("Usage: " << argv[0] << " -input mesh.out|surface.off -output mesh.bin"
+				<< " [-step spatialStep (for .off)] [-sharp (detect sharp edges)]");
+		return -1;
+	}
+	
+	const bool isOff = input.size() > 4 && input.substr(input.size() - 4) == ".off";
+	task.simplexGrid.mesher = isOff ?
+			Task::SimplexGrid::Mesher::CGAL_MESHER : Task::SimplexGrid::Mesher::INM_MESHER;
+	task.simplexGrid.fileName = input;
+	
+	try {
+		FlatTriangulation<3, VertexInfo, CellInfoT<4>> triangulation(task);
+		BinaryMeshLoader::write(output, triangulation);
+		LOG_INFO("Mesh is written to " << output);
+	} catch (Exception e) {
+		LOG_FATAL(e.what());
+		return -1;
+	}
+	return 0;
+}
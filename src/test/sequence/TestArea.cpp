@@ -2,6 +2,7 @@
 
 #include <libgcm/util/math/Area.hpp>
 #include <libgcm/util/math/AABB.hpp>
+#include <libgcm/util/Utils.hpp>
 
 using namespace gcm;
 
@@ -109,3 +110,32 @@ TEST(AxesAlignedBoundaryBox, intersection) {
 }
 
 
+
+
+TEST(Area, boundingBox) {
+	std::vector<std::shared_ptr<Area>> areas = {
+		std::make_shared<AxisAlignedBoxArea>(Real3({-5, 0, 2}), Real3({-3, 2, 4})),
+		std::make_shared<SphereArea>(2, Real3({1, 2, 3})),
+		std::make_shared<StraightBoundedCylinderArea>(
+				1, Real3({0, 0, 0}), Real3({1, 2, -3})),
+	};
+	for (const auto area : areas) {
+		const AxesAlignedBoundaryBox<Real3> box = area->boundingBox();
+		ASSERT_TRUE(box.valid());
+		for (int i = 0; i < 1000; i++) {
+			const Real3 point = {Utils::randomReal(-10, 10),
+			                     Utils::randomReal(-10, 10),
+			                     Utils::randomReal(-10, 10)};
+			if (area->contains(point)) {
+				for (int j = 0; j < 3; j++) {
+					ASSERT_GE(point(j), box.min(j));
+					ASSERT_LE(point(j), box.max(j));
+				}
+			}
+		}
+	}
+	
+	SphereArea sphere(2, {1, 2, 3});
+	ASSERT_EQ(Real3({-1, 0, 1}), sphere.boundingBox().min);
+	ASSERT_EQ(Real3({ 3, 4, 5}), sphere.boundingBox().max);
+}
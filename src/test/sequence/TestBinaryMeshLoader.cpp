@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <libgcm/grid/simplex/mesh_loaders/BinaryMeshLoader.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
+#include <libgcm/grid/simplex/VertexInfoAndCellInfo.hpp>
+
+using namespace gcm;
+
+typedef FlatTriangulation<3, VertexInfo, CellInfoT<4>> Triangulation;
+
+
+TEST(BinaryMeshLoader, convertInm) {
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::INM_MESHER;
+	task.simplexGrid.fileName = "meshes/testInmLoader.out";
+	Triangulation inm(task);
+	const std::string fileName = "snapshots/testInmLoader.bin";
+	BinaryMeshLoader::write(fileName, inm);
+
+	const BinaryMeshLoader mesh(fileName);
+	ASSERT_EQ(3, mesh.dimensionality());
+	ASSERT_EQ(12, mesh.numberOfPoints());
+	ASSERT_EQ(3, mesh.numberOfCells());
+	ASSERT_TRUE(mesh.hasMaterials());
+	ASSERT_TRUE(mesh.hasNeighbors());
+	for (size_t c = 0; c < mesh.numberOfCells(); c++) {
+		for (int i = 0; i < 4; i++) {
+			ASSERT_EQ(BinaryMeshLoader::NoNeighbor, mesh.neighbor(c, i));
+		}
+	}
+	ASSERT_NEAR(-2.583210754394531250e+01, mesh.point(3)[0], EQUALITY_TOLERANCE);
+
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::BINARY_MESHER;
+	task.simplexGrid.fileName = fileName;
+	Triangulation binary(task);
+	auto b = binary.allCellsBegin();
+	for (auto a = inm.allCellsBegin(); a != inm.allCellsEnd(); ++a, ++b) {
+		ASSERT_EQ(a->info().getGridId(), b->info().getGridId());
+		for (int i = 0; i < 4; i++) {
+			ASSERT_EQ(a->vertex(i).getIndex(), b->vertex(i).getIndex());
+			ASSERT_EQ(a->neighbor(i).getIndex(), b->neighbor(i).getIndex());
+			if (!inm.isInfinite(a)) {
+				ASSERT_EQ(Triangulation::coordsD(a->vertex(i)),
+				          Triangulation::coordsD(b->vertex(i)));
+			}
+		}
+	}
+	ASSERT_EQ(binary.allCellsEnd(), b);
+}
+
+
+TEST(BinaryMeshLoader, neighbors) {
+	const std::string fileName = "snapshots/twoTetrahedrons.bin";
+	BinaryMeshLoader::write(fileName, 3,
+			{0, 0, 0,  1, 0, 0,  0, 1, 0,  0, 0, 1,  1, 1, 1},
+			{0, 1, 2, 3,  4, 3, 2, 1},
+			{},
+			{1, -1, -1, -1,  0, -1, -1, -1});
+
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::BINARY_MESHER;
+	task.simplexGrid.fileName = fileName;
+	Triangulation triangulation(task);
+
+	/// two tetrahedra with the common face are closed by six infinite cells
+	ASSERT_EQ(8, triangulation.allCellsEnd().getIndex());
+	const auto first = triangulation.allCellsBegin();
+	auto second = first; ++second;
+	ASSERT_EQ(second, first->neighbor(0));
+	ASSERT_EQ(first, second->neighbor(0));
+	ASSERT_EQ(0, second->info().getGridId());
+	for (auto c = triangulation.allCellsBegin(); c != triangulation.allCellsEnd(); ++c) {
+		for (int i = 0; i < 4; i++) {
+			const auto neighbor = c->neighbor(i);
+			ASSERT_EQ(c, neighbor->neighbor(neighbor->index(c)));
+		}
+	}
+
+	BinaryMeshLoader::write(fileName, 3,
+			{0, 0, 0,  1, 0, 0,  0, 1, 0,  0, 0, 1,  1, 1, 1},
+			{0, 1, 2, 3,  4, 3, 2, 1},
+			{},
+			{1, -1, -1, -1,  -1, -1, -1, -1});
+	ASSERT_THROW(Triangulation{task}, Exception);
+}
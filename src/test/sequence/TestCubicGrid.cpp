@@ -4,6 +4,7 @@
 #include <libgcm/grid/cubic/CubicGrid.hpp>
 #include <libgcm/engine/cubic/DefaultMesh.hpp>
 #include <libgcm/rheology/models/models.hpp>
+#include <libgcm/rheology/ode/Ode.hpp>
 
 
 using namespace gcm;
@@ -37,6 +38,147 @@ TEST(CubicGrid, initialize) {
 }
 
 
+TEST(CubicGrid, odeVariables) {
+	Task task;
+	task.bodies = {{0, {Materials::T::ISOTROPIC, Models::T::ELASTIC,
+			{Odes::T::CONTINUAL_DAMAGE}}}};
+	task.materialConditions.byAreas.defaultMaterial =
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5);
+	/// only the left part of the mesh is damageable
+	task.materialConditions.byAreas.materials.push_back({
+			std::make_shared<AxisAlignedBoxArea>(
+					Real3({-1, -1, -1}), Real3({2.5, 10, 1})),
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5, 0, 0.1)});
+	Task::InitialCondition::Quantity quantity;
+	quantity.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	quantity.value = 2;
+	quantity.area = std::make_shared<InfiniteArea>();
+	task.initialCondition.quantities.push_back(quantity);
+	
+	typedef CubicGrid<2> Grid;
+	typedef DefaultMesh<ElasticModel<2>, Grid, IsotropicMaterial> Mesh;
+	typedef typename Grid::ConstructionPack ConstructionPack;
+	ConstructionPack cp;
+	cp.borderSize = 1;
+	cp.sizes = {7, 9};
+	cp.h = {1, 1};
+	
+	Mesh mesh(task, 0, cp, 1);
+	mesh.setUpPde(task);
+	const Mesh::OdeVariables& odeVars = mesh.odeVars();
+	ASSERT_EQ(3 * 9, odeVars.size());
+	ASSERT_TRUE(odeVars.plasticStrain.empty());
+	for (int x = 0; x < cp.sizes(0); x++) {
+		for (int y = 0; y < cp.sizes(1); y++) {
+			ASSERT_EQ(x < 3, odeVars.hasSlot(mesh.getIndex({x, y})));
+		}
+	}
+	
+	ContinualDamageOde<Mesh>().apply(mesh, 0.5);
+	for (size_t k = 0; k < odeVars.size(); k++) {
+		ASSERT_NEAR(0.5 * 0.1 * 2, odeVars.damage[k], EQUALITY_TOLERANCE);
+	}
+}
+
+
+TEST(CubicGrid, idealPlasticFlow) {
+	Task task;
+	task.bodies = {{0, {Materials::T::ISOTROPIC, Models::T::ELASTIC,
+			{Odes::T::IDEAL_PLASTIC_FLOW}}}};
+	task.materialConditions.byAreas.defaultMaterial =
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5);
+	/// only the left part of the mesh is plastic
+	task.materialConditions.byAreas.materials.push_back({
+			std::make_shared<AxisAlignedBoxArea>(
+					Real3({-1, -1, -1}), Real3({2.5, 10, 1})),
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5, 1)});
+	
+	typedef CubicGrid<2> Grid;
+	typedef DefaultMesh<ElasticModel<2>, Grid, IsotropicMaterial> Mesh;
+	typedef typename Grid::ConstructionPack ConstructionPack;
+	ConstructionPack cp;
+	cp.borderSize = 1;
+	cp.sizes = {7, 9};
+	cp.h = {1, 1};
+	
+	Mesh mesh(task, 0, cp, 1);
+	mesh.setUpPde(task);
+	const Mesh::OdeVariables& odeVars = mesh.odeVars();
+	ASSERT_EQ(3 * 9, odeVars.size());
+	ASSERT_TRUE(odeVars.damage.empty());
+	
+	/// pressure 1 and J2 = sqrt(8) above the yield strength 1
+	const ElasticModel<2>::SigmaD sigma({1, 2, -3});
+	for (const auto& it : mesh) {
+		mesh._pdeVars(it).setSigma(sigma);
+	}
+	const real J2 = mesh.pdeVars({0, 0}).getJ2();
+	ASSERT_NEAR(sqrt(8), J2, EQUALITY_TOLERANCE);
+	
+	IdealPlasticFlowCorrector<Mesh>().apply(mesh, 0.5);
+	for (int x = 0; x < cp.sizes(0); x++) {
+		for (int y = 0; y < cp.sizes(1); y++) {
+			const Mesh::PdeVariables& pdeVars = mesh.pdeVars({x, y});
+			/// the return to the yield surface keeps pressure and
+			/// the direction of the deviator
+			ASSERT_NEAR(1, pdeVars.getPressure(), EQUALITY_TOLERANCE);
+			ASSERT_NEAR((x < 3) ? 1 : J2, pdeVars.getJ2(), EQUALITY_TOLERANCE);
+			ASSERT_NEAR(pdeVars.sigma(0, 1), pdeVars.sigma(0, 0) + 1,
+					EQUALITY_TOLERANCE);
+		}
+	}
+	for (size_t k = 0; k < odeVars.size(); k++) {
+		ASSERT_NEAR((J2 - 1) / 0.5, odeVars.plasticStrain[k], EQUALITY_TOLERANCE);
+	}
+	
+	/// nothing changes on the yield surface
+	IdealPlasticFlowCorrector<Mesh>().apply(mesh, 0.5);
+	for (size_t k = 0; k < odeVars.size(); k++) {
+		ASSERT_NEAR((J2 - 1) / 0.5, odeVars.plasticStrain[k], EQUALITY_TOLERANCE);
+	}
+}
+
+
+TEST(CubicGrid, maxwellViscosityFollowsMaterials) {
+	Task task;
+	task.materialConditions.byAreas.defaultMaterial =
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5, 0, 0, 0, 1);
+	Task::InitialCondition::Quantity quantity;
+	quantity.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	quantity.value = 2;
+	quantity.area = std::make_shared<InfiniteArea>();
+	task.initialCondition.quantities.push_back(quantity);
+	
+	typedef CubicGrid<2> Grid;
+	typedef DefaultMesh<ElasticModel<2>, Grid, IsotropicMaterial> Mesh;
+	typedef typename Grid::ConstructionPack ConstructionPack;
+	ConstructionPack cp;
+	cp.borderSize = 1;
+	cp.sizes = {3, 4};
+	cp.h = {1, 1};
+	
+	Mesh mesh(task, 0, cp, 1);
+	mesh.setUpPde(task);
+	MaxwellViscosityOde<Mesh> ode;
+	ode.apply(mesh, 0.5);
+	for (int x = 0; x < cp.sizes(0); x++) {
+		for (int y = 0; y < cp.sizes(1); y++) {
+			ASSERT_NEAR(-2 * exp(-0.5), mesh.pdeVars({x, y}).sigma(0, 0),
+					EQUALITY_TOLERANCE);
+		}
+	}
+	
+	/// the number of nodes is the same, but the material has changed
+	mesh._material({0, 0}) =
+			std::make_shared<IsotropicMaterial>(4, 2, 0.5, 0, 0, 0, 0.25);
+	ode.apply(mesh, 0.5);
+	ASSERT_NEAR(-2 * exp(-0.5) * exp(-2), mesh.pdeVars({0, 0}).sigma(0, 0),
+			EQUALITY_TOLERANCE);
+	ASSERT_NEAR(-2 * exp(-1), mesh.pdeVars({1, 0}).sigma(0, 0),
+			EQUALITY_TOLERANCE);
+}
+
+
 TEST(CubicGrid, PartIterator) {
 	typedef CubicGrid<3> Grid;
 	typedef typename Grid::ConstructionPack ConstructionPack;
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+
 #include <libgcm/rheology/models/models.hpp>
 #include <libgcm/rheology/materials/materials.hpp>
 
@@ -132,6 +134,65 @@ TEST(OrthotropicGcmMatrix, NotRotatedBasis) {
 }
 
 
+template<int Dimensionality>
+void testOrthotropicRotatedBasis() {
+	typedef ElasticModel<Dimensionality>  Model;
+	typedef typename Model::GCM_MATRICES  GCM_MATRICES;
+	typedef typename Model::Matrix        Matrix;
+	typedef typename Model::MatrixDD      Basis;
+	
+	auto test = [](std::shared_ptr<const OrthotropicMaterial> material,
+			const Basis& basis) {
+		auto global = std::make_shared<GCM_MATRICES>();
+		auto rotated = std::make_shared<GCM_MATRICES>();
+		Model::constructGcmMatrices(global, material);
+		Model::constructGcmMatrices(rotated, material, basis);
+		ASSERT_EQ(basis, rotated->basis);
+		for (int s = 0; s < Dimensionality; s++) {
+			/// matrix A along some direction is linear in the direction
+			Matrix expected = Matrix::Zeros();
+			for (int k = 0; k < Dimensionality; k++) {
+				expected += basis(k, s) * (*global)(k).A;
+			}
+			ASSERT_LT(linal::normMax(expected - (*rotated)(s).A),
+					EQUALITY_TOLERANCE * linal::normMax(expected))
+					<< "expected:" << expected << "actual:" << (*rotated)(s).A;
+			/// outer waves of border nodes in local basis are RIGHT_INVARIANTS
+			for (const int i : Model::LEFT_INVARIANTS) {
+				ASSERT_GT((*global)(s).L(i), 0);
+				ASSERT_GT((*rotated)(s).L(i), 0);
+			}
+			for (const int i : Model::RIGHT_INVARIANTS) {
+				ASSERT_LT((*global)(s).L(i), 0);
+				ASSERT_LT((*rotated)(s).L(i), 0);
+			}
+			testTrace((*rotated)(s));
+			testEigenstrings((*rotated)(s), 0.01, true);
+			testEigenvectors((*rotated)(s), 0.01, true);
+			testInverse((*rotated)(s), 0.02);
+		}
+	};
+	
+	Utils::seedRand();
+	for (int i = 0; i < 1000; i++) {
+		/// in 2D, main axes of the material are along the coordinate ones
+		test(std::make_shared<const OrthotropicMaterial>(
+				OrthotropicMaterial::generateRandomMaterial(Dimensionality == 3)),
+				linal::randomBasis(Basis()));
+		/// isotropic material written as orthotropic one
+		test(std::make_shared<const OrthotropicMaterial>(
+				IsotropicMaterial::generateRandomMaterial()),
+				linal::randomBasis(Basis()));
+	}
+}
+
+
+TEST(OrthotropicGcmMatrix, RotatedBasis) {
+	testOrthotropicRotatedBasis<2>();
+	testOrthotropicRotatedBasis<3>();
+}
+
+
 TEST(GcmMatrices, RotatedOrthotropicMaterial) {
 	typedef ElasticModel<3>::GCM_MATRICES GCM_MATRICES;
 	
@@ -158,9 +219,11 @@ TEST(GcmMatrices, RotatedOrthotropicMaterial) {
 		test({Utils::randomReal(-2*M_PI, 2*M_PI), 0, 0});
 		test({0, Utils::randomReal(-2*M_PI, 2*M_PI), 0});
 		test({0, 0, Utils::randomReal(-2*M_PI, 2*M_PI)});
-		// TODO - theese ones are failed:
-		// test({Utils::randomReal(-2*M_PI, 2*M_PI), 
-		//       Utils::randomReal(-2*M_PI, 2*M_PI), 0});
+		test({Utils::randomReal(-2*M_PI, 2*M_PI),
+		      Utils::randomReal(-2*M_PI, 2*M_PI), 0});
+		test({Utils::randomReal(-2*M_PI, 2*M_PI),
+		      Utils::randomReal(-2*M_PI, 2*M_PI),
+		      Utils::randomReal(-2*M_PI, 2*M_PI)});
 	}
 }
 
@@ -192,3 +255,187 @@ TEST(Material, rotate_orthotropic_material) {
 }
 
 
+template<typename Model, typename TGcmMatrices>
+void testLocalGcmStep(const TGcmMatrices& matrices) {
+	typedef typename Model::Matrix    Matrix;
+	typedef typename Model::PdeVector PdeVector;
+	
+	for (int s = 0; s < Model::DIMENSIONALITY; s++) {
+		const Matrix values = linal::random<Matrix>(-1, 1);
+		const PdeVector generic = localGcmStep(matrices(s).U1, matrices(s).U, values);
+		const PdeVector specialized = Model::localGcmStep(matrices(s), values);
+		for (int i = 0; i < Model::PDE_SIZE; i++) {
+			const real bound = EQUALITY_TOLERANCE * (1 + fabs(generic(i)));
+			ASSERT_NEAR(generic(i), specialized(i), bound)
+					<< "i = " << i << ", s = " << s << "\nU:" << matrices(s).U
+					<< "U1:" << matrices(s).U1 << "values:" << values;
+		}
+	}
+}
+
+
+template<typename Model, typename Material>
+void testLocalGcmStep(const std::shared_ptr<const Material> material,
+		const typename Model::MatrixDD& basis = Model::MatrixDD::Identity()) {
+	auto full = std::make_shared<typename Model::GCM_MATRICES>();
+	Model::constructGcmMatrices(full, material, basis);
+	testLocalGcmStep<Model>(*full);
+	
+	auto lean = std::make_shared<typename Model::LEAN_GCM_MATRICES>();
+	Model::constructGcmMatrices(lean, material, basis);
+	testLocalGcmStep<Model>(*lean);
+	for (int s = 0; s < Model::DIMENSIONALITY; s++) {
+		ASSERT_TRUE(linal::approximatelyEqual((*full)(s).U, (*lean)(s).U));
+		ASSERT_TRUE(linal::approximatelyEqual((*full)(s).U1, (*lean)(s).U1));
+	}
+}
+
+
+template<template<int> class TModel, int Dimensionality>
+void testIsotropicLocalGcmStep() {
+	typedef TModel<Dimensionality>   Model;
+	typedef typename Model::MatrixDD Basis;
+	
+	Utils::seedRand();
+	for (int i = 0; i < 1000; i++) {
+		auto material = std::make_shared<const IsotropicMaterial>(
+				IsotropicMaterial::generateRandomMaterial());
+		testLocalGcmStep<Model>(material);
+		testLocalGcmStep<Model>(material, linal::randomBasis(Basis()));
+	}
+}
+
+
+TEST(GcmMatrices, localGcmStep) {
+	testIsotropicLocalGcmStep<ElasticModel, 1>();
+	testIsotropicLocalGcmStep<ElasticModel, 2>();
+	testIsotropicLocalGcmStep<ElasticModel, 3>();
+	
+	testIsotropicLocalGcmStep<AcousticModel, 1>();
+	testIsotropicLocalGcmStep<AcousticModel, 2>();
+	testIsotropicLocalGcmStep<AcousticModel, 3>();
+	
+	Utils::seedRand();
+	for (int i = 0; i < 1000; i++) {
+		auto material = std::make_shared<OrthotropicMaterial>(
+				OrthotropicMaterial::generateRandomMaterial());
+		testLocalGcmStep<ElasticModel<2>, OrthotropicMaterial>(material);
+		testLocalGcmStep<ElasticModel<3>, OrthotropicMaterial>(material);
+		material->anglesOfRotation = {0, 0, Utils::randomReal(-2*M_PI, 2*M_PI)};
+		testLocalGcmStep<ElasticModel<3>, OrthotropicMaterial>(material);
+	}
+}
+
+
+/** Time of gcm steps by the given function for all matrices and values */
+template<typename Model, typename TGcmMatrices, typename TStep>
+double timeOfGcmSteps(const std::vector<TGcmMatrices>& matrices,
+		const std::vector<typename Model::Matrix>& values,
+		typename Model::PdeVector& checksum, TStep step) {
+	checksum = Model::PdeVector::Zeros();
+	const auto t1 = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < 1000; repeat++) {
+		for (size_t i = 0; i < values.size(); i++) {
+			const auto& m = matrices[i % matrices.size()](
+					(int)(i % (size_t)Model::DIMENSIONALITY));
+			checksum += step(m, values[i]);
+		}
+	}
+	const auto t2 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+
+/** Random material of border nodes for the benchmark */
+template<typename Material>
+std::shared_ptr<const Material> randomMaterial(const int dimensionality);
+
+template<>
+std::shared_ptr<const IsotropicMaterial> randomMaterial(const int) {
+	return std::make_shared<const IsotropicMaterial>(
+			IsotropicMaterial::generateRandomMaterial());
+}
+
+template<>
+std::shared_ptr<const OrthotropicMaterial> randomMaterial(const int dimensionality) {
+	/// in 2D, main axes of the material are along the coordinate ones
+	return std::make_shared<const OrthotropicMaterial>(
+			OrthotropicMaterial::generateRandomMaterial(dimensionality == 3));
+}
+
+
+template<template<int> class TModel, int Dimensionality,
+         typename Material = IsotropicMaterial>
+void benchmarkLocalGcmStep(const std::string& name) {
+	typedef TModel<Dimensionality>               Model;
+	typedef typename Model::LEAN_GCM_MATRICES    GcmMatrices;
+	typedef typename GcmMatrices::GcmMatrix      GcmMatrix;
+	typedef typename Model::Matrix               Matrix;
+	typedef typename Model::PdeVector            PdeVector;
+	typedef typename Model::MatrixDD             Basis;
+	
+	Utils::seedRand();
+	/// matrices of border nodes are different in each node
+	std::vector<GcmMatrices> matrices(100);
+	for (auto& m : matrices) {
+		const Basis basis = linal::randomBasis(Basis());
+		auto lean = std::make_shared<GcmMatrices>();
+		Model::constructGcmMatrices(lean, randomMaterial<Material>(Dimensionality), basis);
+		m = *lean;
+	}
+	std::vector<Matrix> values(1000);
+	for (auto& v : values) {
+		v = linal::random<Matrix>(-1, 1);
+	}
+	
+	PdeVector genericSum, specializedSum;
+	const double generic = timeOfGcmSteps<Model>(matrices, values, genericSum,
+			[](const GcmMatrix& m, const Matrix& v) {
+				return PdeVector(localGcmStep(m.U1, m.U, v));
+			});
+	const double specialized = timeOfGcmSteps<Model>(matrices, values, specializedSum,
+			[](const GcmMatrix& m, const Matrix& v) {
+				return Model::localGcmStep(m, v);
+			});
+	/// timings are recorded as test properties (see --gtest_output=xml)
+	const std::string key = name + std::to_string(Dimensionality) + "D";
+	::testing::Test::RecordProperty(key + "_generic_us", (int)(generic * 1000));
+	::testing::Test::RecordProperty(key + "_specialized_us", (int)(specialized * 1000));
+	ASSERT_TRUE(linal::approximatelyEqual(genericSum, specializedSum, 1e-6))
+			<< name << Dimensionality << "D:" << genericSum << specializedSum;
+}
+
+
+TEST(GcmMatrices, localGcmStepBenchmark) {
+	benchmarkLocalGcmStep<ElasticModel, 2>("elastic");
+	benchmarkLocalGcmStep<ElasticModel, 3>("elastic");
+	benchmarkLocalGcmStep<ElasticModel, 2, OrthotropicMaterial>("orthotropic_elastic");
+	benchmarkLocalGcmStep<ElasticModel, 3, OrthotropicMaterial>("orthotropic_elastic");
+	benchmarkLocalGcmStep<AcousticModel, 2>("acoustic");
+	benchmarkLocalGcmStep<AcousticModel, 3>("acoustic");
+}
+
+
+TEST(VelocitySigmaVariables, scaleStressDeviator) {
+	typedef ElasticModel<3>::PdeVariables PdeVariables;
+	typedef ElasticModel<3>::PdeVector PdeVector;
+	Utils::seedRand();
+	for (int i = 0; i < 100; i++) {
+		PdeVariables original;
+		static_cast<PdeVector&>(original) = linal::random<PdeVector>(-5, 5);
+		const real factor = Utils::randomReal(0, 1);
+		PdeVariables scaled = original;
+		scaled.scaleStressDeviator(factor);
+		
+		const real pressure = original.getPressure();
+		ASSERT_NEAR(pressure, scaled.getPressure(), EQUALITY_TOLERANCE);
+		ASSERT_NEAR(factor * original.getJ2(), scaled.getJ2(), EQUALITY_TOLERANCE);
+		ASSERT_EQ(original.getVelocity(), scaled.getVelocity());
+		for (int j = 0; j < 3; j++) {
+			for (int k = 0; k < 3; k++) {
+				ASSERT_NEAR(factor * (original.sigma(j, k) + (j == k) * pressure),
+						scaled.sigma(j, k) + (j == k) * pressure, EQUALITY_TOLERANCE);
+			}
+		}
+	}
+}
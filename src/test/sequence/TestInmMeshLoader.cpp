@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 
 #include <libgcm/grid/simplex/mesh_loaders/InmMeshLoader.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
+#include <libgcm/grid/simplex/VertexInfoAndCellInfo.hpp>
+#include <libgcm/grid/simplex/TriangulationSanitizer.hpp>
 #include <libgcm/util/snapshot/VtkSnapshotter.hpp>
+#include <libgcm/util/Utils.hpp>
+
+#include <omp.h>
 
 using namespace gcm;
 
@@ -18,7 +24,7 @@ TEST(InmMeshLoader, load) {
 
 TEST(InmMeshLoader, readFromFile) {
 	std::vector<Real3> points;
-	std::map<InmMeshLoader::Cell, InmMeshLoader::Material> materials;
+	InmMeshLoader::Materials materials;
 	
 	InmMeshLoader::readFromFile("meshes/testInmLoader.out", 
 			points, materials);
@@ -62,7 +68,197 @@ TEST(InmMeshLoader, readFromFile) {
 	ASSERT_NEAR( 1.370376220703125000e+03, points[10](2), EQUALITY_TOLERANCE);
 	ASSERT_NEAR( 1.366383422851562500e+03, points[11](2), EQUALITY_TOLERANCE);
 	
-	ASSERT_EQ(4, materials.at(InmMeshLoader::Cell({1, 2, 3, 4})));
-	ASSERT_EQ(5, materials.at(InmMeshLoader::Cell({5, 6, 7, 8})));
-	ASSERT_EQ(1, materials.at(InmMeshLoader::Cell({9, 10, 11, 12})));
+	ASSERT_EQ(4, *InmMeshLoader::findMaterial(materials, InmMeshLoader::Cell({1, 2, 3, 4})));
+	ASSERT_EQ(5, *InmMeshLoader::findMaterial(materials, InmMeshLoader::Cell({5, 6, 7, 8})));
+	ASSERT_EQ(1, *InmMeshLoader::findMaterial(materials, InmMeshLoader::Cell({9, 10, 11, 12})));
+}
+
+
+TEST(InmMeshLoader, flatTriangulation) {
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::INM_MESHER;
+	task.simplexGrid.fileName = "meshes/testInmLoader.out";
+	typedef FlatTriangulation<3, VertexInfo, CellInfoT<4>> Triangulation;
+	Triangulation triangulation(task);
+	
+	/// three separate tetrahedra, each is closed by four infinite cells
+	int numberOfVertices = 0;
+	for (auto v = triangulation.verticesBegin(); v != triangulation.verticesEnd(); ++v) {
+		++numberOfVertices;
+	}
+	ASSERT_EQ(12, numberOfVertices);
+	
+	std::map<GridId, int> materials;
+	int numberOfInfiniteCells = 0;
+	for (auto c = triangulation.allCellsBegin(); c != triangulation.allCellsEnd(); ++c) {
+		if (triangulation.isInfinite(c)) {
+			++numberOfInfiniteCells;
+			ASSERT_EQ(CellInfoT<4>::EmptySpaceFlag, c->info().getGridId());
+		} else {
+			++materials[c->info().getGridId()];
+		}
+		for (int i = 0; i < 4; i++) {
+			const auto neighbor = c->neighbor(i);
+			ASSERT_EQ(c, neighbor->neighbor(neighbor->index(c)));
+			ASSERT_EQ(3, Triangulation::commonVertices(c, neighbor).size());
+		}
+	}
+	ASSERT_EQ(12, numberOfInfiniteCells);
+	ASSERT_EQ((std::map<GridId, int>({{1, 1}, {4, 1}, {5, 1}})), materials);
+}
+
+
+TEST(InmMeshLoader, buildFromCells) {
+	typedef FlatTriangulationStorage<3, VertexInfo, CellInfoT<4>> Storage;
+	const std::vector<Real3> points = {
+			{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}, {5, 5, 5}};
+	CellInfoT<4> a, b, infinite;
+	a.setGridId(0); b.setGridId(1); infinite.setGridId(CellInfoT<4>::EmptySpaceFlag);
+	Storage storage;
+	storage.buildFromCells(points, {{0, 1, 2, 3}, {4, 3, 2, 1}}, {a, b}, infinite);
+	
+	/// two tetrahedra with the common face are closed by six infinite cells,
+	/// the unused point is dropped
+	ASSERT_EQ(8, storage.allCellsEnd().getIndex());
+	const auto first = storage.allCellsBegin();
+	auto second = first; ++second;
+	ASSERT_EQ(second, first->neighbor(first->index(first->vertex(0))));
+	ASSERT_EQ(first, second->neighbor(second->index(second->vertex(0))));
+	ASSERT_EQ(1, second->info().getGridId());
+	for (auto c = storage.allCellsBegin(); c != storage.allCellsEnd(); ++c) {
+		for (int i = 0; i < 4; i++) {
+			const auto neighbor = c->neighbor(i);
+			ASSERT_EQ(c, neighbor->neighbor(neighbor->index(c)));
+		}
+	}
+	ASSERT_EQ(4, storage.allIncidentCells(first->vertex(0)).size());
+	ASSERT_EQ(first, Storage::someCellOfVertex(first->vertex(0)));
+	
+	ASSERT_THROW(storage.buildFromCells(points, {{0, 1, 2, 3}, {0, 1, 2, 4}, {0, 1, 2, 5}},
+			{a, a, b}, infinite), Exception);
+}
+
+
+TEST(InmMeshLoader, sanitize) {
+	typedef FlatTriangulationStorage<3, VertexInfo, CellInfoT<4>> Storage;
+	typedef TriangulationSanitizer<4> Sanitizer;
+	/// access to flat arrays of the storage
+	struct SanitizedStorage : public Storage {
+		void sanitize() {
+			std::vector<GridId> gridIds(this->cellInfos.size());
+			for (size_t c = 0; c < gridIds.size(); c++) {
+				gridIds[c] = this->cellInfos[c].getGridId();
+			}
+			Sanitizer(this->cellVertices, this->cellNeighbors, this->incidentCellsOffsets,
+					this->incidentCells, this->infiniteVertex).sanitize(gridIds);
+			for (size_t c = 0; c < gridIds.size(); c++) {
+				this->cellInfos[c].setGridId(gridIds[c]);
+			}
+		}
+		Index numberOfFiniteVertices() const { return this->infiniteVertex; }
+		GridId gridId(const size_t c) const { return this->cellInfos[c].getGridId(); }
+		bool isInfinite(const CellHandle c) const {
+			return c->has_vertex(VertexHandle(nullptr, this->infiniteVertex));
+		}
+	};
+	
+	/// cube of n^3 unit cubes, each one is split into six tetrahedra along
+	/// its main diagonal; materials are layers with noise on their borders
+	const int n = 24;
+	std::vector<Real3> points;
+	for (int i = 0; i <= n; i++) {
+		for (int j = 0; j <= n; j++) {
+			for (int k = 0; k <= n; k++) {
+				points.push_back({(real)i, (real)j, (real)k});
+			}
+		}
+	}
+	auto vertex = [n](const int i, const int j, const int k) {
+		return (i * (n + 1) + j) * (n + 1) + k;
+	};
+	const int axesOrders[6][3] = {
+			{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+	std::vector<std::array<int, 4>> cells;
+	std::vector<CellInfoT<4>> infos;
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			for (int k = 0; k < n; k++) {
+				for (const auto& order : axesOrders) {
+					int p[3] = {i, j, k};
+					std::array<int, 4> cell;
+					cell[0] = vertex(p[0], p[1], p[2]);
+					for (size_t a = 0; a < 3; a++) {
+						p[order[a]]++;
+						cell[a + 1] = vertex(p[0], p[1], p[2]);
+					}
+					const int seed[2] = {(int)cells.size(), n};
+					const int noise = (int)(Utils::hash(seed, sizeof(seed)) % 5) - 2;
+					CellInfoT<4> info;
+					info.setGridId((GridId)(std::max(0, std::min(3, (i + noise) / 6))));
+					cells.push_back(cell);
+					infos.push_back(info);
+				}
+			}
+		}
+	}
+	CellInfoT<4> infinite;
+	infinite.setGridId(CellInfoT<4>::EmptySpaceFlag);
+	
+	/// sanitizing by one and by all threads
+	const int maxThreads = omp_get_max_threads();
+	std::vector<GridId> results[2];
+	for (int parallel = 0; parallel < 2; parallel++) {
+		SanitizedStorage storage;
+		storage.buildFromCells(points, cells, infos, infinite);
+		omp_set_num_threads(parallel ? maxThreads : 1);
+		storage.sanitize();
+		omp_set_num_threads(maxThreads);
+		
+		size_t numberOfChanged = 0;
+		for (size_t c = 0; c < infos.size(); c++) {
+			numberOfChanged += storage.gridId(c) != infos[c].getGridId();
+		}
+		/// noise makes some cells hanged, but layers are kept
+		ASSERT_GT(numberOfChanged, 0);
+		ASSERT_LT(numberOfChanged, infos.size() / 5);
+		
+		for (auto c = storage.allCellsBegin(); c != storage.allCellsEnd(); ++c) {
+			results[parallel].push_back(c->info().getGridId());
+			if (storage.isInfinite(c)) { continue; }
+			/// no hanged cells
+			bool hasNeighborOfTheSameMaterial = false;
+			for (int i = 0; i < 4; i++) {
+				hasNeighborOfTheSameMaterial |=
+						c->neighbor(i)->info().getGridId() == c->info().getGridId();
+			}
+			ASSERT_TRUE(hasNeighborOfTheSameMaterial);
+		}
+		
+		/// no disconnected cells sets
+		for (Storage::VertexHandle v(&storage, 0);
+				v.getIndex() < storage.numberOfFiniteVertices(); ++v) {
+			const auto incident = storage.allIncidentCells(v);
+			std::set<Storage::CellHandle> visited;
+			std::set<GridId> materials;
+			for (const auto start : incident) {
+				if (!visited.insert(start).second) { continue; }
+				const GridId id = start->info().getGridId();
+				ASSERT_TRUE(materials.insert(id).second);
+				std::vector<Storage::CellHandle> stack = {start};
+				while (!stack.empty()) {
+					const auto c = stack.back();
+					stack.pop_back();
+					for (int i = 0; i < 4; i++) {
+						const auto neighbor = c->neighbor(i);
+						if (c->vertex(i) != v && neighbor->info().getGridId() == id &&
+								visited.insert(neighbor).second) {
+							stack.push_back(neighbor);
+						}
+					}
+				}
+			}
+		}
+	}
+	/// the result doesn't depend on the number of threads
+	ASSERT_EQ(results[0], results[1]);
 }
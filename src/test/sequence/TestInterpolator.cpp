@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <libgcm/linal/linal.hpp>
 #include <libgcm/util/math/interpolation/interpolation.hpp>
+#include <libgcm/util/math/Differentiation.hpp>
 
 using namespace gcm;
 using namespace gcm::linal;
@@ -283,3 +289,391 @@ TEST(TetrahedronInterpolator, quadraticMinMax) {
 }
 
 
+
+
+TEST(SimplexBatchInterpolator, versusTetrahedronInterpolator) {
+	typedef linal::Vector<9> Value;
+	typedef SimplexBatchInterpolator<3, Value> Batch;
+	const int N = 5;
+	
+	Utils::seedRand();
+	for (int i = 0; i < 100; i++) {
+		Real3 c[4];
+		Value v[4];
+		Batch::Gradient g[4];
+		for (int j = 0; j < 4; j++) {
+			c[j] = linal::random<Real3>(-1, 1);
+			v[j] = linal::random<Value>(-1, 1);
+			for (int k = 0; k < 3; k++) {
+				g[j](k) = linal::random<Value>(-10, 10);
+			}
+		}
+		
+		Batch::Query queries[N];
+		Value expected[N];
+		for (int k = 0; k < N; k++) {
+			Real4 l = linal::random<Real4>(0, 1); l /= (l(0) + l(1) + l(2) + l(3));
+			Real3 q = l(0) * c[0] + l(1) * c[1] + l(2) * c[2] + l(3) * c[3];
+			queries[k].lambda = l;
+			for (int j = 0; j < 4; j++) {
+				queries[k].shift[j] = q - c[j];
+				queries[k].value[j] = &v[j];
+				queries[k].gradient[j] = &g[j];
+			}
+			expected[k] = TetrahedronInterpolator<Value>::hybridInterpolate(l,
+					c[0], v[0], g[0], c[1], v[1], g[1],
+					c[2], v[2], g[2], c[3], v[3], g[3], q);
+		}
+		
+		Value actual[N];
+		Batch::hybridInterpolate(N, queries, actual);
+		for (int k = 0; k < N; k++) {
+			ASSERT_LT(linal::length(expected[k] - actual[k]), EQUALITY_TOLERANCE)
+					<< expected[k] << actual[k];
+		}
+	}
+}
+
+
+/** Random polynomial of the third degree in 3D with exact derivatives */
+struct RandomCubicPolynomial {
+	/// coefficients of x^p * y^q * z^r, zeros for p + q + r > 3
+	real a[4][4][4];
+	
+	RandomCubicPolynomial() {
+		for (int p = 0; p < 4; p++) {
+			for (int q = 0; q < 4; q++) {
+				for (int r = 0; r < 4; r++) {
+					a[p][q][r] = (p + q + r <= 3) ? Utils::randomReal(-1, 1) : 0;
+				}
+			}
+		}
+	}
+	
+	/** Derivative of the given order along each axis at point x */
+	real derivative(const Real3& x, const Int3& order) const {
+		real ans = 0;
+		for (int p = order(0); p < 4; p++) {
+			for (int q = order(1); q < 4; q++) {
+				for (int r = order(2); r < 4; r++) {
+					ans += a[p][q][r] *
+							monomial(x(0), p, order(0)) *
+							monomial(x(1), q, order(1)) *
+							monomial(x(2), r, order(2));
+				}
+			}
+		}
+		return ans;
+	}
+	
+	/** k-th derivative of x^p */
+	static real monomial(const real x, const int p, const int k) {
+		real ans = 1;
+		for (int i = 0; i < k; i++) { ans *= p - i; }
+		for (int i = 0; i < p - k; i++) { ans *= x; }
+		return ans;
+	}
+};
+
+
+template<int D>
+void testCubicInterpolationIsExactForCubicPolynomials() {
+	typedef linal::Vector<2> Value;
+	typedef SimplexBatchInterpolator<D, Value> Batch;
+	typedef linal::Vector<D> RealD;
+	
+	auto toReal3 = [](const RealD& x) {
+		Real3 ans = Real3::Zeros();
+		for (int j = 0; j < D; j++) { ans(j) = x(j); }
+		return ans;
+	};
+	auto unit = [](const int j) {
+		Int3 ans = Int3::Zeros();
+		ans(j) = 1;
+		return ans;
+	};
+	
+	Utils::seedRand();
+	for (int i = 0; i < 1000; i++) {
+		const RandomCubicPolynomial f[2];
+		RealD c[D + 1];
+		Value v[D + 1];
+		typename Batch::Gradient g[D + 1];
+		typename Batch::Hessian h[D + 1];
+		for (int j = 0; j <= D; j++) {
+			c[j] = linal::random<RealD>(-1, 1);
+			for (int m = 0; m < 2; m++) {
+				v[j](m) = f[m].derivative(toReal3(c[j]), Int3::Zeros());
+				for (int k = 0; k < D; k++) {
+					g[j](k)(m) = f[m].derivative(toReal3(c[j]), unit(k));
+					for (int l = k; l < D; l++) {
+						h[j](k, l)(m) = f[m].derivative(toReal3(c[j]), unit(k) + unit(l));
+					}
+				}
+			}
+		}
+		
+		linal::Vector<D + 1> lambda = linal::random<linal::Vector<D + 1>>(0, 1);
+		lambda /= linal::dotProduct(lambda, linal::Vector<D + 1>::Ones());
+		RealD q = RealD::Zeros();
+		for (int j = 0; j <= D; j++) { q += lambda(j) * c[j]; }
+		typename Batch::Query query;
+		query.lambda = lambda;
+		for (int j = 0; j <= D; j++) {
+			query.shift[j] = q - c[j];
+			query.value[j] = &v[j];
+			query.gradient[j] = &g[j];
+			query.hessian[j] = &h[j];
+		}
+		Value actual;
+		Batch::hybridCubicInterpolate(query, actual);
+		
+		/// the limiter keeps the cubic interpolation if it is in the range
+		bool isInRange = true;
+		Value expected;
+		for (int m = 0; m < 2; m++) {
+			expected(m) = f[m].derivative(toReal3(q), Int3::Zeros());
+			real minimum = v[0](m), maximum = v[0](m);
+			for (int j = 1; j <= D; j++) {
+				minimum = fmin(minimum, v[j](m));
+				maximum = fmax(maximum, v[j](m));
+			}
+			isInRange = isInRange && expected(m) >= minimum && expected(m) <= maximum;
+		}
+		if (isInRange) {
+			ASSERT_LT(linal::length(expected - actual), 1e-10) << expected << actual;
+		}
+	}
+}
+
+
+TEST(SimplexBatchInterpolator, cubicIsExactForCubicPolynomials) {
+	testCubicInterpolationIsExactForCubicPolynomials<2>();
+	testCubicInterpolationIsExactForCubicPolynomials<3>();
+}
+
+
+TEST(SimplexBatchInterpolator, cubicLimiter) {
+	typedef linal::Vector<1> Value;
+	typedef SimplexBatchInterpolator<2, Value> Batch;
+	
+	/// f = x^2 + y^2 with the minimum in the query point inside the triangle
+	const Real2 c[3] = {{1, 0}, {-1, 1}, {-1, -1}};
+	Value v[3];
+	Batch::Gradient g[3];
+	Batch::Hessian h[3];
+	Batch::Query query;
+	query.lambda = {0.5, 0.25, 0.25};
+	for (int j = 0; j < 3; j++) {
+		v[j](0) = linal::dotProduct(c[j], c[j]);
+		g[j](0)(0) = 2 * c[j](0);
+		g[j](1)(0) = 2 * c[j](1);
+		h[j](0, 0)(0) = h[j](1, 1)(0) = 2;
+		h[j](0, 1)(0) = 0;
+		query.shift[j] = -c[j];
+		query.value[j] = &v[j];
+		query.gradient[j] = &g[j];
+		query.hessian[j] = &h[j];
+	}
+	
+	/// the smooth extremum is not cut by the range of values in vertices
+	Value result;
+	Batch::hybridCubicInterpolate(query, result);
+	ASSERT_NEAR(0, result(0), EQUALITY_TOLERANCE);
+	
+	/// curvatures of different signs mean a discontinuity
+	h[0](0, 0)(0) = h[0](1, 1)(0) = -2;
+	Batch::hybridCubicInterpolate(query, result);
+	ASSERT_GE(result(0), 1);
+	ASSERT_LE(result(0), 2);
+}
+
+
+/**
+ * Regular lattice of (L + 1)^3 nodes with step h, splitted into tetrahedrons
+ * along the main diagonal of each cube, with plane waves as values.
+ * The minimal mesh interface Differentiation needs.
+ */
+struct PlaneWaveLattice {
+	typedef linal::Vector<9> PdeVector;
+	struct Grid {
+		static const int DIMENSIONALITY = 3;
+		/// ±e_x, ±e_y, ±e_z, ±(e_x + e_y), ±(e_x + e_z), ±(e_y + e_z), ±(1, 1, 1)
+		static const int MAX_NUMBER_OF_NEIGHBOR_VERTICES = 14;
+	};
+	
+	/** Counting iterator over node indices */
+	struct Iterator {
+		size_t i;
+		size_t operator*() const { return i; }
+		Iterator& operator++() { ++i; return *this; }
+		bool operator!=(const Iterator& other) const { return i != other.i; }
+	};
+	
+	const int L;
+	const real h;
+	std::vector<PdeVector> values;
+	
+	PlaneWaveLattice(const int L_, const real h_, const Real3 k[]) :
+			L(L_), h(h_), values((size_t)((L + 1) * (L + 1) * (L + 1))) {
+		for (size_t it = 0; it < values.size(); it++) {
+			for (int m = 0; m < PdeVector::M; m++) {
+				values[it](m) = sin(linal::dotProduct(k[m], coordsD(it)));
+			}
+		}
+	}
+	
+	size_t sizeOfAllNodes() const { return values.size(); }
+	size_t sizeOfRealNodes() const { return values.size(); }
+	size_t getIndex(const size_t it) const { return it; }
+	const PdeVector& pde(const size_t it) const { return values[it]; }
+	Iterator begin() const { return {0}; }
+	Iterator end() const { return {values.size()}; }
+	
+	size_t index(const Int3& x) const {
+		return (size_t)((x(0) * (L + 1) + x(1)) * (L + 1) + x(2));
+	}
+	
+	Int3 position(const size_t it) const {
+		return {(int)(it / (size_t)((L + 1) * (L + 1))),
+				(int)(it / (size_t)(L + 1) % (size_t)(L + 1)),
+				(int)(it % (size_t)(L + 1))};
+	}
+	
+	Real3 coordsD(const size_t it) const {
+		const Int3 x = position(it);
+		return h * Real3({(real)x(0), (real)x(1), (real)x(2)});
+	}
+	
+	std::vector<size_t> findNeighborVertices(const size_t it) const {
+		static const Int3 edges[7] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1},
+				{1, 1, 0}, {1, 0, 1}, {0, 1, 1}, {1, 1, 1}};
+		const Int3 x = position(it);
+		std::vector<size_t> ans;
+		for (const Int3& e : edges) {
+			for (const Int3 y : {Int3(x + e), Int3(x - e)}) {
+				if (y(0) >= 0 && y(0) <= L && y(1) >= 0 && y(1) <= L &&
+				    y(2) >= 0 && y(2) <= L) {
+					ans.push_back(index(y));
+				}
+			}
+		}
+		return ans;
+	}
+};
+
+
+/** Cost and accuracy of interpolation with estimated derivatives */
+struct PlaneWaveInterpolationResult {
+	real error;               ///< mean absolute error
+	real differentiation;     ///< time of derivatives estimation per node, ns
+	real interpolation;       ///< time of one interpolation, ns
+};
+
+
+/**
+ * Cost versus accuracy of second- and third-order interpolation
+ * of plane waves on the regular tetrahedral mesh with n nodes per wavelength.
+ * Gradients and Hessians in vertices are estimated by Differentiation,
+ * as the method does, so their serial estimation counts in the cost.
+ */
+template<int Order>
+PlaneWaveInterpolationResult planeWaveInterpolation(const int n) {
+	typedef PlaneWaveLattice::PdeVector Value;
+	typedef SimplexBatchInterpolator<3, Value> Batch;
+	typedef Differentiation<PlaneWaveLattice> Diff;
+	const int N = 20000;
+	/// queries are far enough from the lattice border,
+	/// where derivatives are estimated by one-sided differences
+	const int PADDING = 2;
+	
+	/// waves of unit wavelength in different directions
+	Real3 k[Value::M];
+	for (int m = 0; m < Value::M; m++) {
+		k[m] = 2 * M_PI * linal::normalize(Real3({1, 0.1 * m, 0.3 - 0.05 * m}));
+	}
+	const real h = 1.0 / n;
+	const PlaneWaveLattice lattice(n + 2 * PADDING, h, k);
+	
+	const auto t0 = std::chrono::high_resolution_clock::now();
+	std::vector<Diff::PdeGradient> gradients;
+	std::vector<Diff::PdeHessian> hessians;
+	Diff::estimateGradient(lattice, gradients);
+	if (Order == 3) {
+		Diff::estimateHessian(lattice, gradients, hessians);
+	} else {
+		hessians.resize(gradients.size());
+	}
+	const auto t1 = std::chrono::high_resolution_clock::now();
+	
+	/// the cube [0, h]^3 splitted into 6 tetrahedrons along the diagonal,
+	/// the query point in the cube determines its tetrahedron
+	std::vector<Batch::Query> queries((size_t)N);
+	std::vector<Value> expected((size_t)N);
+	Utils::seedRand();
+	for (size_t i = 0; i < (size_t)N; i++) {
+		const Int3 origin = Int3({rand() % n, rand() % n, rand() % n}) +
+				PADDING * Int3::Ones();
+		const Real3 u = linal::random<Real3>(0, 1);
+		int order[3] = {0, 1, 2};
+		std::sort(order, order + 3, [&u](int a, int b) { return u(a) > u(b); });
+		
+		Int3 vertex = origin;
+		const Real3 q = lattice.coordsD(lattice.index(origin)) + h * u;
+		Batch::Query& query = queries[i];
+		for (int j = 0; j < 4; j++) {
+			if (j > 0) { vertex(order[j - 1]) += 1; }
+			const size_t it = lattice.index(vertex);
+			query.lambda(j) = ((j == 0) ? 1 : u(order[j - 1])) - ((j == 3) ? 0 : u(order[j]));
+			query.shift[j] = q - lattice.coordsD(it);
+			query.value[j] = &lattice.pde(it);
+			query.gradient[j] = &gradients[it];
+			query.hessian[j] = &hessians[it];
+		}
+		for (int m = 0; m < Value::M; m++) {
+			expected[i](m) = sin(linal::dotProduct(k[m], q));
+		}
+	}
+	
+	std::vector<Value> actual((size_t)N);
+	const auto t2 = std::chrono::high_resolution_clock::now();
+	if (Order == 3) {
+		Batch::hybridCubicInterpolate(N, queries.data(), actual.data());
+	} else {
+		Batch::hybridInterpolate(N, queries.data(), actual.data());
+	}
+	const auto t3 = std::chrono::high_resolution_clock::now();
+	
+	real error = 0;
+	for (size_t i = 0; i < (size_t)N; i++) {
+		for (int m = 0; m < Value::M; m++) {
+			error += fabs(actual[i](m) - expected[i](m));
+		}
+	}
+	return {error / (N * Value::M),
+			std::chrono::duration<double, std::nano>(t1 - t0).count() /
+					(real)lattice.sizeOfAllNodes(),
+			std::chrono::duration<double, std::nano>(t3 - t2).count() / N};
+}
+
+
+TEST(SimplexBatchInterpolator, planeWaveCostVersusAccuracy) {
+	std::map<int, PlaneWaveInterpolationResult> quadratic, cubic;
+	for (const int n : {4, 6, 8, 12, 16}) {
+		quadratic[n] = planeWaveInterpolation<2>(n);
+		cubic[n] = planeWaveInterpolation<3>(n);
+		const std::string key = "n" + std::to_string(n);
+		RecordProperty(key + "_quadratic_error", std::to_string(quadratic[n].error));
+		RecordProperty(key + "_cubic_error", std::to_string(cubic[n].error));
+		RecordProperty(key + "_quadratic_ns", (int)(
+				quadratic[n].differentiation + quadratic[n].interpolation));
+		RecordProperty(key + "_cubic_ns", (int)(
+				cubic[n].differentiation + cubic[n].interpolation));
+	}
+	for (const int n : {8, 12, 16}) {
+		ASSERT_LT(cubic[n].error, quadratic[n].error);
+	}
+	/// estimated derivatives do not spoil the higher order of convergence
+	ASSERT_GT(cubic[8].error / cubic[16].error,
+			2 * quadratic[8].error / quadratic[16].error);
+}
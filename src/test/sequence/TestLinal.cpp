@@ -2,6 +2,7 @@
 #include <libgcm/util/math/GslUtils.hpp>
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 
@@ -145,6 +146,36 @@ TEST(Linal, contains3d) {
 }
 
 
+TEST(Linal, orientation) {
+	/// points near the line y == x, which are shifted by several units
+	/// in the last place from (0.5, 0.5); naive floating point calculation
+	/// gives wrong and inconsistent signs for them
+	const real u = std::numeric_limits<real>::epsilon() / 2;
+	const Real2 b = {12, 12}, c = {24, 24};
+	const Real3 d = {0, 0, 1};
+	for (int i = 0; i < 16; i++) {
+		for (int j = 0; j < 16; j++) {
+			const Real2 a = {(real)0.5 + (real)i * u, (real)0.5 + (real)j * u};
+			const int expected = (j > i) - (j < i);
+			ASSERT_EQ(expected, orientation(a, b, c));
+			ASSERT_EQ(expected, orientation(b, c, a));
+			ASSERT_EQ(-expected, orientation(b, a, c));
+			
+			const Real3 a3 = {a(0), a(1), 0}, b3 = {b(0), b(1), 0}, c3 = {c(0), c(1), 0};
+			ASSERT_EQ(expected, orientation(a3, b3, c3, d));
+			ASSERT_EQ(expected, orientation(b3, c3, a3, d));
+			ASSERT_EQ(-expected, orientation(b3, a3, c3, d));
+		}
+	}
+	
+	ASSERT_EQ( 1, orientation(Real2({0, 0}), Real2({1, 0}), Real2({0, 1})));
+	ASSERT_EQ( 1, orientation(Real3({0, 0, 0}), Real3({1, 0, 0}),
+			Real3({0, 1, 0}), Real3({0, 0, 1})));
+	ASSERT_EQ(-1, orientation(Real3({0, 0, 0}), Real3({0, 1, 0}),
+			Real3({1, 0, 0}), Real3({0, 0, 1})));
+}
+
+
 TEST(Linal, reflectionDirection) {
 	ASSERT_TRUE(linal::approximatelyEqual(
 			Real2({0, -1}),
@@ -1155,6 +1186,83 @@ TEST(Linal, linearLeastSquares) {
 }
 
 
+TEST(Linal, decompositions) {
+	Utils::seedRand();
+	for (int i = 0; i < 1000; i++) {
+		const auto A = random<Matrix<9, 9>>(-1, 1);
+		const auto f = random<Vector<9>>(-1, 1);
+		
+		const LuDecomposition<9> lu(A);
+		ASSERT_FALSE(lu.isSingular());
+		ASSERT_TRUE(approximatelyEqual(f, A * lu.solve(f), 1e-6));
+		ASSERT_TRUE(approximatelyEqual(identity(A), A * lu.inverse(), 1e-6));
+		ASSERT_NEAR(determinant(A) * determinant(transpose(A)),
+				determinant(A * transpose(A)), 1e-6);
+		
+		const auto S = transposeMultiply(A, A) + identity(A);
+		const CholeskyDecomposition<9> cholesky(S);
+		ASSERT_TRUE(cholesky.isPositiveDefinite());
+		ASSERT_TRUE(approximatelyEqual(f, S * cholesky.solve(f), 1e-6));
+		ASSERT_TRUE(approximatelyEqual(lu.solve(f), solveLinearSystem(A, f), 1e-10));
+		
+		const auto B = random<Matrix<12, 4>>(-1, 1);
+		const auto g = random<Vector<12>>(-1, 1);
+		const QrDecomposition<12, 4> qr(B);
+		ASSERT_TRUE(qr.isFullRank());
+		ASSERT_TRUE(approximatelyEqual(linearLeastSquares(B, g), qr.solve(g), 1e-6));
+		/// exact solution of the consistent system
+		const auto y = random<Vector<4>>(-1, 1);
+		ASSERT_TRUE(approximatelyEqual(y, qr.solve(B * y), 1e-6));
+		
+		const SymmetricEigenDecomposition<9> eigen(S);
+		const auto V = eigen.eigenvectors();
+		ASSERT_TRUE(approximatelyEqual(identity(S), transposeMultiply(V, V), 1e-6));
+		for (int j = 0; j < 9; j++) {
+			ASSERT_TRUE(approximatelyEqual(S * V.getColumn(j),
+					eigen.eigenvalues()(j) * V.getColumn(j), 1e-6));
+		}
+		
+		/// eigenvectors of close eigenvalues are still orthonormal and exact
+		const auto G = randomBasis(Matrix33());
+		const Matrix33 C = G * Matrix33({1, 0, 0, 0, 1 + 1e-12, 0, 0, 0, 2}) * transpose(G);
+		const SymmetricEigenDecomposition<3> close(C);
+		const auto W = close.eigenvectors();
+		ASSERT_TRUE(approximatelyEqual(identity(C), transposeMultiply(W, W), 1e-6));
+		for (int j = 0; j < 3; j++) {
+			ASSERT_TRUE(approximatelyEqual(C * W.getColumn(j),
+					close.eigenvalues()(j) * W.getColumn(j), 1e-6));
+		}
+	}
+	
+	/// right parts with vector elements are solved componentwise
+	Matrix<5, 5> A = random<Matrix<5, 5>>(-1, 1);
+	VECTOR<5, Vector<3>> b;
+	Vector<5> b0, b2;
+	for (int i = 0; i < 5; i++) {
+		b(i) = random<Vector<3>>(-1, 1);
+		b0(i) = b(i)(0);
+		b2(i) = b(i)(2);
+	}
+	const auto x = LuDecomposition<5>(A).solve(b);
+	const auto x0 = LuDecomposition<5>(A).solve(b0);
+	const auto x2 = LuDecomposition<5>(A).solve(b2);
+	for (int i = 0; i < 5; i++) {
+		ASSERT_EQ(x0(i), x(i)(0));
+		ASSERT_EQ(x2(i), x(i)(2));
+	}
+	
+	/// degenerate matrices
+	const LuDecomposition<4> singular(Matrix<4, 4>::Ones());
+	ASSERT_TRUE(singular.isSingular());
+	ASSERT_EQ(0, singular.determinant());
+	ASSERT_THROW(singular.solve(Real4::Ones()), Exception);
+	ASSERT_FALSE(CholeskyDecomposition<4>(-Matrix<4, 4>::Identity()).isPositiveDefinite());
+	ASSERT_THROW(CholeskyDecomposition<4>(Matrix<4, 4>::Zeros()).solve(Real4::Ones()),
+			Exception);
+	ASSERT_FALSE((QrDecomposition<5, 2>(Matrix<5, 2>::Zeros()).isFullRank()));
+}
+
+
 TEST(Linal, linesIntersection2D) {
 	ASSERT_EQ(Real2({1, 1}), 
 			linesIntersection(Real2({1, 0}),  Real2({1, 2}), Real2({0, 1}), Real2({2, 1})));
@@ -1522,4 +1630,82 @@ TEST(Linal, symmDirectProduct) {
 }
 
 
+template<int M>
+void testAlignedMatrixVectorProduct() {
+	static_assert(sizeof(AlignedVector<M>) % alignof(std::max_align_t) == 0, "");
+	std::vector<AlignedSquareMatrix<M>> matrices(7);
+	for (const auto& m : matrices) {
+		ASSERT_EQ(0u, (size_t)m.data() % alignof(std::max_align_t));
+	}
+	
+	Utils::seedRand();
+	for (int i = 0; i < LINAL_TEST_NUMBER_ITERATIONS; i++) {
+		const auto A = random<Matrix<M, M>>();
+		const auto v = random<Matrix<M, 1>>();
+		const AlignedSquareMatrix<M> alignedA = A;
+		const AlignedVector<M> alignedV = v;
+		ASSERT_EQ(A, alignedA);
+		ASSERT_TRUE(approximatelyEqual(A * v, alignedA * alignedV))
+				<< A * v << alignedA * alignedV;
+	}
+}
+
+
+TEST(Linal, AlignedMatrixVectorProduct) {
+	testAlignedMatrixVectorProduct<5>();
+	testAlignedMatrixVectorProduct<9>();
+}
+
+
+/**
+ * Time of matrix * vector products over arrays of matrices and vectors
+ * @param checksum squared length of the sum of all products
+ * @return nanoseconds per product
+ */
+template<int M, template<int, typename> class TContainer>
+double timeOfMatrixVectorProducts(const std::vector<Matrix<M, M>>& inputMatrices,
+		const std::vector<Matrix<M, 1>>& inputVectors, real& checksum) {
+	typedef MatrixBase<M, M, real, NonSymmetric, TContainer> SquareMatrix;
+	typedef MatrixBase<M, 1, real, NonSymmetric, TContainer> ColumnVector;
+	const std::vector<SquareMatrix> matrices(inputMatrices.begin(), inputMatrices.end());
+	const std::vector<ColumnVector> vectors(inputVectors.begin(), inputVectors.end());
+	
+	const int repeats = 1000;
+	ColumnVector sum = Matrix<M, 1>::Zeros();
+	const auto t1 = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeats; repeat++) {
+		for (size_t i = 0; i < vectors.size(); i++) {
+			sum += matrices[i % matrices.size()] * vectors[i];
+		}
+	}
+	const auto t2 = std::chrono::high_resolution_clock::now();
+	checksum = 0;
+	for (int i = 0; i < M; i++) { checksum += sum(i) * sum(i); }
+	return std::chrono::duration<double, std::nano>(t2 - t1).count() /
+			(double)(repeats * vectors.size());
+}
+
+
+template<int M>
+void benchmarkMatrixVectorProduct(const std::string& key) {
+	Utils::seedRand();
+	std::vector<Matrix<M, M>> matrices(64);
+	for (auto& m : matrices) { m = random<Matrix<M, M>>(-1, 1); }
+	std::vector<Matrix<M, 1>> vectors(1024);
+	for (auto& v : vectors) { v = random<Matrix<M, 1>>(-1, 1); }
+	
+	real genericSum, kernelSum;
+	const double generic = timeOfMatrixVectorProducts<M, DefaultContainer>(
+			matrices, vectors, genericSum);
+	const double kernel = timeOfMatrixVectorProducts<M, AlignedContainer>(
+			matrices, vectors, kernelSum);
+	::testing::Test::RecordProperty(key + "_generic_ps", (int)(1000 * generic));
+	::testing::Test::RecordProperty(key + "_kernel_ps", (int)(1000 * kernel));
+	ASSERT_NEAR(genericSum, kernelSum, EQUALITY_TOLERANCE * (1 + genericSum));
+}
+
 
+TEST(Linal, AlignedMatrixVectorProductBenchmark) {
+	benchmarkMatrixVectorProduct<5>("matrix55_vector");
+	benchmarkMatrixVectorProduct<9>("matrix99_vector");
+}
@@ -129,6 +129,7 @@ inline void test3DFigure(
 	task.simplexGrid.fileName = filename;
 	Triangulation triangulation(task);
 	Grid grid(0, {&triangulation});
+	size_t numberOfWalks = 0;
 	real step = task.simplexGrid.spatialStep / 3;
 	for (int i = 0; i < 16; i++) {
 		real phi = i * M_PI / 8;
@@ -140,17 +141,22 @@ inline void test3DFigure(
 			testWholeGridOneDirection(grid, direction, 10,
 					[&](Iterator it, RealD shift, int& hitCounter) {
 						Cell c = grid.findCellCrossedByTheRay(it, shift);
+						numberOfWalks++;
 						testContains(grid, c, it, shift, hitCounter);
 					}, hitCount);
 			ASSERT_GT(hitCount, hitCountMin);
 			testWholeGridOneDirection(grid, direction, 10,
 					[&](Iterator it, RealD shift, int&) {
 						Cell lw = grid.findCellCrossedByTheRay(it, shift);
+						numberOfWalks++;
 						Cell cgal = grid.locateOwnerCell(it, shift);
 						matchSearchResults(grid, lw, cgal, it, shift);
 					}, hitCount);
 		}
 	}
+	/// rays along the borders of CGAL meshes can be degenerate,
+	/// but exact predicates leave almost no work for the fallback walk
+	ASSERT_LE(grid.numberOfFallbackWalks(), numberOfWalks / 1000);
 }
 
 TEST(LineWalkSearch3D, VersusLinalAndCgal) {
@@ -251,6 +257,7 @@ TEST(LineWalkSearch3D, CasesAlongBorder) {
 
 inline void testSkullGrid(const size_t gridId, Triangulation* triangulation) {
 	Grid grid(gridId, {triangulation});
+	size_t numberOfWalks = 0;
 	real h = grid.getAverageHeight(), step = h / 3;
 	for (int i = 0; i < 16; i++) {
 		real phi = i * M_PI / 8;
@@ -262,12 +269,15 @@ inline void testSkullGrid(const size_t gridId, Triangulation* triangulation) {
 			testWholeGridOneDirection(grid, direction, 10,
 					[&](Iterator it, RealD shift, int& hitCounter) {
 						Cell c = grid.findCellCrossedByTheRay(it, shift);
+						numberOfWalks++;
 						testContains(grid, c, it, shift, hitCounter);
 					}, hitCount);
 			std::cout << "i == " << i << " j == " << j
 					<< " hitCount == " << hitCount << std::endl;
 		}
 	}
+	/// the first line walk always succeeds on unstructured INM meshes
+	ASSERT_EQ(0, grid.numberOfFallbackWalks());
 }
 
 inline void testSkull(const std::string filename) {
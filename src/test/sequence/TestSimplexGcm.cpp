@@ -2,8 +2,11 @@
 
 #include <libgcm/engine/simplex/Engine.hpp>
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
+#include <libgcm/grid/simplex/mesh_loaders/BinaryMeshLoader.hpp>
 #include <libgcm/util/math/Area.hpp>
 #include <libgcm/rheology/models/models.hpp>
+#include <libgcm/rheology/ode/Ode.hpp>
 
 #include <libgcm/engine/simplex/DefaultMesh.hpp>
 #include <libgcm/grid/simplex/SimplexGrid.hpp>
@@ -67,3 +70,447 @@ TEST(Engine, ZeroInitialization) {
 }
 
 
+TEST(Engine, SummAccumulation) {
+	Task task;
+	task.globalSettings.dimensionality = 2;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.CourantNumber = 1;
+	task.globalSettings.numberOfSnaps = 1;
+	task.globalSettings.stepsPerSnap = 1;
+	task.globalSettings.splittingType = SplittingType::SUMM;
+	
+	task.bodies = {{1, {Materials::T::ISOTROPIC, Models::T::ACOUSTIC, {}}}};
+	task.simplexGrid.spatialStep = 1.15;
+	Task::SimplexGrid::Body::Border bodyBorder = {{0, 3}, {4, 0}, {0, 0}};
+	task.simplexGrid.bodies = {Task::SimplexGrid::Body({1, bodyBorder, {} })};
+	
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	const auto material = std::make_shared<IsotropicMaterial>(4, 2, 1, 0, 0, 0, 0);
+	task.materialConditions.byBodies.bodyMaterialMap = { {1, material} };
+	
+	Wrapper::ENGINE engine(task);
+	auto mesh = std::const_pointer_cast<Wrapper::Mesh>(Wrapper::getMesh(engine, 1));
+	typedef Wrapper::Mesh::PdeVector PdeVector;
+	const int numberOfStages = 2;
+	auto stageResult = [&](const int stage, const Wrapper::Mesh::Iterator& it) {
+		PdeVector ans;
+		for (int m = 0; m < PdeVector::M; m++) {
+			ans(m) = std::sin(real(mesh->getIndex(it) * (size_t)(stage + 1) + (size_t)m));
+		}
+		return ans;
+	};
+	
+	/// stages results are accumulated in one layer
+	for (int stage = 0; stage < numberOfStages; stage++) {
+		for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+			mesh->_pdeNew(0, it) = stageResult(stage, it);
+		}
+		if (stage == numberOfStages - 1) {
+			mesh->averageAccumulatedAndNewPdeLayersToCurrent(0, numberOfStages);
+		} else {
+			mesh->accumulateNewPdeLayer(0, stage == 0);
+		}
+	}
+	
+	/// the same as averaging of separate per-stage layers
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		PdeVector expected = PdeVector::Zeros();
+		for (int stage = 0; stage < numberOfStages; stage++) {
+			expected += stageResult(stage, it) / numberOfStages;
+		}
+		ASSERT_TRUE(linal::approximatelyEqual(expected, mesh->pde(it)))
+				<< expected << mesh->pde(it);
+	}
+}
+
+
+
+TEST(Engine, IdealPlasticFlow) {
+	Task task;
+	task.globalSettings.dimensionality = 2;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.CourantNumber = 1;
+	task.globalSettings.numberOfSnaps = 1;
+	task.globalSettings.stepsPerSnap = 1;
+	
+	task.bodies = {{1, {Materials::T::ISOTROPIC, Models::T::ELASTIC,
+			{Odes::T::CONTINUAL_DAMAGE, Odes::T::IDEAL_PLASTIC_FLOW}}}};
+	task.simplexGrid.spatialStep = 1.15;
+	Task::SimplexGrid::Body::Border bodyBorder = {{0, 3}, {4, 0}, {0, 0}};
+	task.simplexGrid.bodies = {Task::SimplexGrid::Body({1, bodyBorder, {} })};
+	
+	/// the material is plastic, but not damageable
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	const auto material = std::make_shared<IsotropicMaterial>(4, 2, 0.5, 1, 0, 0, 0);
+	task.materialConditions.byBodies.bodyMaterialMap = { {1, material} };
+	
+	typedef DefaultMesh<ElasticModel<2>, SimplexGrid<2, CgalTriangulation>,
+			IsotropicMaterial> Mesh;
+	Wrapper::ENGINE engine(task);
+	auto mesh = std::const_pointer_cast<Mesh>(
+			std::dynamic_pointer_cast<const Mesh>(engine.getMesh(1)));
+	ASSERT_TRUE(mesh);
+	const Mesh::OdeVariables& odeVars = mesh->odeVars();
+	ASSERT_EQ(mesh->sizeOfRealNodes(), odeVars.size());
+	ASSERT_TRUE(odeVars.damage.empty());
+	ASSERT_EQ(odeVars.size(), odeVars.plasticStrain.size());
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		ASSERT_TRUE(odeVars.hasSlot(mesh->getIndex(it)));
+		ASSERT_EQ(mesh->getIndex(it),
+				mesh->getIndex(odeVars.nodes[odeVars.slot(mesh->getIndex(it))]));
+	}
+	
+	/// pressure 1 and J2 = sqrt(8) above the yield strength 1
+	const ElasticModel<2>::SigmaD sigma({1, 2, -3});
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		mesh->_pdeVars(it).setSigma(sigma);
+	}
+	IdealPlasticFlowCorrector<Mesh>().apply(*mesh, 0.5);
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		ASSERT_NEAR(1, mesh->pdeVars(it).getPressure(), EQUALITY_TOLERANCE);
+		ASSERT_NEAR(1, mesh->pdeVars(it).getJ2(), EQUALITY_TOLERANCE);
+		ASSERT_NEAR((sqrt(8) - 1) / 0.5,
+				odeVars.plasticStrain[odeVars.slot(mesh->getIndex(it))],
+				EQUALITY_TOLERANCE);
+	}
+}
+
+
+
+
+/**
+ * Relative difference of pressures after the same time calculated
+ * with local time stepping (task.simplexGrid.maxTimeLevel) and
+ * with the global finest time step. Body 0 is acoustic isotropic
+ * with pressure pulse at the center and free borders
+ * @param numberOfSteps required time in the coarsest time steps
+ */
+template<template<int, typename, typename> class TriangulationT>
+real differenceOfLocalAndGlobalTimeStepping(Task task, const int numberOfSteps) {
+	typedef DefaultMesh<AcousticModel<2>, SimplexGrid<2, TriangulationT>,
+			IsotropicMaterial> Mesh;
+	typedef Engine<2, TriangulationT> ENGINE;
+	auto getMesh = [](const ENGINE& engine) {
+		auto mesh = std::dynamic_pointer_cast<const Mesh>(engine.getMesh(0));
+		assert_true(mesh);
+		return mesh;
+	};
+	
+	task.globalSettings.dimensionality = 2;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.CourantNumber = 1;
+	task.globalSettings.numberOfSnaps = 0;
+	task.globalSettings.verboseTimeSteps = false;
+	/// random bases would differ in the runs with different time steps
+	task.calculationBasis = {1, 0, 0, 1};
+	task.bodies = {{0, {Materials::T::ISOTROPIC, Models::T::ACOUSTIC, {}}}};
+	
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	const auto material = std::make_shared<IsotropicMaterial>(4, 2, 1, 0, 0, 0, 0);
+	task.materialConditions.byBodies.bodyMaterialMap = { {0, material} };
+	
+	Task::BorderCondition borderConditionAll;
+	borderConditionAll.area = std::make_shared<InfiniteArea>();
+	borderConditionAll.type = BorderConditions::T::FIXED_FORCE;
+	borderConditionAll.values = {[] (real) { return 0; }};
+	task.borderConditions = {borderConditionAll};
+	
+	/// the same time for both runs: numberOfSteps coarsest time steps
+	task.globalSettings.requiredTime = 1;
+	int numberOfSubsteps = 0;
+	real coarsestTimeStep = 0;
+	{
+		ENGINE probe(task);
+		const auto mesh = getMesh(probe);
+		assert_gt(mesh->numberOfTimeLevels(), 1);
+		int numberOfInnerNodes = 0;
+		for (int level = 0; level < mesh->numberOfTimeLevels(); level++) {
+			numberOfInnerNodes += (int)(mesh->timeLevelEnd(level) - mesh->timeLevelBegin(level));
+		}
+		assert_eq(mesh->innerEnd() - mesh->innerBegin(), numberOfInnerNodes);
+		numberOfSubsteps = Mesh::timeLevelMultiplier(mesh->numberOfTimeLevels() - 1);
+		coarsestTimeStep = Clock::TimeStep();
+	}
+	
+	task.globalSettings.requiredTime = (numberOfSteps - 0.5) * coarsestTimeStep;
+	ENGINE local(task);
+	local.run();
+	
+	task.simplexGrid.maxTimeLevel = 0;
+	task.globalSettings.requiredTime = (numberOfSteps * numberOfSubsteps - 0.5) *
+			coarsestTimeStep / numberOfSubsteps;
+	ENGINE global(task);
+	global.run();
+	
+	const auto localMesh = getMesh(local);
+	const auto globalMesh = getMesh(global);
+	assert_eq(globalMesh->sizeOfRealNodes(), localMesh->sizeOfRealNodes());
+	real difference = 0, norm = 0;
+	for (auto it = globalMesh->begin(); it != globalMesh->end(); ++it) {
+		const real p = Mesh::PdeVariables::GetPressure(globalMesh->pde(it));
+		const real q = Mesh::PdeVariables::GetPressure(localMesh->pde(it));
+		difference += (p - q) * (p - q);
+		norm += p * p;
+	}
+	assert_gt(norm, 0);
+	return std::sqrt(difference / norm);
+}
+
+
+TEST(Engine, LocalTimeStepping) {
+	Task task;
+	/// fine border discretization and large spatial step in the middle
+	/// give a mesh graded from the border to the center
+	task.simplexGrid.spatialStep = 2;
+	Task::SimplexGrid::Body::Border bodyBorder;
+	const int numberOfBorderPoints = 120;
+	for (int i = 0; i < numberOfBorderPoints; i++) {
+		const real phi = 2 * M_PI * i / numberOfBorderPoints;
+		bodyBorder.push_back({4 * std::cos(phi), 4 * std::sin(phi)});
+	}
+	task.simplexGrid.bodies = {Task::SimplexGrid::Body({0, bodyBorder, {} })};
+	
+	Task::InitialCondition::Quantity pressure;
+	pressure.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	pressure.value = 1;
+	pressure.area = std::make_shared<SphereArea>(1.5, Real3({0, 0, 0}));
+	task.initialCondition.quantities.push_back(pressure);
+	
+	task.simplexGrid.maxTimeLevel = 2;
+	ASSERT_LT(differenceOfLocalAndGlobalTimeStepping<CgalTriangulation>(task, 4), 0.2);
+}
+
+
+/**
+ * Orthotropic body with new random calculation basis at each time step
+ * and border nodes calculated in local bases given by border normals,
+ * so gcm matrices of all nodes are constructed in non-trivial bases
+ */
+template<int Dimensionality>
+void testOrthotropicLocalBasis(Task task, const size_t bodyId,
+		const Real3 anglesOfRotation, std::shared_ptr<Area> pulseArea) {
+	typedef DefaultMesh<ElasticModel<Dimensionality>,
+			SimplexGrid<Dimensionality, CgalTriangulation>, OrthotropicMaterial> Mesh;
+	typedef typename Mesh::RealD RealD;
+	
+	task.globalSettings.dimensionality = Dimensionality;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.CourantNumber = 1;
+	task.globalSettings.numberOfSnaps = 1;
+	task.globalSettings.stepsPerSnap = 10;
+	/// task.calculationBasis is empty - new random basis at each time step
+	task.globalSettings.gcmType = GcmType::ADVECT_PDE_VECTORS;
+	task.simplexGrid.borderCalcMode = BorderCalcMode::LOCAL_BASIS;
+	task.bodies = {{bodyId, {Materials::T::ORTHOTROPIC, Models::T::ELASTIC, {}}}};
+	
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	const auto material = std::make_shared<OrthotropicMaterial>(OrthotropicMaterial(
+			4, {360, 70, 70, 180, 70, 90, 10, 10, 10}, 0, 0, anglesOfRotation));
+	task.materialConditions.byBodies.bodyMaterialMap = { {bodyId, material} };
+	
+	Task::BorderCondition borderConditionAll;
+	borderConditionAll.area = std::make_shared<InfiniteArea>();
+	borderConditionAll.type = BorderConditions::T::FIXED_FORCE;
+	for (int i = 0; i < Dimensionality; i++) {
+		borderConditionAll.values.push_back([] (real) { return 0; });
+	}
+	task.borderConditions = {borderConditionAll};
+	
+	Task::InitialCondition::Quantity pressure;
+	pressure.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	pressure.value = 1;
+	pressure.area = pulseArea;
+	task.initialCondition.quantities.push_back(pressure);
+	
+	Engine<Dimensionality, CgalTriangulation> engine(task);
+	const auto mesh = std::dynamic_pointer_cast<const Mesh>(engine.getMesh(bodyId));
+	ASSERT_TRUE(mesh);
+	/// matrices of border nodes are along their normals
+	ASSERT_TRUE(mesh->borderBegin() != mesh->borderEnd());
+	for (auto it = mesh->borderBegin(); it != mesh->borderEnd(); ++it) {
+		const RealD direction = mesh->matrices(*it)->basis.getColumn(0);
+		ASSERT_TRUE(linal::approximatelyEqual(mesh->borderNormal(*it), direction, 1e-6))
+				<< mesh->borderNormal(*it) << direction;
+	}
+	
+	engine.run();
+	/// the pulse has left the area, but neither grows nor turns into NaN
+	real norm = 0;
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		const auto& u = mesh->pde(it);
+		for (int j = 0; j < Mesh::PdeVector::M; j++) {
+			ASSERT_LT(std::fabs(u(j)), 3) << u;
+			norm += u(j) * u(j);
+		}
+	}
+	ASSERT_GT(norm, 0);
+}
+
+
+TEST(Engine, OrthotropicLocalBasis2D) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.3;
+	Task::SimplexGrid::Body::Border bodyBorder = {{0, 3}, {4, 0}, {0, 0}};
+	task.simplexGrid.bodies = {Task::SimplexGrid::Body({1, bodyBorder, {} })};
+	/// in 2D, main axes of the material are along the coordinate ones
+	testOrthotropicLocalBasis<2>(task, 1, Real3::Zeros(),
+			std::make_shared<SphereArea>(0.7, Real3({1, 1, 0})));
+}
+
+
+TEST(Engine, OrthotropicLocalBasis3D) {
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::CGAL_MESHER;
+	task.simplexGrid.spatialStep = 0.4;
+	task.simplexGrid.fileName = "meshes/icosahedron.off";
+	/// general anisotropy: main axes of the material are rotated
+	testOrthotropicLocalBasis<3>(task, 0, Real3({0.3, 0.5, 0.7}),
+			std::make_shared<SphereArea>(0.5, Real3({0, 0, 0})));
+}
+
+
+/**
+ * Write square [-1, 1]^2 divided into n*n squares of two triangles,
+ * diagonals of neighbor squares alternate.
+ * Uniform coordinates s are mapped to s * (1 + grading * (1 - |s|)),
+ * so for grading in (0, 1) cells near the border are finer
+ */
+std::string writeSquareMesh(const int n, const real grading = 0) {
+	auto coordinate = [n, grading](const int i) {
+		const real s = 2.0 * i / n - 1;
+		return s * (1 + grading * (1 - std::fabs(s)));
+	};
+	std::vector<double> points;
+	for (int j = 0; j <= n; j++) {
+		for (int i = 0; i <= n; i++) {
+			points.push_back(coordinate(i));
+			points.push_back(coordinate(j));
+		}
+	}
+	std::vector<BinaryMeshLoader::Index> cells;
+	for (int j = 0; j < n; j++) {
+		for (int i = 0; i < n; i++) {
+			const BinaryMeshLoader::Index v = j * (n + 1) + i;
+			if ((i + j) % 2 == 0) {
+				cells.insert(cells.end(), {v, v + 1, v + n + 2,  v, v + n + 2, v + n + 1});
+			} else {
+				cells.insert(cells.end(), {v, v + 1, v + n + 1,  v + 1, v + n + 2, v + n + 1});
+			}
+		}
+	}
+	const std::string fileName = "snapshots/square.bin";
+	BinaryMeshLoader::write(fileName, 2, points, cells, {}, {});
+	return fileName;
+}
+
+
+/**
+ * Pressure pulse in the square of the given material after some time steps
+ * with borders in local bases and constant rotated calculation basis
+ */
+template<typename Material>
+std::vector<real> solveInSquareWithLocalBasisBorders(
+		const std::shared_ptr<Material> material) {
+	typedef DefaultMesh<ElasticModel<2>, SimplexGrid<2, FlatTriangulation>, Material> Mesh;
+	
+	Task task;
+	task.globalSettings.dimensionality = 2;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.gcmType = GcmType::ADVECT_PDE_VECTORS;
+	task.globalSettings.CourantNumber = 0.9;
+	task.globalSettings.numberOfSnaps = 1;
+	task.globalSettings.stepsPerSnap = 60;
+	task.calculationBasis = {0.6, -0.8, 0.8, 0.6};
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::BINARY_MESHER;
+	task.simplexGrid.fileName = writeSquareMesh(16);
+	task.simplexGrid.borderCalcMode = BorderCalcMode::LOCAL_BASIS;
+	task.bodies = {{0, {Material::Type, Models::T::ELASTIC, {}}}};
+	
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	task.materialConditions.byBodies.bodyMaterialMap = { {0, material} };
+	
+	Task::BorderCondition borderConditionAll;
+	borderConditionAll.area = std::make_shared<InfiniteArea>();
+	borderConditionAll.type = BorderConditions::T::FIXED_FORCE;
+	borderConditionAll.values = {[] (real) { return 0; }, [] (real) { return 0; }};
+	task.borderConditions = {borderConditionAll};
+	
+	/// the pulse reaches the border at the first time step
+	Task::InitialCondition::Quantity pressure;
+	pressure.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	pressure.value = 1;
+	pressure.area = std::make_shared<SphereArea>(0.8, Real3({0.3, -0.2, 0}));
+	task.initialCondition.quantities.push_back(pressure);
+	
+	Engine<2, FlatTriangulation> engine(task);
+	engine.run();
+	const auto mesh = std::dynamic_pointer_cast<const Mesh>(engine.getMesh(0));
+	assert_true(mesh);
+	std::vector<real> ans;
+	for (auto it = mesh->begin(); it != mesh->end(); ++it) {
+		for (int j = 0; j < Mesh::PdeVector::M; j++) {
+			ans.push_back(mesh->pde(it)(j));
+		}
+	}
+	return ans;
+}
+
+
+TEST(Engine, OrthotropicAsIsotropicLocalBasis) {
+	/// the same waves are outer on borders regardless of their order
+	/// in gcm matrices of isotropic and orthotropic materials
+	const auto isotropic = std::make_shared<IsotropicMaterial>(4, 2, 1, 0, 0, 0, 0);
+	const auto orthotropic = std::make_shared<OrthotropicMaterial>(*isotropic);
+	const std::vector<real> expected = solveInSquareWithLocalBasisBorders(isotropic);
+	const std::vector<real> actual = solveInSquareWithLocalBasisBorders(orthotropic);
+	ASSERT_EQ(expected.size(), actual.size());
+	real difference = 0, norm = 0;
+	for (size_t i = 0; i < expected.size(); i++) {
+		difference += (expected[i] - actual[i]) * (expected[i] - actual[i]);
+		norm += expected[i] * expected[i];
+	}
+	ASSERT_GT(norm, 0);
+	/// roundoff can switch limiters, wrong outer waves give ~1e-2
+	ASSERT_LT(std::sqrt(difference / norm), 1e-6);
+}
+
+
+TEST(Engine, LocalBasisRequiresPdeVectors) {
+	Task task;
+	task.globalSettings.dimensionality = 2;
+	task.globalSettings.gridId = Grids::T::SIMPLEX;
+	task.globalSettings.gcmType = GcmType::ADVECT_RIEMANN_INVARIANTS;
+	task.simplexGrid.borderCalcMode = BorderCalcMode::LOCAL_BASIS;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::BINARY_MESHER;
+	task.simplexGrid.fileName = writeSquareMesh(2);
+	task.bodies = {{0, {Materials::T::ISOTROPIC, Models::T::ACOUSTIC, {}}}};
+	typedef Engine<2, FlatTriangulation> FlatEngine;
+	ASSERT_THROW(FlatEngine engine(task), Exception);
+}
+
+
+
+TEST(Engine, LocalTimeSteppingConvergence) {
+	/// square mesh graded from the border to the center by 1:19
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::BINARY_MESHER;
+	task.simplexGrid.maxTimeLevel = 2;
+	Task::InitialCondition::Quantity pressure;
+	pressure.physicalQuantity = PhysicalQuantities::T::PRESSURE;
+	pressure.value = 1;
+	pressure.area = std::make_shared<SphereArea>(0.5, Real3({0, 0, 0}));
+	task.initialCondition.quantities.push_back(pressure);
+	
+	/// local time stepping converges to the global one with refinement
+	/// of the mesh, calculated to the same time (the coarsest time step
+	/// is proportional to the spatial one); it is ~0.08, 0.04, 0.03 now
+	real previousDifference = 1;
+	for (const int n : {16, 32, 64}) {
+		task.simplexGrid.fileName = writeSquareMesh(n, 0.9);
+		const real difference =
+				differenceOfLocalAndGlobalTimeStepping<FlatTriangulation>(task, n / 4);
+		ASSERT_LT(difference, previousDifference);
+		previousDifference = difference;
+	}
+	ASSERT_LT(previousDifference, 0.04);
+}
@@ -1,9 +1,20 @@
 #include <libgcm/grid/simplex/cgal/CgalTriangulation.hpp>
+#include <libgcm/grid/simplex/flat/FlatTriangulation.hpp>
 #include <libgcm/grid/simplex/SimplexGrid.hpp>
+#include <libgcm/grid/simplex/MeshSizing.hpp>
 #include <libgcm/util/snapshot/VtkSnapshotter.hpp>
+#include <libgcm/util/Utils.hpp>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 using namespace gcm;
 
 
@@ -91,3 +102,421 @@ TEST(SimplexGrid3D, miscellaneous) {
 }
 
 
+TEST(SimplexGrid3D, parallelMeshing) {
+	Task task;
+	task.simplexGrid.mesher = Task::SimplexGrid::Mesher::CGAL_MESHER;
+	task.simplexGrid.fileName = "meshes/tetrahedron.off";
+	task.simplexGrid.detectSharpEdges = true;
+	task.simplexGrid.spatialStep = 0.3;
+	typedef SimplexGrid<3, CgalTriangulation> Grid;
+	
+	const real tetrahedronVolume = linal::volume(Real3({0, 0, 2}),
+			Real3({1.632993, -0.942809, -0.666667}), Real3({0, 1.885618, -0.666667}),
+			Real3({-1.632993, -0.942809, -0.666667}));
+	size_t sizes[2];
+	real heights[2];
+	for (int parallel = 0; parallel < 2; parallel++) {
+		task.simplexGrid.parallelMeshing = parallel;
+		Grid::Triangulation triangulation(task);
+		Grid grid(0, {&triangulation});
+		sizes[parallel] = grid.sizeOfAllNodes();
+		
+		/// sharp edges are protected, so the body is filled exactly
+		real volume = 0;
+		for (auto ch = grid.cellBegin(); ch != grid.cellEnd(); ++ch) {
+			const auto cell = grid.createCell(*ch);
+			volume += linal::volume(grid.coordsD(cell(0)), grid.coordsD(cell(1)),
+					grid.coordsD(cell(2)), grid.coordsD(cell(3)));
+		}
+		ASSERT_NEAR(tetrahedronVolume, volume, 1e-3 * tetrahedronVolume);
+		heights[parallel] = grid.getAverageHeight();
+	}
+	/// meshes are not the same, but similar
+	ASSERT_NEAR(1, (real)sizes[1] / (real)sizes[0], 0.2);
+	ASSERT_NEAR(1, heights[1] / heights[0], 0.2);
+}
+
+
+/// Run with --gtest_also_run_disabled_tests,
+/// timings are recorded as test properties (see --gtest_output=xml)
+TEST(SimplexGrid3D, DISABLED_parallelMeshingBenchmark) {
+	struct Case {
+		std::string name;
+		std::string fileName;
+		bool detectSharpEdges;
+		real spatialStep;
+	};
+	const std::vector<Case> cases = {
+		{"tetrahedron_0.1", "meshes/tetrahedron.off", true, 0.1},
+		{"cube_0.05", "meshes/cube.off", true, 0.05},
+		{"icosahedron_0.2", "meshes/icosahedron.off", false, 0.2},
+	};
+	typedef SimplexGrid<3, CgalTriangulation> Grid;
+	
+	for (const Case& c : cases) {
+		Task task;
+		task.simplexGrid.mesher = Task::SimplexGrid::Mesher::CGAL_MESHER;
+		task.simplexGrid.fileName = c.fileName;
+		task.simplexGrid.detectSharpEdges = c.detectSharpEdges;
+		task.simplexGrid.spatialStep = c.spatialStep;
+		
+		for (int parallel = 0; parallel < 2; parallel++) {
+			task.simplexGrid.parallelMeshing = parallel;
+			const auto t1 = std::chrono::high_resolution_clock::now();
+			Grid::Triangulation triangulation(task);
+			const auto t2 = std::chrono::high_resolution_clock::now();
+			Grid grid(0, {&triangulation});
+			const std::string key = c.name + (parallel ? "_parallel" : "_sequential");
+			RecordProperty(key + "_ms", (int)std::chrono::duration_cast<
+					std::chrono::milliseconds>(t2 - t1).count());
+			RecordProperty(key + "_nodes", (int)grid.sizeOfAllNodes());
+		}
+	}
+}
+
+
+TEST(SimplexGrid2D, flatTriangulation) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.5;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, CgalTriangulation> CgalGrid;
+	typedef SimplexGrid<2, FlatTriangulation> FlatGrid;
+	typename CgalGrid::Triangulation cgalTriangulation(task);
+	typename FlatGrid::Triangulation flatTriangulation(task);
+	CgalGrid cgal(0, {&cgalTriangulation});
+	FlatGrid flat(0, {&flatTriangulation});
+	
+	ASSERT_EQ(cgal.sizeOfAllNodes(), flat.sizeOfAllNodes());
+	ASSERT_EQ(cgal.innerEnd() - cgal.innerBegin(), flat.innerEnd() - flat.innerBegin());
+	ASSERT_EQ(cgal.borderEnd() - cgal.borderBegin(), flat.borderEnd() - flat.borderBegin());
+	ASSERT_NEAR(cgal.getAverageHeight(), flat.getAverageHeight(), EQUALITY_TOLERANCE);
+	
+	for (auto it = flat.borderBegin(); it != flat.borderEnd(); ++it) {
+		const auto cgalIt = cgal.findVertexByCoordinates(flat.coordsD(*it));
+		ASSERT_TRUE(cgal.isBorder(cgalIt));
+		ASSERT_EQ(cgal.borderNormal(cgalIt), flat.borderNormal(*it));
+	}
+	
+	const Real2 shift = {0.1, 0.05};
+	for (auto it = flat.innerBegin(); it != flat.innerEnd(); ++it) {
+		const auto cgalIt = cgal.findVertexByCoordinates(flat.coordsD(*it));
+		ASSERT_EQ(cgal.findNeighborVertices(cgalIt).size(),
+				flat.findNeighborVertices(*it).size());
+		
+		const auto cgalCell = cgal.findCellCrossedByTheRay(cgalIt, shift);
+		const auto flatCell = flat.findCellCrossedByTheRay(*it, shift);
+		ASSERT_EQ(cgalCell.n, flatCell.n);
+		for (int i = 0; i < flatCell.n; i++) {
+			bool found = false;
+			for (int j = 0; j < cgalCell.n; j++) {
+				found = found || cgal.coordsD(cgalCell(j)) == flat.coordsD(flatCell(i));
+			}
+			ASSERT_TRUE(found);
+		}
+		
+		const auto located = flat.locateOwnerCell(*it, shift);
+		ASSERT_EQ(flatCell.n, located.n);
+	}
+}
+
+
+TEST(SimplexGrid2D, flatTriangulationCache) {
+	/// fresh directory, so nothing is cached by previous runs
+	char directory[] = "flatTriangulationCacheXXXXXX";
+	ASSERT_TRUE(mkdtemp(directory) != nullptr);
+	
+	Task task;
+	task.simplexGrid.spatialStep = 0.3;
+	task.simplexGrid.triangulationCacheDirectory = directory;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, FlatTriangulation> Grid;
+	/// the first one is meshed, the second one is read from cache
+	typename Grid::Triangulation meshed(task);
+	typename Grid::Triangulation cached(task);
+	ASSERT_FALSE(meshed.isReadFromCache());
+	ASSERT_TRUE(cached.isReadFromCache());
+	Grid a(0, {&meshed});
+	Grid b(0, {&cached});
+	
+	ASSERT_EQ(a.sizeOfAllNodes(), b.sizeOfAllNodes());
+	ASSERT_EQ(a.innerEnd() - a.innerBegin(), b.innerEnd() - b.innerBegin());
+	for (const auto it : a) {
+		ASSERT_EQ(a.coordsD(it), b.coordsD(it));
+		ASSERT_EQ(a.findNeighborVertices(it), b.findNeighborVertices(it));
+	}
+	
+	/// another mesher input is not read from the same cache
+	task.simplexGrid.spatialStep = 0.25;
+	typename Grid::Triangulation other(task);
+	ASSERT_FALSE(other.isReadFromCache());
+	
+	DIR* dir = opendir(directory);
+	ASSERT_TRUE(dir != nullptr);
+	int numberOfFiles = 0;
+	while (const dirent* entry = readdir(dir)) {
+		const std::string name = entry->d_name;
+		if (name == "." || name == "..") { continue; }
+		ASSERT_EQ(0, std::remove((std::string(directory) + "/" + name).c_str()));
+		numberOfFiles++;
+	}
+	closedir(dir);
+	ASSERT_EQ(2, numberOfFiles);
+	ASSERT_EQ(0, rmdir(directory));
+}
+
+
+TEST(SimplexGrid2D, findCellsCrossedByTheRay) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.2;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, CgalTriangulation> Grid;
+	typedef typename Grid::Triangulation Triangulation;
+	Triangulation triangulation(task);
+	Grid grid(0, {&triangulation});
+	
+	const linal::Vector<5> distances = {0.05, -0.1, 0, 0.31, -0.02};
+	for (int d = 0; d < 12; d++) {
+		const real phi = 2 * M_PI * d / 12 + 0.1;
+		const Real2 direction = {cos(phi), sin(phi)};
+		for (const auto it : grid) {
+			const auto cells = grid.findCellsCrossedByTheRay(it, direction, distances);
+			for (int k = 0; k < 5; k++) {
+				const auto& batched = cells[(size_t)k];
+				if (distances(k) == 0) {
+					ASSERT_EQ(0, batched.n);
+					continue;
+				}
+				const auto single = grid.findCellCrossedByTheRay(
+						it, direction * distances(k));
+				ASSERT_EQ(single.n, batched.n);
+				for (int i = 0; i < single.n; i++) {
+					ASSERT_EQ(single(i), batched(i));
+				}
+			}
+		}
+	}
+}
+
+
+TEST(SimplexGrid2D, cellsOfAllGrids) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.2;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } }),
+		Task::SimplexGrid::Body({ 1, { {1, 0}, {1, 1}, {2, 1}, {2, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, CgalTriangulation> Grid;
+	typedef typename Grid::Triangulation Triangulation;
+	Triangulation triangulation(task);
+	const auto cellsOfAllGrids = Grid::cellsOfAllGrids(&triangulation);
+	ASSERT_EQ(2, cellsOfAllGrids.size());
+	
+	for (const GridId id : {GridId(0), GridId(1)}) {
+		Grid scanned(id, {&triangulation});
+		Grid given(id, {&triangulation, &cellsOfAllGrids.at(id)});
+		
+		ASSERT_EQ(scanned.sizeOfRealNodes(), given.sizeOfRealNodes());
+		for (const auto it : scanned) {
+			ASSERT_EQ(scanned.coordsD(it), given.coordsD(it));
+		}
+		ASSERT_EQ(std::vector<Grid::LocalVertexIndex>(scanned.contactBegin(), scanned.contactEnd()),
+		          std::vector<Grid::LocalVertexIndex>(given.contactBegin(), given.contactEnd()));
+		ASSERT_EQ(std::vector<Grid::LocalVertexIndex>(scanned.borderBegin(), scanned.borderEnd()),
+		          std::vector<Grid::LocalVertexIndex>(given.borderBegin(), given.borderEnd()));
+		ASSERT_LT(0, scanned.contactEnd() - scanned.contactBegin());
+		
+		auto scannedCell = scanned.cellBegin();
+		auto givenCell = given.cellBegin();
+		for (; scannedCell != scanned.cellEnd(); ++scannedCell, ++givenCell) {
+			ASSERT_EQ(*scannedCell, *givenCell);
+		}
+	}
+}
+
+
+TEST(SimplexGrid2D, boundaryVertices) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.2;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } }),
+		Task::SimplexGrid::Body({ 1, { {1, 0}, {1, 1}, {2, 1}, {2, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, CgalTriangulation> Grid;
+	typedef typename Grid::Triangulation Triangulation;
+	Triangulation triangulation(task);
+	
+	for (const GridId id : {GridId(0), GridId(1)}) {
+		Grid grid(id, {&triangulation});
+		const auto boundary = grid.boundaryVertices();
+		
+		std::vector<Grid::LocalVertexIndex> notInner;
+		for (const auto it : grid) {
+			if (!grid.isInner(it)) { notInner.push_back(it); }
+		}
+		ASSERT_EQ(notInner.size(), boundary.size());
+		
+		for (size_t i = 0; i < boundary.size(); i++) {
+			ASSERT_EQ(notInner[i], boundary[i].vertex);
+			ASSERT_EQ(boundary[i].neighborIds.size(), boundary[i].normals.size());
+			for (size_t k = 0; k < boundary[i].neighborIds.size(); k++) {
+				const Real2 expected = grid.contactNormal(
+						boundary[i].vertex, boundary[i].neighborIds[k]);
+				const Real2 actual = linal::normalize(boundary[i].normals[k]);
+				ASSERT_NEAR(0, linal::length(expected - actual), EQUALITY_TOLERANCE);
+			}
+		}
+	}
+}
+
+
+TEST(SimplexGrid2D, spatialQueries) {
+	Task task;
+	task.simplexGrid.spatialStep = 0.2;
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 1}, {1, 1}, {1, 0} }, { } })
+	};
+	
+	typedef SimplexGrid<2, CgalTriangulation> Grid;
+	typedef typename Grid::Triangulation Triangulation;
+	Triangulation triangulation(task);
+	Grid grid(0, {&triangulation});
+	
+	for (const auto it : grid) {
+		ASSERT_EQ(it, grid.findVertexByCoordinates(grid.coordsD(it)));
+	}
+	ASSERT_THROW(grid.findVertexByCoordinates({0.5, 1.5}), Exception);
+	
+	for (int i = 0; i < 1000; i++) {
+		const Real2 point = {Utils::randomReal(-0.5, 1.5), Utils::randomReal(-0.5, 1.5)};
+		const real radius = Utils::randomReal(0, 0.5);
+		real minDistance = std::numeric_limits<real>::max();
+		std::vector<Grid::Iterator> inSphere;
+		for (const auto it : grid) {
+			const real distance = linal::length(grid.coordsD(it) - point);
+			minDistance = std::min(minDistance, distance);
+			if (distance < radius) { inSphere.push_back(it); }
+		}
+		ASSERT_EQ(minDistance,
+				linal::length(grid.coordsD(grid.findNearestVertex(point)) - point));
+		ASSERT_EQ(inSphere, grid.findVerticesInSphere(point, radius));
+		
+		const auto cell = grid.locateCell(point);
+		const bool inside = point(0) > 0 && point(0) < 1 && point(1) > 0 && point(1) < 1;
+		ASSERT_EQ(inside ? 3 : 0, cell.n) << point;
+		if (inside) {
+			ASSERT_TRUE(linal::triangleContains(grid.coordsD(cell(0)),
+					grid.coordsD(cell(1)), grid.coordsD(cell(2)), point, EQUALITY_TOLERANCE));
+			const Real3 lambda = linal::barycentricCoordinates(grid.coordsD(cell(0)),
+					grid.coordsD(cell(1)), grid.coordsD(cell(2)), point);
+			ASSERT_LT(linal::length(lambda - grid.barycentricCoordinates(cell, point)),
+					EQUALITY_TOLERANCE) << point;
+		}
+	}
+	
+	const SphereArea area(0.3, {0.5, 0.5, 0});
+	for (const auto it : grid.findVerticesInside(area)) {
+		ASSERT_TRUE(area.contains(grid.coords(it)));
+	}
+}
+
+
+TEST(SimplexGrid2D, waveSpeedAwareMeshing) {
+	Task task;
+	task.bodies = {
+		{0, {Materials::T::ISOTROPIC, Models::T::ACOUSTIC, {}}},
+		{1, {Materials::T::ISOTROPIC, Models::T::ACOUSTIC, {}}}
+	};
+	task.simplexGrid.bodies = {
+		Task::SimplexGrid::Body({ 0, { {0, 0}, {0, 2}, {2, 2}, {2, 0} }, { } }),
+		Task::SimplexGrid::Body({ 1, { {2, 0}, {2, 2}, {4, 2}, {4, 0} }, { } })
+	};
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_BODIES;
+	task.materialConditions.byBodies.bodyMaterialMap = {
+		{0, std::make_shared<IsotropicMaterial>(1, 1, 0)},
+		{1, std::make_shared<IsotropicMaterial>(1, 16, 0)}
+	};
+	task.simplexGrid.sourceFrequency = 1;
+	task.simplexGrid.nodesPerWavelength = 5;
+	
+	ASSERT_NEAR(0.5, MeshSizing::minimalWaveVelocity(
+			IsotropicMaterial(4, 2, 1), Models::T::ELASTIC), EQUALITY_TOLERANCE);
+	ASSERT_NEAR(sqrt(0.5), MeshSizing::minimalWaveVelocity(
+			IsotropicMaterial(4, 2, 1), Models::T::ACOUSTIC), EQUALITY_TOLERANCE);
+	
+	const MeshSizing sizing(task);
+	ASSERT_TRUE(sizing.isWaveSpeedAware());
+	ASSERT_NEAR(0.2, sizing({1, 1, 0}, 0), EQUALITY_TOLERANCE);
+	ASSERT_NEAR(0.8, sizing({3, 1, 0}, 1), EQUALITY_TOLERANCE);
+	ASSERT_NEAR(0.2, sizing.minimalStep(), EQUALITY_TOLERANCE);
+	ASSERT_FALSE(sizing.dependsOnAreas());
+	
+	/// sizing by areas is not identified by the triangulation cache key
+	Task byAreas = task;
+	byAreas.materialConditions.type = Task::MaterialCondition::Type::BY_AREAS;
+	byAreas.materialConditions.byAreas.defaultMaterial =
+			std::make_shared<IsotropicMaterial>(1, 1, 0);
+	ASSERT_FALSE(MeshSizing(byAreas).dependsOnAreas());
+	byAreas.materialConditions.byAreas.materials.push_back({
+			std::make_shared<AxisAlignedBoxArea>(Real3({0, 0, -1}), Real3({1, 1, 1})),
+			std::make_shared<IsotropicMaterial>(1, 16, 0)});
+	ASSERT_TRUE(MeshSizing(byAreas).dependsOnAreas());
+	
+	typedef SimplexGrid<2, CgalTriangulation> Grid;
+	typedef typename Grid::Triangulation Triangulation;
+	Triangulation triangulation(task);
+	Grid slow(0, {&triangulation});
+	Grid fast(1, {&triangulation});
+	/// the fast body is 4 times coarser, up to the gradation near the contact
+	ASSERT_GT(slow.sizeOfRealNodes(), 2 * fast.sizeOfRealNodes());
+	
+	task.simplexGrid.nodesPerWavelength = 0;
+	task.simplexGrid.spatialStep = 0.2;
+	Triangulation uniform(task);
+	Grid uniformFast(1, {&uniform});
+	ASSERT_GT(uniformFast.sizeOfRealNodes(), 2 * fast.sizeOfRealNodes());
+}
+
+
+TEST(SimplexGrid3D, meshSizingConcurrentCalls) {
+/// parallel CGAL meshing calls the sizing field from several threads
+	Task task;
+	task.simplexGrid.sourceFrequency = 1;
+	task.simplexGrid.nodesPerWavelength = 5;
+	task.materialConditions.type = Task::MaterialCondition::Type::BY_AREAS;
+	task.materialConditions.byAreas.defaultMaterial =
+			std::make_shared<IsotropicMaterial>(1, 1, 1);
+	task.materialConditions.byAreas.materials.push_back({
+			std::make_shared<AxisAlignedBoxArea>(Real3({0, 0, 0}), Real3({1, 1, 1})),
+			std::make_shared<IsotropicMaterial>(1, 16, 16)});
+	task.materialConditions.byAreas.materials.push_back({
+			std::make_shared<SphereArea>(0.5, Real3({1, 1, 1})),
+			std::make_shared<IsotropicMaterial>(1, 4, 4)});
+	const MeshSizing sizing(task);
+	
+	const int n = 40;
+	std::vector<real> sequential((size_t)(n * n * n)), parallel(sequential.size());
+	auto point = [n] (const int i) {
+		return Real3({(i % n) * 2.0 / n, (i / n % n) * 2.0 / n, (i / n / n) * 2.0 / n});
+	};
+	for (int i = 0; i < n * n * n; i++) {
+		sequential[(size_t)i] = sizing(point(i), 0);
+	}
+	#pragma omp parallel for
+	for (int i = 0; i < n * n * n; i++) {
+		parallel[(size_t)i] = sizing(point(i), 0);
+	}
+	ASSERT_EQ(sequential, parallel);
+	ASSERT_NEAR(0.2, *std::min_element(sequential.begin(), sequential.end()), EQUALITY_TOLERANCE);
+	ASSERT_NEAR(0.8, *std::max_element(sequential.begin(), sequential.end()), EQUALITY_TOLERANCE);
+}
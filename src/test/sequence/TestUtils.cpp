@@ -3,6 +3,7 @@
 #include <libgcm/util/Utils.hpp>
 #include <libgcm/util/StringUtils.hpp>
 #include <libgcm/util/math/Histogram.hpp>
+#include <libgcm/util/math/SpatialIndex.hpp>
 
 using namespace gcm;
 
@@ -50,6 +51,35 @@ TEST(StringUtils, toString) {
 }
 
 
+TEST(StringUtils, parse) {
+	const std::string s = " 12\t-3 2.5e+01 -1.406894775390625000e+03 0.1 x";
+	const char* p = s.c_str();
+	const char* const end = p + s.size();
+	
+	size_t u = 0;
+	ASSERT_TRUE(StringUtils::parse(p, end, u));
+	ASSERT_EQ(12, u);
+	int i = 0;
+	ASSERT_TRUE(StringUtils::parse(p, end, i));
+	ASSERT_EQ(-3, i);
+	double d = 0;
+	ASSERT_TRUE(StringUtils::parse(p, end, d));
+	ASSERT_EQ(25, d);
+	ASSERT_TRUE(StringUtils::parse(p, end, d));
+	ASSERT_EQ(-1.406894775390625000e+03, d);
+	ASSERT_TRUE(StringUtils::parse(p, end, d));
+	ASSERT_EQ(0.1, d);
+	ASSERT_FALSE(StringUtils::isEndOfLine(p, end));
+	ASSERT_FALSE(StringUtils::parse(p, end, d));
+	ASSERT_EQ(" x", std::string(p, end));
+	
+	const std::string lines = "1\n \r\n3";
+	const char* const line2 = StringUtils::nextLine(lines.c_str(), lines.c_str() + lines.size());
+	ASSERT_EQ(lines.c_str() + 2, line2);
+	ASSERT_TRUE(StringUtils::isEndOfLine(line2, lines.c_str() + lines.size()));
+}
+
+
 TEST(Utils, findIndexOfValueInSortedArray) {
 	const std::vector<int> v = {1, 2, 3, 4, 9};
 	const auto b = v.begin();
@@ -63,3 +93,53 @@ TEST(Utils, findIndexOfValueInSortedArray) {
 }
 
 
+TEST(Utils, waveIndices) {
+	WaveIndices a = {4, 0, 2};
+	ASSERT_EQ(3, a.size());
+	ASSERT_FALSE(a.empty());
+	ASSERT_EQ(std::vector<int>({0, 2, 4}), std::vector<int>(a.begin(), a.end()));
+	ASSERT_TRUE(a.has(2));
+	ASSERT_FALSE(a.has(3));
+	
+	const WaveIndices b = {1, 2, 3};
+	ASSERT_EQ(WaveIndices({0, 1, 2, 3, 4}), Utils::summ(a, b));
+	ASSERT_EQ(WaveIndices({2}), Utils::intersection(a, b));
+	ASSERT_EQ(WaveIndices({0, 4}), Utils::difference(a, b));
+	ASSERT_TRUE(Utils::intersection(a, WaveIndices({1, 3})).empty());
+	
+	a.insert(1);
+	ASSERT_EQ(WaveIndices({0, 1, 2, 4}), a);
+	a.clear();
+	ASSERT_TRUE(a.empty());
+	ASSERT_EQ(0, a.size());
+	ASSERT_TRUE(a.begin() == a.end());
+}
+
+
+TEST(SpatialIndex, findWithTolerance) {
+	typedef SpatialIndex<2> Index;
+	/// unit squares of 10x10 grid, many buckets
+	std::vector<Index::Box> boxes;
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 10; j++) {
+			Index::Box box;
+			box.min = {real(i), real(j)};
+			box.max = {real(i + 1), real(j + 1)};
+			boxes.push_back(box);
+		}
+	}
+	Index index;
+	index.build(boxes, 1);
+	auto lowerLeftSquare = [](const int object) { return object == 0; };
+	
+	const real eps = 1e-6;
+	ASSERT_EQ(0, index.find({0.5, 0.5}, lowerLeftSquare));
+	/// out of the box, but in the tolerance
+	for (const Index::RealD point : {Index::RealD({1 + eps / 2, 0.5}),
+	                                 Index::RealD({0.5, 1 + eps / 2}),
+	                                 Index::RealD({-eps / 2, -eps / 2})}) {
+		ASSERT_EQ(Index::NoIndex, index.find(point, lowerLeftSquare));
+		ASSERT_EQ(0, index.find(point, lowerLeftSquare, eps));
+	}
+	ASSERT_EQ(Index::NoIndex, index.find({1 + 2 * eps, 0.5}, lowerLeftSquare, eps));
+}